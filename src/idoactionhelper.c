@@ -29,7 +29,15 @@ struct _IdoActionHelper
   GActionGroup *actions;
   gchar *action_name;
   GVariant *action_target;
-  guint idle_source_id;
+  GList *pending_link;
+
+  gboolean coalesce_states;
+  GVariant *pending_state;
+  guint tick_id;
+  guint dropped_states;
+
+  GVariant *last_state;
+  guint suppressed_states;
 };
 
 G_DEFINE_TYPE (IdoActionHelper, ido_action_helper, G_TYPE_OBJECT)
@@ -41,6 +49,7 @@ enum
   PROP_ACTION_GROUP,
   PROP_ACTION_NAME,
   PROP_ACTION_TARGET,
+  PROP_COALESCE_STATES,
   NUM_PROPERTIES
 };
 
@@ -53,26 +62,116 @@ enum
 static GParamSpec *properties[NUM_PROPERTIES];
 static guint signals[NUM_SIGNALS];
 
+/*
+ * Emits action-state-changed, unless @state equals the state emitted
+ * last and @force is unset. Services often re-send identical states,
+ * which items would otherwise parse and lay out again.
+ *
+ * The widget may show something else than the state emitted last once
+ * the user changed it, so that state is forgotten whenever the helper
+ * activates the action or asks to change its state; a service that
+ * rejects the change and sends the old state again is then heard.
+ */
 static void
-ido_action_helper_action_added (GActionGroup *actions,
-                                const gchar  *action_name,
-                                gpointer      user_data)
+ido_action_helper_emit_state (IdoActionHelper *helper,
+                              GVariant        *state,
+                              gboolean         force)
+{
+  if (!force && helper->last_state &&
+      (helper->last_state == state || g_variant_equal (helper->last_state, state)))
+    {
+      helper->suppressed_states++;
+      return;
+    }
+
+  g_variant_ref_sink (state);
+  g_clear_pointer (&helper->last_state, g_variant_unref);
+  helper->last_state = state;
+
+  g_signal_emit (helper, signals[ACTION_STATE_CHANGED], 0, state);
+}
+
+static void
+ido_action_helper_flush_state (IdoActionHelper *helper)
 {
-  IdoActionHelper *helper = user_data;
-  gboolean enabled;
   GVariant *state;
 
-  if (!g_str_equal (action_name, helper->action_name))
+  if (helper->tick_id)
+    {
+      gtk_widget_remove_tick_callback (helper->widget, helper->tick_id);
+      helper->tick_id = 0;
+    }
+
+  state = helper->pending_state;
+  if (state == NULL)
     return;
 
-  if (g_action_group_query_action (actions, action_name,
+  helper->pending_state = NULL;
+  ido_action_helper_emit_state (helper, state, FALSE);
+  g_variant_unref (state);
+}
+
+static gboolean
+ido_action_helper_tick (GtkWidget     *widget,
+                        GdkFrameClock *frame_clock,
+                        gpointer       user_data)
+{
+  IdoActionHelper *helper = user_data;
+
+  /* the tick callback is removed by returning G_SOURCE_REMOVE */
+  helper->tick_id = 0;
+  ido_action_helper_flush_state (helper);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Hands @state to the widget. When coalescing, the state is kept until
+ * the widget's next frame clock update, and replaces a state that is
+ * still pending from the same frame. Widgets that aren't mapped don't
+ * draw frames and get their states right away.
+ */
+static void
+ido_action_helper_state_changed (IdoActionHelper *helper,
+                                 GVariant        *state)
+{
+  if (!helper->coalesce_states || !gtk_widget_get_mapped (helper->widget))
+    {
+      g_clear_pointer (&helper->pending_state, g_variant_unref);
+      ido_action_helper_emit_state (helper, state, FALSE);
+      return;
+    }
+
+  if (helper->pending_state)
+    {
+      helper->dropped_states++;
+      g_variant_unref (helper->pending_state);
+    }
+
+  helper->pending_state = g_variant_ref (state);
+
+  if (helper->tick_id == 0)
+    helper->tick_id = gtk_widget_add_tick_callback (helper->widget, ido_action_helper_tick, helper, NULL);
+}
+
+static void
+ido_action_helper_action_added (IdoActionHelper *helper)
+{
+  gboolean enabled;
+  GVariant *state;
+
+  if (g_action_group_query_action (helper->actions, helper->action_name,
                                    &enabled, NULL, NULL, NULL, &state))
     {
       gtk_widget_set_sensitive (helper->widget, enabled);
 
       if (state)
         {
-          g_signal_emit (helper, signals[ACTION_STATE_CHANGED], 0, state);
+          /* the action (re)appeared: always hand out its state, and
+           * drop an older one that is still waiting for a frame */
+          g_clear_pointer (&helper->pending_state, g_variant_unref);
+          ido_action_helper_flush_state (helper);
+          ido_action_helper_emit_state (helper, state, TRUE);
           g_variant_unref (state);
         }
     }
@@ -82,65 +181,250 @@ ido_action_helper_action_added (GActionGroup *actions,
     }
 }
 
+/*
+ * One dispatcher is attached to every action group that has helpers.
+ * It connects to the group's signals once and forwards each emission
+ * only to the helpers watching the emitted action, instead of every
+ * helper on the group comparing action names.
+ */
+typedef struct
+{
+  GActionGroup *actions;
+  GHashTable *helpers; /* action name -> GPtrArray of IdoActionHelper */
+} IdoActionDispatcher;
+
+static GQuark
+ido_action_dispatcher_quark (void)
+{
+  static GQuark quark;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("ido-action-dispatcher");
+
+  return quark;
+}
+
+/*
+ * Returns a new array holding references to the helpers watching
+ * @action_name, or %NULL if there are none. Handlers may add or remove
+ * helpers while the array is dispatched to.
+ */
+static GPtrArray *
+ido_action_dispatcher_ref_helpers (IdoActionDispatcher *dispatcher,
+                                   const gchar         *action_name)
+{
+  GPtrArray *watching;
+  GPtrArray *helpers;
+  guint i;
+
+  watching = g_hash_table_lookup (dispatcher->helpers, action_name);
+  if (watching == NULL)
+    return NULL;
+
+  helpers = g_ptr_array_new_full (watching->len, g_object_unref);
+  for (i = 0; i < watching->len; i++)
+    g_ptr_array_add (helpers, g_object_ref (g_ptr_array_index (watching, i)));
+
+  return helpers;
+}
+
 static void
-ido_action_helper_action_removed (GActionGroup *action_group,
-                                  gchar        *action_name,
-                                  gpointer      user_data)
+ido_action_dispatcher_action_added (GActionGroup *actions,
+                                    const gchar  *action_name,
+                                    gpointer      user_data)
 {
-  IdoActionHelper *helper = user_data;
+  GPtrArray *helpers;
+  guint i;
+
+  helpers = ido_action_dispatcher_ref_helpers (user_data, action_name);
+  if (helpers == NULL)
+    return;
 
-  if (g_str_equal (action_name, helper->action_name))
-    gtk_widget_set_sensitive (helper->widget, FALSE);
+  for (i = 0; i < helpers->len; i++)
+    ido_action_helper_action_added (g_ptr_array_index (helpers, i));
+
+  g_ptr_array_unref (helpers);
 }
 
 static void
-ido_action_helper_action_enabled_changed (GActionGroup *action_group,
-                                          gchar        *action_name,
-                                          gboolean      enabled,
-                                          gpointer      user_data)
+ido_action_dispatcher_action_removed (GActionGroup *action_group,
+                                      gchar        *action_name,
+                                      gpointer      user_data)
 {
-  IdoActionHelper *helper = user_data;
+  GPtrArray *helpers;
+  guint i;
+
+  helpers = ido_action_dispatcher_ref_helpers (user_data, action_name);
+  if (helpers == NULL)
+    return;
+
+  for (i = 0; i < helpers->len; i++)
+    {
+      IdoActionHelper *helper = g_ptr_array_index (helpers, i);
+
+      gtk_widget_set_sensitive (helper->widget, FALSE);
+    }
 
-  if (g_str_equal (action_name, helper->action_name))
-    gtk_widget_set_sensitive (helper->widget, enabled);
+  g_ptr_array_unref (helpers);
 }
 
 static void
-ido_action_helper_action_state_changed (GActionGroup *action_group,
-                                        gchar        *action_name,
-                                        GVariant     *value,
-                                        gpointer      user_data)
+ido_action_dispatcher_action_enabled_changed (GActionGroup *action_group,
+                                              gchar        *action_name,
+                                              gboolean      enabled,
+                                              gpointer      user_data)
 {
-  IdoActionHelper *helper = user_data;
+  GPtrArray *helpers;
+  guint i;
+
+  helpers = ido_action_dispatcher_ref_helpers (user_data, action_name);
+  if (helpers == NULL)
+    return;
+
+  for (i = 0; i < helpers->len; i++)
+    {
+      IdoActionHelper *helper = g_ptr_array_index (helpers, i);
+
+      gtk_widget_set_sensitive (helper->widget, enabled);
+    }
+
+  g_ptr_array_unref (helpers);
+}
+
+static void
+ido_action_dispatcher_action_state_changed (GActionGroup *action_group,
+                                            gchar        *action_name,
+                                            GVariant     *value,
+                                            gpointer      user_data)
+{
+  GPtrArray *helpers;
+  guint i;
 
-  if (g_str_equal (action_name, helper->action_name))
-    g_signal_emit (helper, signals[ACTION_STATE_CHANGED], 0, value);
+  helpers = ido_action_dispatcher_ref_helpers (user_data, action_name);
+  if (helpers == NULL)
+    return;
+
+  for (i = 0; i < helpers->len; i++)
+    ido_action_helper_state_changed (g_ptr_array_index (helpers, i), value);
+
+  g_ptr_array_unref (helpers);
+}
+
+static void
+ido_action_dispatcher_free (gpointer data)
+{
+  IdoActionDispatcher *dispatcher = data;
+
+  g_signal_handlers_disconnect_by_data (dispatcher->actions, dispatcher);
+  g_hash_table_unref (dispatcher->helpers);
+
+  g_slice_free (IdoActionDispatcher, dispatcher);
+}
+
+static void
+ido_action_dispatcher_add_helper (IdoActionHelper *helper)
+{
+  IdoActionDispatcher *dispatcher;
+  GPtrArray *watching;
+
+  dispatcher = g_object_get_qdata (G_OBJECT (helper->actions), ido_action_dispatcher_quark ());
+  if (dispatcher == NULL)
+    {
+      /* the dispatcher doesn't ref the group: every helper it knows
+       * about does, and it is detached together with the last one */
+      dispatcher = g_slice_new (IdoActionDispatcher);
+      dispatcher->actions = helper->actions;
+      dispatcher->helpers = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                   g_free, (GDestroyNotify) g_ptr_array_unref);
+
+      g_signal_connect (dispatcher->actions, "action-added",
+                        G_CALLBACK (ido_action_dispatcher_action_added), dispatcher);
+      g_signal_connect (dispatcher->actions, "action-removed",
+                        G_CALLBACK (ido_action_dispatcher_action_removed), dispatcher);
+      g_signal_connect (dispatcher->actions, "action-enabled-changed",
+                        G_CALLBACK (ido_action_dispatcher_action_enabled_changed), dispatcher);
+      g_signal_connect (dispatcher->actions, "action-state-changed",
+                        G_CALLBACK (ido_action_dispatcher_action_state_changed), dispatcher);
+
+      g_object_set_qdata_full (G_OBJECT (helper->actions), ido_action_dispatcher_quark (),
+                               dispatcher, ido_action_dispatcher_free);
+    }
+
+  watching = g_hash_table_lookup (dispatcher->helpers, helper->action_name);
+  if (watching == NULL)
+    {
+      watching = g_ptr_array_new ();
+      g_hash_table_insert (dispatcher->helpers, g_strdup (helper->action_name), watching);
+    }
+
+  g_ptr_array_add (watching, helper);
 }
 
+static void
+ido_action_dispatcher_remove_helper (IdoActionHelper *helper)
+{
+  IdoActionDispatcher *dispatcher;
+  GPtrArray *watching;
+
+  dispatcher = g_object_get_qdata (G_OBJECT (helper->actions), ido_action_dispatcher_quark ());
+  g_return_if_fail (dispatcher != NULL);
+
+  watching = g_hash_table_lookup (dispatcher->helpers, helper->action_name);
+  g_return_if_fail (watching != NULL);
+
+  g_ptr_array_remove_fast (watching, helper);
+  if (watching->len == 0)
+    g_hash_table_remove (dispatcher->helpers, helper->action_name);
+
+  if (g_hash_table_size (dispatcher->helpers) == 0)
+    g_object_set_qdata (G_OBJECT (helper->actions), ido_action_dispatcher_quark (), NULL);
+}
+
+/*
+ * Helpers whose action already existed when they were created replay
+ * action-added once the main loop is idle, so that handlers connected
+ * after construction see the initial state. They are batched into one
+ * idle source that replays all of them in a single pass.
+ */
+static GQueue pending_helpers = G_QUEUE_INIT;
+static guint pending_source_id;
+
 static gboolean
 call_action_added (gpointer user_data)
 {
-  IdoActionHelper *helper = user_data;
+  pending_source_id = 0;
+  ido_action_helper_flush_pending ();
 
-  ido_action_helper_action_added (helper->actions, helper->action_name, helper);
-
-  helper->idle_source_id = 0;
   return G_SOURCE_REMOVE;
 }
 
+static void
+ido_action_helper_widget_mapped (IdoActionHelper *helper)
+{
+  /* make the item show its state in its first frame */
+  if (helper->pending_link)
+    ido_action_helper_flush_pending ();
+}
+
+static void
+ido_action_helper_queue_action_added (IdoActionHelper *helper)
+{
+  g_queue_push_tail (&pending_helpers, helper);
+  helper->pending_link = pending_helpers.tail;
+
+  g_signal_connect_swapped (helper->widget, "map",
+                            G_CALLBACK (ido_action_helper_widget_mapped), helper);
+
+  if (pending_source_id == 0)
+    pending_source_id = g_idle_add (call_action_added, NULL);
+}
+
 static void
 ido_action_helper_constructed (GObject *object)
 {
   IdoActionHelper *helper = IDO_ACTION_HELPER (object);
 
-  g_signal_connect (helper->actions, "action-added",
-                    G_CALLBACK (ido_action_helper_action_added), helper);
-  g_signal_connect (helper->actions, "action-removed",
-                    G_CALLBACK (ido_action_helper_action_removed), helper);
-  g_signal_connect (helper->actions, "action-enabled-changed",
-                    G_CALLBACK (ido_action_helper_action_enabled_changed), helper);
-  g_signal_connect (helper->actions, "action-state-changed",
-                    G_CALLBACK (ido_action_helper_action_state_changed), helper);
+  ido_action_dispatcher_add_helper (helper);
 
   if (g_action_group_has_action (helper->actions, helper->action_name))
     {
@@ -148,7 +432,7 @@ ido_action_helper_constructed (GObject *object)
        * state-changed signal during construction (nobody could have
        * connected by then).
        */
-      helper->idle_source_id = g_idle_add (call_action_added, helper);
+      ido_action_helper_queue_action_added (helper);
     }
 
   G_OBJECT_CLASS (ido_action_helper_parent_class)->constructed (object);
@@ -180,6 +464,10 @@ ido_action_helper_get_property (GObject    *object,
       g_value_set_variant (value, helper->action_target);
       break;
 
+    case PROP_COALESCE_STATES:
+      g_value_set_boolean (value, helper->coalesce_states);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, id, pspec);
     }
@@ -211,6 +499,10 @@ ido_action_helper_set_property (GObject      *object,
       helper->action_target = g_value_dup_variant (value);
       break;
 
+    case PROP_COALESCE_STATES:
+      ido_action_helper_set_coalesce_states (helper, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, id, pspec);
     }
@@ -221,12 +513,20 @@ ido_action_helper_finalize (GObject *object)
 {
   IdoActionHelper *helper = IDO_ACTION_HELPER (object);
 
-  if (helper->idle_source_id)
-    g_source_remove (helper->idle_source_id);
+  if (helper->pending_link)
+    g_queue_delete_link (&pending_helpers, helper->pending_link);
+
+  g_signal_handlers_disconnect_by_func (helper->widget, ido_action_helper_widget_mapped, helper);
 
+  if (helper->tick_id)
+    gtk_widget_remove_tick_callback (helper->widget, helper->tick_id);
+
+  g_clear_pointer (&helper->pending_state, g_variant_unref);
+  g_clear_pointer (&helper->last_state, g_variant_unref);
+  g_signal_handlers_disconnect_by_func (helper->widget, ido_action_helper_flush_state, helper);
   g_object_unref (helper->widget);
 
-  g_signal_handlers_disconnect_by_data (helper->actions, helper);
+  ido_action_dispatcher_remove_helper (helper);
   g_object_unref (helper->actions);
 
   g_free (helper->action_name);
@@ -316,6 +616,23 @@ ido_action_helper_class_init (IdoActionHelperClass *class)
                                                          G_PARAM_READWRITE |
                                                          G_PARAM_STATIC_STRINGS);
 
+  /**
+   * IdoActionHelper:coalesce-states:
+   *
+   * Whether state changes of the action are delivered at most once per
+   * frame of #IdoActionHelper:widget. If the action changes its state
+   * several times within one frame, only the last state is emitted with
+   * #IdoActionHelper::action-state-changed and the other ones are
+   * counted as dropped.
+   *
+   * Meant for widgets whose state is streamed by a service, like
+   * sliders and levels.
+   */
+  properties[PROP_COALESCE_STATES] = g_param_spec_boolean ("coalesce-states", "", "", FALSE,
+                                                           G_PARAM_READWRITE |
+                                                           G_PARAM_EXPLICIT_NOTIFY |
+                                                           G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (object_class, NUM_PROPERTIES, properties);
 }
 
@@ -403,6 +720,8 @@ ido_action_helper_activate (IdoActionHelper *helper)
 {
   g_return_if_fail (IDO_IS_ACTION_HELPER (helper));
 
+  g_clear_pointer (&helper->last_state, g_variant_unref);
+
   if (helper->actions && helper->action_name)
     g_action_group_activate_action (helper->actions, helper->action_name, helper->action_target);
 }
@@ -424,6 +743,7 @@ ido_action_helper_activate_with_parameter (IdoActionHelper *helper,
   g_return_if_fail (parameter != NULL);
 
   g_variant_ref_sink (parameter);
+  g_clear_pointer (&helper->last_state, g_variant_unref);
 
   if (helper->actions && helper->action_name)
     g_action_group_activate_action (helper->actions, helper->action_name, parameter);
@@ -449,9 +769,217 @@ ido_action_helper_change_action_state (IdoActionHelper *helper,
   g_return_if_fail (state != NULL);
 
   g_variant_ref_sink (state);
+  g_clear_pointer (&helper->last_state, g_variant_unref);
 
   if (helper->actions && helper->action_name)
     g_action_group_change_action_state (helper->actions, helper->action_name, state);
 
   g_variant_unref (state);
 }
+
+/**
+ * ido_action_helper_flush_pending:
+ *
+ * Emits the initial #IdoActionHelper::action-state-changed of all
+ * helpers created since the main loop was last idle, right away.
+ *
+ * These are otherwise delivered from an idle callback. This happens
+ * automatically when a helper's widget is mapped; call this to update
+ * the items of a menu before it is shown by other means.
+ */
+void
+ido_action_helper_flush_pending (void)
+{
+  IdoActionHelper *helper;
+
+  if (pending_source_id)
+    {
+      g_source_remove (pending_source_id);
+      pending_source_id = 0;
+    }
+
+  /* handlers may create helpers, which are replayed in the same pass */
+  while ((helper = g_queue_pop_head (&pending_helpers)))
+    {
+      helper->pending_link = NULL;
+
+      g_object_ref (helper);
+      ido_action_helper_action_added (helper);
+      g_object_unref (helper);
+    }
+}
+
+/**
+ * ido_action_helper_set_coalesce_states:
+ * @helper: an #IdoActionHelper
+ * @coalesce: whether to coalesce state changes
+ *
+ * Sets #IdoActionHelper:coalesce-states. Turning it off delivers a
+ * state that is still pending right away.
+ */
+void
+ido_action_helper_set_coalesce_states (IdoActionHelper *helper,
+                                       gboolean         coalesce)
+{
+  g_return_if_fail (IDO_IS_ACTION_HELPER (helper));
+
+  coalesce = !!coalesce;
+  if (helper->coalesce_states == coalesce)
+    return;
+
+  helper->coalesce_states = coalesce;
+
+  if (coalesce)
+    {
+      /* frames stop when the widget is unmapped */
+      g_signal_connect_swapped (helper->widget, "unmap",
+                                G_CALLBACK (ido_action_helper_flush_state), helper);
+    }
+  else
+    {
+      g_signal_handlers_disconnect_by_func (helper->widget, ido_action_helper_flush_state, helper);
+      ido_action_helper_flush_state (helper);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (helper), properties[PROP_COALESCE_STATES]);
+}
+
+/**
+ * ido_action_helper_get_coalesce_states:
+ * @helper: an #IdoActionHelper
+ *
+ * Returns: whether @helper delivers at most one state per frame
+ */
+gboolean
+ido_action_helper_get_coalesce_states (IdoActionHelper *helper)
+{
+  g_return_val_if_fail (IDO_IS_ACTION_HELPER (helper), FALSE);
+
+  return helper->coalesce_states;
+}
+
+/**
+ * ido_action_helper_get_dropped_states:
+ * @helper: an #IdoActionHelper
+ *
+ * Returns: the number of states that were replaced by a newer state
+ * within the same frame, and thus never emitted, since @helper was
+ * created
+ */
+guint
+ido_action_helper_get_dropped_states (IdoActionHelper *helper)
+{
+  g_return_val_if_fail (IDO_IS_ACTION_HELPER (helper), 0);
+
+  return helper->dropped_states;
+}
+
+/**
+ * ido_action_helper_get_suppressed_states:
+ * @helper: an #IdoActionHelper
+ *
+ * Returns: the number of state changes that were not emitted because
+ * the action's state was equal to the one emitted before, since
+ * @helper was created
+ */
+guint
+ido_action_helper_get_suppressed_states (IdoActionHelper *helper)
+{
+  g_return_val_if_fail (IDO_IS_ACTION_HELPER (helper), 0);
+
+  return helper->suppressed_states;
+}
+
+static GQuark
+ido_action_helper_widget_quark (void)
+{
+  static GQuark quark;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("ido-action-helper");
+
+  return quark;
+}
+
+static void
+ido_action_helper_unbind_widget (GtkWidget *widget,
+                                 gpointer   user_data)
+{
+  IdoActionHelper *helper = user_data;
+
+  /* also drops handlers the widget connected with @helper as data */
+  g_signal_handlers_disconnect_by_data (widget, helper);
+  g_object_set_qdata (G_OBJECT (widget), ido_action_helper_widget_quark (), NULL);
+  g_object_unref (helper);
+}
+
+/**
+ * ido_action_helper_bind_widget:
+ * @widget: a #GtkWidget
+ * @action_group: (nullable): a #GActionGroup
+ * @action_name: (nullable): the name of an action in @action_group
+ * @target: (nullable): the target of the action
+ *
+ * Ties @widget to an action like ido_action_helper_new(), but keeps
+ * track of the helper on @widget so that a menu item can be bound to a
+ * different action later on. The helper is released when @widget is
+ * destroyed or bound again.
+ *
+ * If @widget is already bound to @action_name in @action_group with the
+ * same @target, nothing changes. Otherwise, the previous helper and all
+ * signal handlers that were connected on @widget with that helper as
+ * user data are dropped. Passing %NULL for @action_name only unbinds
+ * @widget.
+ *
+ * Returns: (transfer none) (nullable): the newly created helper, whose
+ * signals the caller is expected to connect to, or %NULL if no new
+ * helper was created
+ */
+IdoActionHelper *
+ido_action_helper_bind_widget (GtkWidget    *widget,
+                               GActionGroup *action_group,
+                               const gchar  *action_name,
+                               GVariant     *target)
+{
+  IdoActionHelper *helper;
+
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
+
+  helper = g_object_get_qdata (G_OBJECT (widget), ido_action_helper_widget_quark ());
+
+  if (helper)
+    {
+      if (action_name &&
+          helper->actions == action_group &&
+          g_str_equal (helper->action_name, action_name) &&
+          (helper->action_target == target ||
+           (helper->action_target && target && g_variant_equal (helper->action_target, target))))
+        return NULL;
+
+      ido_action_helper_unbind_widget (widget, helper);
+    }
+
+  if (action_group == NULL || action_name == NULL)
+    return NULL;
+
+  helper = ido_action_helper_new (widget, action_group, action_name, target);
+  g_object_set_qdata (G_OBJECT (widget), ido_action_helper_widget_quark (), helper);
+  g_signal_connect (widget, "destroy", G_CALLBACK (ido_action_helper_unbind_widget), helper);
+
+  return helper;
+}
+
+/**
+ * ido_action_helper_get_for_widget:
+ * @widget: a #GtkWidget
+ *
+ * Returns: (transfer none) (nullable): the helper that @widget was
+ * bound to with ido_action_helper_bind_widget(), or %NULL
+ */
+IdoActionHelper *
+ido_action_helper_get_for_widget (GtkWidget *widget)
+{
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
+
+  return g_object_get_qdata (G_OBJECT (widget), ido_action_helper_widget_quark ());
+}
@@ -47,4 +47,22 @@ void                ido_action_helper_activate_with_parameter (IdoActionHelper *
 void                ido_action_helper_change_action_state (IdoActionHelper *helper,
                                                            GVariant        *state);
 
+void                ido_action_helper_flush_pending     (void);
+
+void                ido_action_helper_set_coalesce_states (IdoActionHelper *helper,
+                                                           gboolean         coalesce);
+
+gboolean            ido_action_helper_get_coalesce_states (IdoActionHelper *helper);
+
+guint               ido_action_helper_get_dropped_states  (IdoActionHelper *helper);
+
+guint               ido_action_helper_get_suppressed_states (IdoActionHelper *helper);
+
+IdoActionHelper *   ido_action_helper_bind_widget       (GtkWidget    *widget,
+                                                         GActionGroup *action_group,
+                                                         const gchar  *action_name,
+                                                         GVariant     *target);
+
+IdoActionHelper *   ido_action_helper_get_for_widget    (GtkWidget    *widget);
+
 #endif
@@ -26,92 +26,84 @@
 #include "idotimestampmenuitem.h"
 
 /**
- * ido_alarm_menu_item_new_from_model:
- * @menu_item: the corresponding menuitem
- * @actions: action group to tell when this GtkMenuItem is activated
- *
- * Creates a new IdoTimeStampMenuItem with properties initialized
- * appropriately for a org.ayatana.indicator.alarm
+ * ido_alarm_menu_item_update_from_model:
+ * @item: a menuitem built by ido_alarm_menu_item_new_from_model()
+ * @menu_item: (nullable): the corresponding menuitem
+ * @actions: (nullable): action group to tell when @item is activated
  *
- * If the menuitem's 'action' attribute is set, trigger that action
- * in @actions when this IdoAppointmentMenuItem is activated.
+ * Applies the attributes and action of @menu_item to @item, touching
+ * only what differs from the current values. If @menu_item is %NULL,
+ * the item is left as blank as a new one, without an action binding.
  */
-GtkMenuItem *
-ido_alarm_menu_item_new_from_model (GMenuItem    * menu_item,
-                                    GActionGroup * actions)
+void
+ido_alarm_menu_item_update_from_model (GtkMenuItem  * item,
+                                       GMenuItem    * menu_item,
+                                       GActionGroup * actions)
 {
-  guint i;
-  guint n;
+  IdoTimeStampMenuItem * ido_menu_item;
   gint64 i64;
-  gchar * str;
-  const gchar * names[4] = {0};
-  GValue * values;
-  const guint n_max = 4;
-  IdoBasicMenuItem * ido_menu_item;
+  gchar * str = NULL;
+  GIcon * icon;
 
-  /* create the ido_menu_item */
+  g_return_if_fail (IDO_IS_TIME_STAMP_MENU_ITEM (item));
 
-  n = 0;
-  values = g_new0(GValue, n_max);
-
-  if (g_menu_item_get_attribute (menu_item, G_MENU_ATTRIBUTE_LABEL, "s", &str))
+  if (menu_item == NULL)
     {
-      names[n] = "text";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
+      ido_basic_menu_item_clear (IDO_BASIC_MENU_ITEM (item));
+      ido_time_stamp_menu_item_set_date_time (IDO_TIME_STAMP_MENU_ITEM (item), NULL);
+      ido_time_stamp_menu_item_set_format (IDO_TIME_STAMP_MENU_ITEM (item), NULL);
+      return;
     }
 
-  if (TRUE)
-    {
-      names[n] = "icon";
-      g_value_init (&values[n], G_TYPE_OBJECT);
-      g_value_take_object (&values[n], g_themed_icon_new_with_default_fallbacks ("alarm-symbolic"));
-      n++;
-    }
+  ido_menu_item = IDO_TIME_STAMP_MENU_ITEM (item);
 
-  if (g_menu_item_get_attribute (menu_item, "x-ayatana-time-format", "s", &str))
-    {
-      names[n] = "format";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
-    }
+  g_menu_item_get_attribute (menu_item, G_MENU_ATTRIBUTE_LABEL, "s", &str);
+  ido_basic_menu_item_set_text (IDO_BASIC_MENU_ITEM (ido_menu_item), str);
+  g_free (str);
+
+  icon = g_themed_icon_new_with_default_fallbacks ("alarm-symbolic");
+  ido_basic_menu_item_set_icon (IDO_BASIC_MENU_ITEM (ido_menu_item), icon);
+  g_object_unref (icon);
+
+  /* a missing format or time is unset, like on a new item */
+  str = NULL;
+  g_menu_item_get_attribute (menu_item, "x-ayatana-time-format", "s", &str);
+  ido_time_stamp_menu_item_set_format (ido_menu_item, str);
+  g_free (str);
 
   if (g_menu_item_get_attribute (menu_item, "x-ayatana-time", "x", &i64))
     {
-      names[n] = "date-time";
-      g_value_init (&values[n], G_TYPE_DATE_TIME);
-      g_value_take_boxed (&values[n], g_date_time_new_from_unix_local (i64));
-      n++;
+      GDateTime * date_time = g_date_time_new_from_unix_local (i64);
+      ido_time_stamp_menu_item_set_date_time (ido_menu_item, date_time);
+      g_date_time_unref (date_time);
     }
-
-  g_assert (n <= G_N_ELEMENTS (names));
-  g_assert (n <= n_max);
-  ido_menu_item = IDO_BASIC_MENU_ITEM(g_object_new_with_properties (IDO_TYPE_TIME_STAMP_MENU_ITEM, n, names, values));
-
-  for (i=0; i<n; i++)
-    g_value_unset (&values[i]);
-
-  /* add an ActionHelper */
-
-  if (g_menu_item_get_attribute (menu_item, "action", "s", &str))
+  else
     {
-      GVariant * target;
-      IdoActionHelper * helper;
+      ido_time_stamp_menu_item_set_date_time (ido_menu_item, NULL);
+    }
 
-      target = g_menu_item_get_attribute_value (menu_item, "target",
-                                                G_VARIANT_TYPE_ANY);
-      helper = ido_action_helper_new (GTK_WIDGET(ido_menu_item), actions,
-                                      str, target);
-      g_signal_connect_swapped (ido_menu_item, "activate",
-                                G_CALLBACK (ido_action_helper_activate), helper);
-      g_signal_connect_swapped (ido_menu_item, "destroy",
-                                G_CALLBACK (g_object_unref), helper);
+  ido_basic_menu_item_bind_action (IDO_BASIC_MENU_ITEM (ido_menu_item), menu_item, actions);
+}
 
-      g_clear_pointer (&target, g_variant_unref);
-      g_free (str);
-    }
+/**
+ * ido_alarm_menu_item_new_from_model:
+ * @menu_item: the corresponding menuitem
+ * @actions: action group to tell when this GtkMenuItem is activated
+ *
+ * Creates a new IdoTimeStampMenuItem with properties initialized
+ * appropriately for a org.ayatana.indicator.alarm
+ *
+ * If the menuitem's 'action' attribute is set, trigger that action
+ * in @actions when this IdoAppointmentMenuItem is activated.
+ */
+GtkMenuItem *
+ido_alarm_menu_item_new_from_model (GMenuItem    * menu_item,
+                                    GActionGroup * actions)
+{
+  GtkWidget * ido_menu_item;
+
+  ido_menu_item = ido_time_stamp_menu_item_new ();
+  ido_alarm_menu_item_update_from_model (GTK_MENU_ITEM (ido_menu_item), menu_item, actions);
 
   return GTK_MENU_ITEM (ido_menu_item);
 }
@@ -0,0 +1,594 @@
+/*
+ * Copyright 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "idoalbumart.h"
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+/*
+ * Decoded album art, shared by every media player item in the process.
+ * Entries are keyed by URL and device scale, kept in most recently used
+ * order and dropped from the other end once they take up more than
+ * max_bytes. The cache is only used from the main thread; reading and
+ * decoding happen in a worker.
+ */
+
+typedef struct
+{
+  gchar *url;
+  gint scale;
+} IdoAlbumArtKey;
+
+typedef struct
+{
+  IdoAlbumArtKey key;
+  cairo_surface_t *surface;
+  gsize n_bytes;
+  GList link;
+} IdoAlbumArtEntry;
+
+typedef struct
+{
+  GHashTable *entries;
+  GQueue lru;
+  gsize n_bytes;
+  gsize max_bytes;
+} IdoAlbumArtCache;
+
+/*
+ * A read and decode of one URL at one scale. Everyone who asks for the
+ * same art while it is in flight waits for this load instead of
+ * starting their own; each of them gets a task of their own, so one
+ * of them cancelling only completes that task.
+ */
+typedef struct
+{
+  IdoAlbumArtKey key;
+  GSList *tasks;
+} IdoAlbumArtLoad;
+
+static GHashTable *loads;
+
+static guint
+ido_album_art_key_hash (gconstpointer data)
+{
+  const IdoAlbumArtKey *key = data;
+
+  return g_str_hash (key->url) * 31 + key->scale;
+}
+
+static gboolean
+ido_album_art_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const IdoAlbumArtKey *key_a = a;
+  const IdoAlbumArtKey *key_b = b;
+
+  return key_a->scale == key_b->scale && g_str_equal (key_a->url, key_b->url);
+}
+
+static void
+ido_album_art_entry_free (gpointer data)
+{
+  IdoAlbumArtEntry *entry = data;
+
+  cairo_surface_destroy (entry->surface);
+  g_free (entry->key.url);
+  g_slice_free (IdoAlbumArtEntry, entry);
+}
+
+static IdoAlbumArtCache *
+ido_album_art_cache_get_default (void)
+{
+  static IdoAlbumArtCache cache;
+
+  if (cache.entries == NULL)
+    {
+      cache.entries = g_hash_table_new_full (ido_album_art_key_hash, ido_album_art_key_equal,
+                                             NULL, ido_album_art_entry_free);
+      g_queue_init (&cache.lru);
+      cache.max_bytes = IDO_ALBUM_ART_CACHE_DEFAULT_MAX_BYTES;
+    }
+
+  return &cache;
+}
+
+static void
+ido_album_art_cache_remove (IdoAlbumArtCache *cache,
+                            IdoAlbumArtEntry *entry)
+{
+  g_queue_unlink (&cache->lru, &entry->link);
+  cache->n_bytes -= entry->n_bytes;
+  g_hash_table_remove (cache->entries, &entry->key);
+}
+
+static void
+ido_album_art_cache_trim (IdoAlbumArtCache *cache)
+{
+  while (cache->n_bytes > cache->max_bytes)
+    ido_album_art_cache_remove (cache, cache->lru.tail->data);
+}
+
+/**
+ * ido_album_art_cache_lookup: (skip)
+ * @url: the URL the art was loaded from
+ * @scale: the device scale it was loaded for
+ *
+ * Returns: (transfer full) (nullable): the cached art, or %NULL if it
+ *   isn't cached
+ */
+cairo_surface_t *
+ido_album_art_cache_lookup (const gchar *url,
+                            gint         scale)
+{
+  IdoAlbumArtCache *cache = ido_album_art_cache_get_default ();
+  IdoAlbumArtEntry *entry;
+  IdoAlbumArtKey key;
+
+  g_return_val_if_fail (url != NULL, NULL);
+
+  key.url = (gchar *) url;
+  key.scale = scale;
+
+  entry = g_hash_table_lookup (cache->entries, &key);
+  if (entry == NULL)
+    return NULL;
+
+  g_queue_unlink (&cache->lru, &entry->link);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+
+  return cairo_surface_reference (entry->surface);
+}
+
+/**
+ * ido_album_art_cache_insert: (skip)
+ * @url: the URL the art was loaded from
+ * @scale: the device scale it was loaded for
+ * @surface: the decoded art, an image surface
+ *
+ * Adds @surface to the cache, replacing what was cached for @url and
+ * @scale before. Art bigger than the whole budget isn't kept.
+ */
+void
+ido_album_art_cache_insert (const gchar     *url,
+                            gint             scale,
+                            cairo_surface_t *surface)
+{
+  IdoAlbumArtCache *cache = ido_album_art_cache_get_default ();
+  IdoAlbumArtEntry *entry;
+
+  g_return_if_fail (url != NULL);
+  g_return_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE);
+
+  entry = g_slice_new0 (IdoAlbumArtEntry);
+  entry->key.url = g_strdup (url);
+  entry->key.scale = scale;
+
+  if (g_hash_table_contains (cache->entries, &entry->key))
+    ido_album_art_cache_remove (cache, g_hash_table_lookup (cache->entries, &entry->key));
+
+  entry->surface = cairo_surface_reference (surface);
+  entry->n_bytes = (gsize) cairo_image_surface_get_stride (surface) *
+                   cairo_image_surface_get_height (surface);
+  entry->link.data = entry;
+
+  g_hash_table_insert (cache->entries, &entry->key, entry);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  cache->n_bytes += entry->n_bytes;
+
+  ido_album_art_cache_trim (cache);
+}
+
+/**
+ * ido_album_art_cache_set_max_bytes: (skip)
+ * @max_bytes: how many bytes of pixels the album art cache may hold
+ *
+ * Sets the budget of the album art cache, shared by the whole process.
+ * The least recently used art is dropped until the cache fits.
+ */
+void
+ido_album_art_cache_set_max_bytes (gsize max_bytes)
+{
+  IdoAlbumArtCache *cache = ido_album_art_cache_get_default ();
+
+  cache->max_bytes = max_bytes;
+  ido_album_art_cache_trim (cache);
+}
+
+/**
+ * ido_album_art_cache_get_max_bytes: (skip)
+ *
+ * Returns: the budget of the album art cache, in bytes
+ */
+gsize
+ido_album_art_cache_get_max_bytes (void)
+{
+  return ido_album_art_cache_get_default ()->max_bytes;
+}
+
+/**
+ * ido_album_art_cache_get_n_bytes: (skip)
+ *
+ * Returns: how many bytes of pixels the album art cache holds
+ */
+gsize
+ido_album_art_cache_get_n_bytes (void)
+{
+  return ido_album_art_cache_get_default ()->n_bytes;
+}
+
+/**
+ * ido_album_art_cache_get_n_entries: (skip)
+ *
+ * Returns: how many pieces of art the album art cache holds
+ */
+guint
+ido_album_art_cache_get_n_entries (void)
+{
+  return g_hash_table_size (ido_album_art_cache_get_default ()->entries);
+}
+
+/**
+ * ido_album_art_cache_clear: (skip)
+ *
+ * Drops all art from the cache.
+ */
+void
+ido_album_art_cache_clear (void)
+{
+  IdoAlbumArtCache *cache = ido_album_art_cache_get_default ();
+
+  while (cache->lru.head)
+    ido_album_art_cache_remove (cache, cache->lru.head->data);
+}
+
+static void
+ido_album_art_load_complete (IdoAlbumArtLoad *load,
+                             cairo_surface_t *surface,
+                             const GError    *error)
+{
+  GSList *tasks;
+  GSList *it;
+
+  g_hash_table_steal (loads, &load->key);
+
+  if (surface)
+    ido_album_art_cache_insert (load->key.url, load->key.scale, surface);
+
+  /* oldest first, in the order they were asked for */
+  tasks = g_slist_reverse (load->tasks);
+  load->tasks = NULL;
+
+  /* callbacks run right away and may cancel the requests after them,
+   * which are all being completed here anyway */
+  for (it = tasks; it; it = it->next)
+    {
+      GCancellable *cancellable = g_task_get_cancellable (it->data);
+
+      if (cancellable)
+        g_signal_handlers_disconnect_by_data (cancellable, it->data);
+    }
+
+  for (it = tasks; it; it = it->next)
+    {
+      GTask *task = it->data;
+
+      if (surface)
+        g_task_return_pointer (task, cairo_surface_reference (surface),
+                               (GDestroyNotify) cairo_surface_destroy);
+      else
+        g_task_return_error (task, g_error_copy (error));
+
+      g_object_unref (task);
+    }
+
+  g_slist_free (tasks);
+  g_free (load->key.url);
+  g_slice_free (IdoAlbumArtLoad, load);
+}
+
+static void
+ido_album_art_request_cancelled (GCancellable *cancellable,
+                                 gpointer      user_data)
+{
+  GTask *task = user_data;
+  IdoAlbumArtLoad *load = g_task_get_task_data (task);
+
+  g_signal_handlers_disconnect_by_data (cancellable, task);
+  load->tasks = g_slist_remove (load->tasks, task);
+
+  g_task_return_error_if_cancelled (task);
+  g_object_unref (task);
+}
+
+/*
+ * Copies @pixbuf into a new image surface of the same size, with
+ * premultiplied alpha, the way gdk_cairo_surface_create_from_pixbuf()
+ * does, but without touching GDK from a worker thread.
+ */
+static cairo_surface_t *
+ido_album_art_surface_from_pixbuf (GdkPixbuf *pixbuf,
+                                   gdouble    scale)
+{
+  gint width = gdk_pixbuf_get_width (pixbuf);
+  gint height = gdk_pixbuf_get_height (pixbuf);
+  gint n_channels = gdk_pixbuf_get_n_channels (pixbuf);
+  gint src_stride = gdk_pixbuf_get_rowstride (pixbuf);
+  const guchar *src = gdk_pixbuf_read_pixels (pixbuf);
+  cairo_surface_t *surface;
+  guchar *dst;
+  gint dst_stride;
+  gint x;
+  gint y;
+
+  surface = cairo_image_surface_create (n_channels == 3 ? CAIRO_FORMAT_RGB24 : CAIRO_FORMAT_ARGB32,
+                                        width, height);
+  cairo_surface_flush (surface);
+  dst = cairo_image_surface_get_data (surface);
+  dst_stride = cairo_image_surface_get_stride (surface);
+
+  for (y = 0; y < height; y++)
+    {
+      const guchar *in = src + y * src_stride;
+      guint32 *out = (guint32 *) (dst + y * dst_stride);
+
+      for (x = 0; x < width; x++, in += n_channels)
+        {
+          guint alpha = n_channels == 4 ? in[3] : 0xff;
+          guint r = (in[0] * alpha + 0x80) * 0x101 >> 16;
+          guint g = (in[1] * alpha + 0x80) * 0x101 >> 16;
+          guint b = (in[2] * alpha + 0x80) * 0x101 >> 16;
+
+          out[x] = alpha << 24 | r << 16 | g << 8 | b;
+        }
+    }
+
+  cairo_surface_mark_dirty (surface);
+  cairo_surface_set_device_scale (surface, scale, scale);
+
+  return surface;
+}
+
+/* reads and decodes the art of a load, in a worker thread */
+static void
+ido_album_art_decode_thread (GTask        *task,
+                             gpointer      source_object,
+                             gpointer      task_data,
+                             GCancellable *cancellable)
+{
+  IdoAlbumArtLoad *load = task_data;
+  GFileInputStream *input;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+  GFile *file;
+  gint size;
+
+  file = g_file_new_for_uri (load->key.url);
+  input = g_file_read (file, NULL, &error);
+  g_object_unref (file);
+
+  if (input == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* straight to the size the art is shown at, in device pixels */
+  size = IDO_ALBUM_ART_SIZE * load->key.scale;
+  pixbuf = gdk_pixbuf_new_from_stream_at_scale (G_INPUT_STREAM (input), size, size, TRUE, NULL, &error);
+  g_object_unref (input);
+
+  if (pixbuf == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_pointer (task,
+                         ido_album_art_surface_from_pixbuf (pixbuf, load->key.scale),
+                         (GDestroyNotify) cairo_surface_destroy);
+  g_object_unref (pixbuf);
+}
+
+static void
+ido_album_art_decoded (GObject      *object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  IdoAlbumArtLoad *load = user_data;
+  cairo_surface_t *surface;
+  GError *error = NULL;
+
+  surface = g_task_propagate_pointer (G_TASK (result), &error);
+
+  ido_album_art_load_complete (load, surface, error);
+
+  g_clear_pointer (&surface, cairo_surface_destroy);
+  g_clear_error (&error);
+}
+
+/**
+ * ido_album_art_load_async: (skip)
+ * @url: the URL of the art
+ * @scale: the device scale the art will be shown at
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: called when the art is ready
+ * @user_data: data for @callback
+ *
+ * Loads the art at @url in a worker thread and decodes it to fit
+ * %IDO_ALBUM_ART_SIZE times @scale pixels, into an image surface with
+ * a device scale of @scale. The result is added to the album art cache. Requests for art that is
+ * already being loaded join that load instead of reading @url again.
+ * Cancelling @cancellable completes this request with
+ * %G_IO_ERROR_CANCELLED without waiting for the shared load, which
+ * keeps running for the others and for the cache.
+ */
+void
+ido_album_art_load_async (const gchar         *url,
+                          gint                 scale,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+  IdoAlbumArtLoad *load;
+  IdoAlbumArtKey key;
+  cairo_surface_t *surface;
+  GTask *task;
+
+  g_return_if_fail (url != NULL);
+
+  scale = MAX (scale, 1);
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ido_album_art_load_async);
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_object_unref (task);
+      return;
+    }
+
+  surface = ido_album_art_cache_lookup (url, scale);
+  if (surface)
+    {
+      g_task_return_pointer (task, surface, (GDestroyNotify) cairo_surface_destroy);
+      g_object_unref (task);
+      return;
+    }
+
+  if (loads == NULL)
+    loads = g_hash_table_new (ido_album_art_key_hash, ido_album_art_key_equal);
+
+  key.url = (gchar *) url;
+  key.scale = scale;
+
+  load = g_hash_table_lookup (loads, &key);
+  if (load == NULL)
+    {
+      GTask *decode;
+
+      load = g_slice_new0 (IdoAlbumArtLoad);
+      load->key.url = g_strdup (url);
+      load->key.scale = scale;
+      g_hash_table_insert (loads, &load->key, load);
+
+      decode = g_task_new (NULL, NULL, ido_album_art_decoded, load);
+      g_task_set_task_data (decode, load, NULL);
+      g_task_run_in_thread (decode, ido_album_art_decode_thread);
+      g_object_unref (decode);
+    }
+
+  g_task_set_task_data (task, load, NULL);
+  load->tasks = g_slist_prepend (load->tasks, task);
+
+  if (cancellable)
+    g_signal_connect (cancellable, "cancelled", G_CALLBACK (ido_album_art_request_cancelled), task);
+}
+
+/**
+ * ido_album_art_load_finish: (skip)
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError
+ *
+ * Returns: (transfer full): the decoded art, or %NULL on error
+ */
+cairo_surface_t *
+ido_album_art_load_finish (GAsyncResult  *result,
+                           GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * ido_album_art_get_n_loading: (skip)
+ *
+ * Returns: how many reads and decodes are in flight, however many
+ *   requests are waiting for each of them
+ */
+guint
+ido_album_art_get_n_loading (void)
+{
+  return loads ? g_hash_table_size (loads) : 0;
+}
+
+/**
+ * ido_album_art_new_from_bytes: (skip)
+ * @bytes: a thumbnail, encoded or as raw pixels
+ * @width: the width of raw RGBA pixels in @bytes, or 0 if it is encoded
+ * @height: the height of raw RGBA pixels in @bytes, or 0 if it is encoded
+ * @scale: the device scale the art will be shown at
+ * @error: return location for a #GError
+ *
+ * Turns a thumbnail that came with the metadata into art, without any
+ * file I/O. Raw pixels are non-premultiplied RGBA, @width * 4 bytes a
+ * row; they are wrapped without a copy and premultiplied straight into
+ * the surface, which is scaled so that the art is shown at
+ * %IDO_ALBUM_ART_SIZE, or smaller if the thumbnail is. Encoded images
+ * are decoded to fit %IDO_ALBUM_ART_SIZE times @scale pixels. Both are
+ * meant for small, pre-scaled thumbnails and run on the calling thread.
+ *
+ * Returns: (transfer full): an image surface, or %NULL on error
+ */
+cairo_surface_t *
+ido_album_art_new_from_bytes (GBytes  *bytes,
+                              gint     width,
+                              gint     height,
+                              gint     scale,
+                              GError **error)
+{
+  cairo_surface_t *surface;
+  GdkPixbuf *pixbuf;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  if (width > 0 && height > 0)
+    {
+      if (g_bytes_get_size (bytes) != (gsize) width * height * 4)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                       "%" G_GSIZE_FORMAT " bytes are not %dx%d RGBA pixels",
+                       g_bytes_get_size (bytes), width, height);
+          return NULL;
+        }
+
+      pixbuf = gdk_pixbuf_new_from_bytes (bytes, GDK_COLORSPACE_RGB, TRUE, 8, width, height, width * 4);
+      surface = ido_album_art_surface_from_pixbuf (pixbuf,
+                                                   MAX ((gdouble) MAX (width, height) / IDO_ALBUM_ART_SIZE, 1.0));
+    }
+  else
+    {
+      GInputStream *input;
+      gint size;
+
+      scale = MAX (scale, 1);
+      size = IDO_ALBUM_ART_SIZE * scale;
+
+      input = g_memory_input_stream_new_from_bytes (bytes);
+      pixbuf = gdk_pixbuf_new_from_stream_at_scale (input, size, size, TRUE, NULL, error);
+      g_object_unref (input);
+
+      if (pixbuf == NULL)
+        return NULL;
+
+      surface = ido_album_art_surface_from_pixbuf (pixbuf, scale);
+    }
+
+  g_object_unref (pixbuf);
+
+  return surface;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __IDO_ALBUM_ART_H__
+#define __IDO_ALBUM_ART_H__
+
+#include <cairo.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define IDO_ALBUM_ART_SIZE 60
+#define IDO_ALBUM_ART_CACHE_DEFAULT_MAX_BYTES (4 * 1024 * 1024)
+
+void                ido_album_art_load_async            (const gchar         *url,
+                                                         gint                 scale,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         gpointer             user_data);
+
+cairo_surface_t *   ido_album_art_load_finish           (GAsyncResult        *result,
+                                                         GError             **error);
+
+guint               ido_album_art_get_n_loading         (void);
+
+cairo_surface_t *   ido_album_art_new_from_bytes        (GBytes              *bytes,
+                                                         gint                 width,
+                                                         gint                 height,
+                                                         gint                 scale,
+                                                         GError             **error);
+
+cairo_surface_t *   ido_album_art_cache_lookup          (const gchar     *url,
+                                                         gint             scale);
+
+void                ido_album_art_cache_insert          (const gchar     *url,
+                                                         gint             scale,
+                                                         cairo_surface_t *surface);
+
+void                ido_album_art_cache_set_max_bytes   (gsize            max_bytes);
+
+gsize               ido_album_art_cache_get_max_bytes   (void);
+
+gsize               ido_album_art_cache_get_n_bytes     (void);
+
+guint               ido_album_art_cache_get_n_entries   (void);
+
+void                ido_album_art_cache_clear           (void);
+
+G_END_DECLS
+
+#endif
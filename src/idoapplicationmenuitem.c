@@ -127,14 +127,21 @@ static void
 ido_application_menu_item_set_label (IdoApplicationMenuItem *item,
                                      const gchar            *label)
 {
-  gtk_label_set_label (GTK_LABEL (item->label), label);
+  if (g_strcmp0 (gtk_label_get_label (GTK_LABEL (item->label)), label))
+    gtk_label_set_label (GTK_LABEL (item->label), label);
 }
 
 static void
 ido_application_menu_item_set_icon (IdoApplicationMenuItem *item,
                                     GIcon                  *icon)
 {
-  gtk_image_set_from_gicon (GTK_IMAGE (item->icon), icon, GTK_ICON_SIZE_MENU);
+  GIcon *current = NULL;
+
+  if (gtk_image_get_storage_type (GTK_IMAGE (item->icon)) == GTK_IMAGE_GICON)
+    gtk_image_get_gicon (GTK_IMAGE (item->icon), &current, NULL);
+
+  if (current == NULL || !g_icon_equal (current, icon))
+    gtk_image_set_from_gicon (GTK_IMAGE (item->icon), icon, GTK_ICON_SIZE_MENU);
 }
 
 static void
@@ -144,21 +151,49 @@ ido_application_menu_item_state_changed (IdoActionHelper *helper,
 {
   IdoApplicationMenuItem *item = user_data;
 
-  item->is_running = g_variant_get_boolean (state);
-  gtk_widget_queue_draw (GTK_WIDGET (item));
+  if (item->is_running != g_variant_get_boolean (state))
+    {
+      item->is_running = g_variant_get_boolean (state);
+      gtk_widget_queue_draw (GTK_WIDGET (item));
+    }
 }
 
-GtkMenuItem *
-ido_application_menu_item_new_from_model (GMenuItem    *menuitem,
-                                          GActionGroup *actions)
+/**
+ * ido_application_menu_item_update_from_model:
+ * @item: an #IdoApplicationMenuItem
+ * @menuitem: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menuitem's action
+ *
+ * Applies the label, icon and action of @menuitem to an
+ * #IdoApplicationMenuItem. If @menuitem is %NULL, the item is left as
+ * blank as a new one, without an action binding.
+ */
+void
+ido_application_menu_item_update_from_model (GtkMenuItem  *item,
+                                             GMenuItem    *menuitem,
+                                             GActionGroup *actions)
 {
-  GtkMenuItem *item;
+  IdoActionHelper *helper;
   gchar *label;
   GVariant *serialized_icon;
-  gchar *action;
+  gchar *action = NULL;
 
-  item = g_object_new (IDO_TYPE_APPLICATION_MENU_ITEM, NULL);
-  gtk_widget_set_margin_end(IDO_APPLICATION_MENU_ITEM(item)->label, 16);
+  g_return_if_fail (IS_IDO_APPLICATION_MENU_ITEM (item));
+
+  if (menuitem == NULL)
+    {
+      IdoApplicationMenuItem *self = IDO_APPLICATION_MENU_ITEM (item);
+
+      ido_action_helper_bind_widget (GTK_WIDGET (item), NULL, NULL, NULL);
+      ido_application_menu_item_set_label (self, "");
+      gtk_image_clear (GTK_IMAGE (self->icon));
+      if (self->is_running)
+        {
+          self->is_running = FALSE;
+          gtk_widget_queue_draw (GTK_WIDGET (self));
+        }
+      return;
+    }
 
   if (g_menu_item_get_attribute (menuitem, "label", "s", &label))
     {
@@ -181,20 +216,31 @@ ido_application_menu_item_new_from_model (GMenuItem    *menuitem,
       g_variant_unref (serialized_icon);
     }
 
-  if (g_menu_item_get_attribute (menuitem, "action", "s", &action))
-    {
-      IdoActionHelper *helper;
+  g_menu_item_get_attribute (menuitem, "action", "s", &action);
 
-      helper = ido_action_helper_new (GTK_WIDGET (item), actions, action, NULL);
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (item), actions, action, NULL);
+  if (helper)
+    {
       g_signal_connect (helper, "action-state-changed",
                         G_CALLBACK (ido_application_menu_item_state_changed), item);
       g_signal_connect_object (item, "activate",
                                G_CALLBACK (ido_action_helper_activate), helper,
                                G_CONNECT_SWAPPED);
-      g_signal_connect_swapped (item, "destroy", G_CALLBACK (g_object_unref), helper);
-
-      g_free (action);
     }
 
+  g_free (action);
+}
+
+GtkMenuItem *
+ido_application_menu_item_new_from_model (GMenuItem    *menuitem,
+                                          GActionGroup *actions)
+{
+  GtkMenuItem *item;
+
+  item = g_object_new (IDO_TYPE_APPLICATION_MENU_ITEM, NULL);
+  gtk_widget_set_margin_end(IDO_APPLICATION_MENU_ITEM(item)->label, 16);
+
+  ido_application_menu_item_update_from_model (item, menuitem, actions);
+
   return item;
 }
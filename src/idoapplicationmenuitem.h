@@ -33,4 +33,8 @@ GType                   ido_application_menu_item_get_type              (void);
 GtkMenuItem *           ido_application_menu_item_new_from_model        (GMenuItem    *item,
                                                                          GActionGroup *actions);
 
+void                    ido_application_menu_item_update_from_model     (GtkMenuItem  *item,
+                                                                         GMenuItem    *menuitem,
+                                                                         GActionGroup *actions);
+
 #endif
@@ -68,95 +68,96 @@ create_color_icon_pixbuf (const char * color_spec)
 }
 
 /**
- * ido_appointment_menu_item_new_from_model:
- * @menu_item: the corresponding menuitem
- * @actions: action group to tell when this GtkMenuItem is activated
- *
- * Creates a new IdoTimeStampMenuItem with properties initialized
- * appropriately for a org.ayatana.indicator.alarm
+ * ido_appointment_menu_item_update_from_model:
+ * @item: a menuitem built by ido_appointment_menu_item_new_from_model()
+ * @menu_item: (nullable): the corresponding menuitem
+ * @actions: (nullable): action group to tell when @item is activated
  *
- * If the menuitem's 'action' attribute is set, trigger that action
- * in @actions when this IdoAppointmentMenuItem is activated.
+ * Applies the attributes and action of @menu_item to @item, touching
+ * only what differs from the current values. If @menu_item is %NULL,
+ * the item is left as blank as a new one, without an action binding.
  */
-GtkMenuItem *
-ido_appointment_menu_item_new_from_model (GMenuItem    * menu_item,
-                                          GActionGroup * actions)
+void
+ido_appointment_menu_item_update_from_model (GtkMenuItem  * item,
+                                             GMenuItem    * menu_item,
+                                             GActionGroup * actions)
 {
-  guint i;
-  guint n;
+  IdoTimeStampMenuItem * ido_menu_item;
   gint64 i64;
-  gchar * str;
-  IdoBasicMenuItem * ido_menu_item;
-  const gchar * names[4] = {0};
-  GValue * values;
-  const guint n_max = 4;
+  gchar * str = NULL;
 
-  /* create the ido_menu_item */
+  g_return_if_fail (IDO_IS_TIME_STAMP_MENU_ITEM (item));
 
-  n = 0;
-  values = g_new0(GValue, n_max);
-
-  if (g_menu_item_get_attribute (menu_item, G_MENU_ATTRIBUTE_LABEL, "s", &str))
+  if (menu_item == NULL)
     {
-      names[n] = "text";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
+      ido_basic_menu_item_clear (IDO_BASIC_MENU_ITEM (item));
+      ido_time_stamp_menu_item_set_date_time (IDO_TIME_STAMP_MENU_ITEM (item), NULL);
+      ido_time_stamp_menu_item_set_format (IDO_TIME_STAMP_MENU_ITEM (item), NULL);
+      g_object_set_data (G_OBJECT (item), "ido-appointment-color", NULL);
+      return;
     }
 
-  if (g_menu_item_get_attribute (menu_item, "x-ayatana-color", "s", &str))
+  ido_menu_item = IDO_TIME_STAMP_MENU_ITEM (item);
+
+  g_menu_item_get_attribute (menu_item, G_MENU_ATTRIBUTE_LABEL, "s", &str);
+  ido_basic_menu_item_set_text (IDO_BASIC_MENU_ITEM (ido_menu_item), str);
+  g_free (str);
+  str = NULL;
+
+  /* the color swatch is only re-rendered when the color changes */
+  g_menu_item_get_attribute (menu_item, "x-ayatana-color", "s", &str);
+  if (g_strcmp0 (g_object_get_data (G_OBJECT (item), "ido-appointment-color"), str))
     {
-      names[n] = "pixbuf";
-      g_value_init (&values[n], G_TYPE_OBJECT);
-      g_value_take_object (&values[n], create_color_icon_pixbuf (str));
-      g_free(str);
-      n++;
-    }
+      GdkPixbuf * pixbuf = create_color_icon_pixbuf (str);
 
-  if (g_menu_item_get_attribute (menu_item, "x-ayatana-time-format", "s", &str))
+      ido_basic_menu_item_set_pixbuf (IDO_BASIC_MENU_ITEM (ido_menu_item), pixbuf);
+      g_clear_object (&pixbuf);
+      g_object_set_data_full (G_OBJECT (item), "ido-appointment-color", str, g_free);
+    }
+  else
     {
-      names[n] = "format";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
+      g_free (str);
     }
 
+  /* a missing format or time is unset, like on a new item */
+  str = NULL;
+  g_menu_item_get_attribute (menu_item, "x-ayatana-time-format", "s", &str);
+  ido_time_stamp_menu_item_set_format (ido_menu_item, str);
+  g_free (str);
+
   if (g_menu_item_get_attribute (menu_item, "x-ayatana-time", "x", &i64))
     {
-      names[n] = "date-time";
-      g_value_init (&values[n], G_TYPE_DATE_TIME);
-      g_value_take_boxed (&values[n], g_date_time_new_from_unix_local (i64));
-      n++;
+      GDateTime * date_time = g_date_time_new_from_unix_local (i64);
+      ido_time_stamp_menu_item_set_date_time (ido_menu_item, date_time);
+      g_date_time_unref (date_time);
+    }
+  else
+    {
+      ido_time_stamp_menu_item_set_date_time (ido_menu_item, NULL);
     }
 
-  g_assert (n <= G_N_ELEMENTS (names));
-  g_assert (n <= n_max);
-  ido_menu_item = IDO_BASIC_MENU_ITEM(g_object_new_with_properties (IDO_TYPE_TIME_STAMP_MENU_ITEM, n, names, values));
-
-  for (i=0; i<n; i++)
-    g_value_unset (&values[i]);
-
-  g_free (values);
+  ido_basic_menu_item_bind_action (IDO_BASIC_MENU_ITEM (ido_menu_item), menu_item, actions);
+}
 
-  /* add an ActionHelper */
+/**
+ * ido_appointment_menu_item_new_from_model:
+ * @menu_item: the corresponding menuitem
+ * @actions: action group to tell when this GtkMenuItem is activated
+ *
+ * Creates a new IdoTimeStampMenuItem with properties initialized
+ * appropriately for a org.ayatana.indicator.alarm
+ *
+ * If the menuitem's 'action' attribute is set, trigger that action
+ * in @actions when this IdoAppointmentMenuItem is activated.
+ */
+GtkMenuItem *
+ido_appointment_menu_item_new_from_model (GMenuItem    * menu_item,
+                                          GActionGroup * actions)
+{
+  GtkWidget * ido_menu_item;
 
-  if (g_menu_item_get_attribute (menu_item, "action", "s", &str))
-    {
-      GVariant * target;
-      IdoActionHelper * helper;
-
-      target = g_menu_item_get_attribute_value (menu_item, "target",
-                                                G_VARIANT_TYPE_ANY);
-      helper = ido_action_helper_new (GTK_WIDGET(ido_menu_item), actions,
-                                      str, target);
-      g_signal_connect_swapped (ido_menu_item, "activate",
-                                G_CALLBACK (ido_action_helper_activate), helper);
-      g_signal_connect_swapped (ido_menu_item, "destroy",
-                                G_CALLBACK (g_object_unref), helper);
-
-      g_clear_pointer (&target, g_variant_unref);
-      g_free (str);
-    }
+  ido_menu_item = ido_time_stamp_menu_item_new ();
+  ido_appointment_menu_item_update_from_model (GTK_MENU_ITEM (ido_menu_item), menu_item, actions);
 
   return GTK_MENU_ITEM (ido_menu_item);
 }
@@ -27,6 +27,10 @@ G_BEGIN_DECLS
 GtkMenuItem * ido_appointment_menu_item_new_from_model (GMenuItem    * menuitem,
                                                         GActionGroup * actions);
 
+void ido_appointment_menu_item_update_from_model       (GtkMenuItem  * item,
+                                                        GMenuItem    * menuitem,
+                                                        GActionGroup * actions);
+
 G_END_DECLS
 
 #endif
@@ -291,7 +291,7 @@ ido_basic_menu_item_set_icon (IdoBasicMenuItem * self, GIcon * icon)
 {
   IdoBasicMenuItemPrivate *p = ido_basic_menu_item_get_instance_private(self);
 
-  if (p->icon != icon)
+  if (!g_icon_equal (p->icon, icon))
     {
       if (p->icon)
         g_object_unref (p->icon);
@@ -385,73 +385,137 @@ ido_basic_menu_item_activate (GtkMenuItem *item,
   ido_action_helper_activate (helper);
 }
 
-GtkMenuItem *
-ido_basic_menu_item_new_from_model (GMenuItem    * menu_item,
-                                    GActionGroup * actions)
+/**
+ * ido_basic_menu_item_bind_action:
+ * @self: an #IdoBasicMenuItem
+ * @menu_item: the #GMenuItem holding the action
+ * @actions: the #GActionGroup of @menu_item's action
+ *
+ * Binds @self to the "action" and "target" attributes of @menu_item, so
+ * that activating @self activates that action. The current binding is
+ * kept if neither the action nor its target have changed.
+ */
+void
+ido_basic_menu_item_bind_action (IdoBasicMenuItem * self,
+                                 GMenuItem        * menu_item,
+                                 GActionGroup     * actions)
 {
-  GtkWidget *item;
-  gchar *label;
-  gchar *action;
+  IdoActionHelper *helper;
+  gchar *action = NULL;
+  GVariant *target;
+
+  g_menu_item_get_attribute (menu_item, "action", "s", &action);
+  target = g_menu_item_get_attribute_value (menu_item, "target", NULL);
+
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (self), actions, action, target);
+  if (helper)
+    g_signal_connect_object (self, "activate",
+                             G_CALLBACK (ido_basic_menu_item_activate), helper,
+                             0);
+
+  if (target)
+    g_variant_unref (target);
+  g_free (action);
+}
+
+/**
+ * ido_basic_menu_item_clear:
+ * @self: an #IdoBasicMenuItem
+ *
+ * Drops the action binding, texts and icon of @self, leaving it as
+ * blank as a new item, so that it can be recycled for another menu
+ * model entry.
+ */
+void
+ido_basic_menu_item_clear (IdoBasicMenuItem * self)
+{
+  IdoBasicMenuItemPrivate *p = ido_basic_menu_item_get_instance_private (self);
+
+  ido_action_helper_bind_widget (GTK_WIDGET (self), NULL, NULL, NULL);
+
+  g_object_set (p->label, "use-markup", FALSE, NULL);
+  g_object_set (p->secondary_label, "use-markup", FALSE, NULL);
+  ido_basic_menu_item_set_text (self, NULL);
+  ido_basic_menu_item_set_secondary_text (self, NULL);
+  ido_basic_menu_item_set_icon (self, NULL);
+  ido_basic_menu_item_set_pixbuf (self, NULL);
+}
+
+/**
+ * ido_basic_menu_item_update_from_model:
+ * @item: an #IdoBasicMenuItem
+ * @menu_item: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menu_item's action
+ *
+ * Applies the attributes and action of @menu_item to @item. If
+ * @menu_item is %NULL, @item is cleared with ido_basic_menu_item_clear().
+ */
+void
+ido_basic_menu_item_update_from_model (GtkMenuItem  * item,
+                                       GMenuItem    * menu_item,
+                                       GActionGroup * actions)
+{
+  IdoBasicMenuItem *self;
+  IdoBasicMenuItemPrivate *p;
+  gchar *label = NULL;
   GVariant *serialized_icon;
+  GIcon *icon = NULL;
 
-  item = ido_basic_menu_item_new ();
+  g_return_if_fail (IDO_IS_BASIC_MENU_ITEM (item));
+
+  self = IDO_BASIC_MENU_ITEM (item);
+  p = ido_basic_menu_item_get_instance_private (self);
+
+  if (menu_item == NULL)
+    {
+      ido_basic_menu_item_clear (self);
+      return;
+    }
 
-    IdoBasicMenuItemPrivate *p = ido_basic_menu_item_get_instance_private(IDO_BASIC_MENU_ITEM(item));
     gboolean use_markup = FALSE;
     g_menu_item_get_attribute(menu_item, "x-ayatana-use-markup", "b", &use_markup);
     g_object_set(p->label, "use-markup", use_markup, NULL);
     g_object_set(p->secondary_label, "use-markup", use_markup, NULL);
 
-  if (g_menu_item_get_attribute (menu_item, "label", "s", &label))
-    {
-      ido_basic_menu_item_set_text (IDO_BASIC_MENU_ITEM (item), label);
-      g_free (label);
-    }
+  g_menu_item_get_attribute (menu_item, "label", "s", &label);
+  ido_basic_menu_item_set_text (self, label);
+  g_free (label);
 
-    gchar *sSecondaryText;
+    gchar *sSecondaryText = NULL;
+    gint nSecondaryCount;
 
-    if (g_menu_item_get_attribute (menu_item, "x-ayatana-secondary-text", "s", &sSecondaryText))
+    if (g_menu_item_get_attribute (menu_item, "x-ayatana-secondary-count", "i", &nSecondaryCount))
     {
-        ido_basic_menu_item_set_secondary_text (IDO_BASIC_MENU_ITEM (item), sSecondaryText);
-        g_free (sSecondaryText);
+        ido_basic_menu_item_set_secondary_count (self, nSecondaryCount);
     }
-
-    guint nSecondaryCount;
-
-    if (g_menu_item_get_attribute (menu_item, "x-ayatana-secondary-count", "i", &nSecondaryCount))
+    else
     {
-        ido_basic_menu_item_set_secondary_count (IDO_BASIC_MENU_ITEM (item), nSecondaryCount);
+        g_menu_item_get_attribute (menu_item, "x-ayatana-secondary-text", "s", &sSecondaryText);
+        ido_basic_menu_item_set_secondary_text (self, sSecondaryText);
+        g_free (sSecondaryText);
     }
 
   serialized_icon = g_menu_item_get_attribute_value (menu_item, "icon", NULL);
   if (serialized_icon)
     {
-      GIcon *icon;
-
       icon = g_icon_deserialize (serialized_icon);
-      ido_basic_menu_item_set_icon (IDO_BASIC_MENU_ITEM (item), icon);
-
-      g_object_unref (icon);
       g_variant_unref (serialized_icon);
     }
 
-  if (g_menu_item_get_attribute (menu_item, "action", "s", &action))
-    {
-      IdoActionHelper *helper;
-      GVariant *target;
+  ido_basic_menu_item_set_icon (self, icon);
+  g_clear_object (&icon);
 
-      target = g_menu_item_get_attribute_value (menu_item, "target", NULL);
+  ido_basic_menu_item_bind_action (self, menu_item, actions);
+}
 
-      helper = ido_action_helper_new (item, actions, action, target);
-      g_signal_connect_object (item, "activate",
-                               G_CALLBACK (ido_basic_menu_item_activate), helper,
-                               0);
-      g_signal_connect_swapped (item, "destroy", G_CALLBACK (g_object_unref), helper);
+GtkMenuItem *
+ido_basic_menu_item_new_from_model (GMenuItem    * menu_item,
+                                    GActionGroup * actions)
+{
+  GtkWidget *item;
 
-      if (target)
-        g_variant_unref (target);
-      g_free (action);
-    }
+  item = ido_basic_menu_item_new ();
+  ido_basic_menu_item_update_from_model (GTK_MENU_ITEM (item), menu_item, actions);
 
   return GTK_MENU_ITEM (item);
 }
@@ -70,6 +70,16 @@ void ido_basic_menu_item_set_secondary_text      (IdoBasicMenuItem * self,
 GtkMenuItem * ido_basic_menu_item_new_from_model (GMenuItem    * menuitem,
                                                   GActionGroup * actions);
 
+void ido_basic_menu_item_update_from_model       (GtkMenuItem  * item,
+                                                  GMenuItem    * menuitem,
+                                                  GActionGroup * actions);
+
+void ido_basic_menu_item_bind_action             (IdoBasicMenuItem * self,
+                                                  GMenuItem        * menuitem,
+                                                  GActionGroup     * actions);
+
+void ido_basic_menu_item_clear                   (IdoBasicMenuItem * self);
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,819 @@
+/*
+ * Copyright 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *     Mirco Müller <mirco.mueller@canonical.com>
+ */
+
+#include "idoblur.h"
+
+#include <math.h>
+#include <string.h>
+
+#define IDO_BLUR_MAX_WORKERS 3
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Exponential blur: every row, then every column, is run through a
+ * first order IIR filter forwards and then backwards. The accumulators
+ * are fixed point with zprec fractional bits, alpha has aprec bits.
+ */
+
+static inline void
+_blurinner (guchar* pixel,
+      gint*   zR,
+      gint*   zG,
+      gint*   zB,
+      gint*   zA,
+      gint    alpha,
+      gint    aprec,
+      gint    zprec)
+{
+  gint R;
+  gint G;
+  gint B;
+  guchar A;
+
+  R = *pixel;
+  G = *(pixel + 1);
+  B = *(pixel + 2);
+  A = *(pixel + 3);
+
+  *zR += (alpha * ((R << zprec) - *zR)) >> aprec;
+  *zG += (alpha * ((G << zprec) - *zG)) >> aprec;
+  *zB += (alpha * ((B << zprec) - *zB)) >> aprec;
+  *zA += (alpha * ((A << zprec) - *zA)) >> aprec;
+
+  *pixel       = *zR >> zprec;
+  *(pixel + 1) = *zG >> zprec;
+  *(pixel + 2) = *zB >> zprec;
+  *(pixel + 3) = *zA >> zprec;
+}
+
+static inline void
+_blurrow (guchar* pixels,
+    gint    width,
+    gint    height,
+    gint    channels,
+    gint    line,
+    gint    alpha,
+    gint    aprec,
+    gint    zprec)
+{
+  gint    zR;
+  gint    zG;
+  gint    zB;
+  gint    zA;
+  gint    index;
+  guchar* scanline;
+
+  scanline = &(pixels[line * width * channels]);
+
+  zR = *scanline << zprec;
+  zG = *(scanline + 1) << zprec;
+  zB = *(scanline + 2) << zprec;
+  zA = *(scanline + 3) << zprec;
+
+  for (index = 0; index < width; index ++)
+    _blurinner (&scanline[index * channels],
+          &zR,
+          &zG,
+          &zB,
+          &zA,
+          alpha,
+          aprec,
+          zprec);
+
+  for (index = width - 2; index >= 0; index--)
+    _blurinner (&scanline[index * channels],
+          &zR,
+          &zG,
+          &zB,
+          &zA,
+          alpha,
+          aprec,
+          zprec);
+}
+
+static inline void
+_blurcol (guchar* pixels,
+    gint    width,
+    gint    height,
+    gint    channels,
+    gint    x,
+    gint    alpha,
+    gint    aprec,
+    gint    zprec)
+{
+  gint zR;
+  gint zG;
+  gint zB;
+  gint zA;
+  gint index;
+  guchar* ptr;
+
+  ptr = pixels;
+
+  ptr += x * channels;
+
+  zR = *((guchar*) ptr    ) << zprec;
+  zG = *((guchar*) ptr + 1) << zprec;
+  zB = *((guchar*) ptr + 2) << zprec;
+  zA = *((guchar*) ptr + 3) << zprec;
+
+  for (index = width; index < (height - 1) * width; index += width)
+    _blurinner ((guchar*) &ptr[index * channels],
+          &zR,
+          &zG,
+          &zB,
+          &zA,
+          alpha,
+          aprec,
+          zprec);
+
+  for (index = (height - 2) * width; index >= 0; index -= width)
+    _blurinner ((guchar*) &ptr[index * channels],
+          &zR,
+          &zG,
+          &zB,
+          &zA,
+          alpha,
+          aprec,
+          zprec);
+}
+
+
+#ifdef HAVE_X86_SIMD
+
+/*
+ * The vector kernels keep the four channels of a pixel in four 32 bit
+ * lanes and do the same integer arithmetic as _blurinner(), so their
+ * output is identical. alpha < 1 << aprec and the accumulators stay
+ * within [0, 255 << zprec], so the products fit in 32 bits. Columns are
+ * blurred a tile of neighbouring pixels at a time, which turns the
+ * column walk into contiguous loads of every row.
+ */
+
+/* SSE2 has no 32 bit multiply; the low halves of two 32x32->64 bit
+ * multiplies are the same for signed and unsigned operands */
+__attribute__((target ("sse2")))
+static inline __m128i
+_sse2_mullo (__m128i a,
+             __m128i b)
+{
+  __m128i even = _mm_mul_epu32 (a, b);
+  __m128i odd = _mm_mul_epu32 (_mm_srli_si128 (a, 4), _mm_srli_si128 (b, 4));
+
+  return _mm_unpacklo_epi32 (_mm_shuffle_epi32 (even, _MM_SHUFFLE (0, 0, 2, 0)),
+                             _mm_shuffle_epi32 (odd, _MM_SHUFFLE (0, 0, 2, 0)));
+}
+
+__attribute__((target ("sse2")))
+static inline __m128i
+_sse2_load (const guchar *pixel)
+{
+  __m128i zero = _mm_setzero_si128 ();
+  guint32 value;
+
+  memcpy (&value, pixel, sizeof (value));
+
+  return _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (value), zero), zero);
+}
+
+__attribute__((target ("sse2")))
+static inline void
+_sse2_store (guchar  *pixel,
+             __m128i  z,
+             __m128i  zprec)
+{
+  __m128i value = _mm_sra_epi32 (z, zprec);
+  guint32 packed;
+
+  value = _mm_packs_epi32 (value, value);
+  packed = _mm_cvtsi128_si32 (_mm_packus_epi16 (value, value));
+
+  memcpy (pixel, &packed, sizeof (packed));
+}
+
+__attribute__((target ("sse2")))
+static inline __m128i
+_sse2_blurinner (__m128i z,
+                 __m128i pixel,
+                 __m128i alpha,
+                 __m128i aprec,
+                 __m128i zprec)
+{
+  __m128i delta = _mm_sub_epi32 (_mm_sll_epi32 (pixel, zprec), z);
+
+  return _mm_add_epi32 (z, _mm_sra_epi32 (_sse2_mullo (alpha, delta), aprec));
+}
+
+__attribute__((target ("sse2")))
+static void
+_blurrows_sse2 (guchar* pixels,
+                gint    width,
+                gint    row_start,
+                gint    row_end,
+                gint    alpha,
+                gint    aprec,
+                gint    zprec)
+{
+  __m128i valpha = _mm_set1_epi32 (alpha);
+  __m128i vaprec = _mm_cvtsi32_si128 (aprec);
+  __m128i vzprec = _mm_cvtsi32_si128 (zprec);
+  gint row;
+  gint index;
+
+  for (row = row_start; row < row_end; row++)
+    {
+      guchar *scanline = pixels + row * width * 4;
+      __m128i z = _mm_sll_epi32 (_sse2_load (scanline), vzprec);
+
+      for (index = 0; index < width; index++)
+        {
+          z = _sse2_blurinner (z, _sse2_load (scanline + index * 4), valpha, vaprec, vzprec);
+          _sse2_store (scanline + index * 4, z, vzprec);
+        }
+
+      for (index = width - 2; index >= 0; index--)
+        {
+          z = _sse2_blurinner (z, _sse2_load (scanline + index * 4), valpha, vaprec, vzprec);
+          _sse2_store (scanline + index * 4, z, vzprec);
+        }
+    }
+}
+
+__attribute__((target ("sse2")))
+static inline void
+_sse2_blurtile (guchar  *pixel,
+                __m128i *z,
+                __m128i  alpha,
+                __m128i  aprec,
+                __m128i  zprec)
+{
+  __m128i zero = _mm_setzero_si128 ();
+  __m128i raw = _mm_loadu_si128 ((const __m128i *) pixel);
+  __m128i lo = _mm_unpacklo_epi8 (raw, zero);
+  __m128i hi = _mm_unpackhi_epi8 (raw, zero);
+
+  z[0] = _sse2_blurinner (z[0], _mm_unpacklo_epi16 (lo, zero), alpha, aprec, zprec);
+  z[1] = _sse2_blurinner (z[1], _mm_unpackhi_epi16 (lo, zero), alpha, aprec, zprec);
+  z[2] = _sse2_blurinner (z[2], _mm_unpacklo_epi16 (hi, zero), alpha, aprec, zprec);
+  z[3] = _sse2_blurinner (z[3], _mm_unpackhi_epi16 (hi, zero), alpha, aprec, zprec);
+
+  _mm_storeu_si128 ((__m128i *) pixel,
+                    _mm_packus_epi16 (_mm_packs_epi32 (_mm_sra_epi32 (z[0], zprec), _mm_sra_epi32 (z[1], zprec)),
+                                      _mm_packs_epi32 (_mm_sra_epi32 (z[2], zprec), _mm_sra_epi32 (z[3], zprec))));
+}
+
+__attribute__((target ("sse2")))
+static void
+_blurcols_sse2 (guchar* pixels,
+                gint    width,
+                gint    height,
+                gint    col_start,
+                gint    col_end,
+                gint    alpha,
+                gint    aprec,
+                gint    zprec)
+{
+  __m128i valpha = _mm_set1_epi32 (alpha);
+  __m128i vaprec = _mm_cvtsi32_si128 (aprec);
+  __m128i vzprec = _mm_cvtsi32_si128 (zprec);
+  gint stride = width * 4;
+  gint col = col_start;
+  gint row;
+
+  /* four columns at a time */
+  for (; col + 4 <= col_end; col += 4)
+    {
+      guchar *ptr = pixels + col * 4;
+      __m128i z[4];
+      gint i;
+
+      for (i = 0; i < 4; i++)
+        z[i] = _mm_sll_epi32 (_sse2_load (ptr + i * 4), vzprec);
+
+      for (row = 1; row < height - 1; row++)
+        _sse2_blurtile (ptr + row * stride, z, valpha, vaprec, vzprec);
+
+      for (row = height - 2; row >= 0; row--)
+        _sse2_blurtile (ptr + row * stride, z, valpha, vaprec, vzprec);
+    }
+
+  for (; col < col_end; col++)
+    {
+      guchar *ptr = pixels + col * 4;
+      __m128i z = _mm_sll_epi32 (_sse2_load (ptr), vzprec);
+
+      for (row = 1; row < height - 1; row++)
+        {
+          z = _sse2_blurinner (z, _sse2_load (ptr + row * stride), valpha, vaprec, vzprec);
+          _sse2_store (ptr + row * stride, z, vzprec);
+        }
+
+      for (row = height - 2; row >= 0; row--)
+        {
+          z = _sse2_blurinner (z, _sse2_load (ptr + row * stride), valpha, vaprec, vzprec);
+          _sse2_store (ptr + row * stride, z, vzprec);
+        }
+    }
+}
+
+/* AVX2 works on two pixels per register: two rows side by side for the
+ * row pass, two neighbouring columns for the column pass. */
+
+__attribute__((target ("avx2")))
+static inline __m256i
+_avx2_blurinner (__m256i z,
+                 __m256i pixels,
+                 __m256i alpha,
+                 __m128i aprec,
+                 __m128i zprec)
+{
+  __m256i delta = _mm256_sub_epi32 (_mm256_sll_epi32 (pixels, zprec), z);
+
+  return _mm256_add_epi32 (z, _mm256_sra_epi32 (_mm256_mullo_epi32 (alpha, delta), aprec));
+}
+
+__attribute__((target ("avx2")))
+static inline __m256i
+_avx2_load_rows (const guchar *a,
+                 const guchar *b)
+{
+  guint32 va, vb;
+
+  memcpy (&va, a, sizeof (va));
+  memcpy (&vb, b, sizeof (vb));
+
+  return _mm256_cvtepu8_epi32 (_mm_unpacklo_epi32 (_mm_cvtsi32_si128 (va), _mm_cvtsi32_si128 (vb)));
+}
+
+__attribute__((target ("avx2")))
+static inline void
+_avx2_store_rows (guchar  *a,
+                  guchar  *b,
+                  __m256i  z,
+                  __m128i  zprec)
+{
+  __m256i value = _mm256_sra_epi32 (z, zprec);
+  guint32 va, vb;
+
+  value = _mm256_packs_epi32 (value, value);
+  value = _mm256_packus_epi16 (value, value);
+  va = _mm_cvtsi128_si32 (_mm256_castsi256_si128 (value));
+  vb = _mm_cvtsi128_si32 (_mm256_extracti128_si256 (value, 1));
+
+  memcpy (a, &va, sizeof (va));
+  memcpy (b, &vb, sizeof (vb));
+}
+
+__attribute__((target ("avx2")))
+static void
+_blurrows_avx2 (guchar* pixels,
+                gint    width,
+                gint    row_start,
+                gint    row_end,
+                gint    alpha,
+                gint    aprec,
+                gint    zprec)
+{
+  __m256i valpha = _mm256_set1_epi32 (alpha);
+  __m128i vaprec = _mm_cvtsi32_si128 (aprec);
+  __m128i vzprec = _mm_cvtsi32_si128 (zprec);
+  gint row = row_start;
+  gint index;
+
+  for (; row + 2 <= row_end; row += 2)
+    {
+      guchar *a = pixels + row * width * 4;
+      guchar *b = a + width * 4;
+      __m256i z = _mm256_sll_epi32 (_avx2_load_rows (a, b), vzprec);
+
+      for (index = 0; index < width; index++)
+        {
+          z = _avx2_blurinner (z, _avx2_load_rows (a + index * 4, b + index * 4), valpha, vaprec, vzprec);
+          _avx2_store_rows (a + index * 4, b + index * 4, z, vzprec);
+        }
+
+      for (index = width - 2; index >= 0; index--)
+        {
+          z = _avx2_blurinner (z, _avx2_load_rows (a + index * 4, b + index * 4), valpha, vaprec, vzprec);
+          _avx2_store_rows (a + index * 4, b + index * 4, z, vzprec);
+        }
+    }
+
+  if (row < row_end)
+    _blurrows_sse2 (pixels, width, row, row_end, alpha, aprec, zprec);
+}
+
+__attribute__((target ("avx2")))
+static inline void
+_avx2_blurtile (guchar  *pixel,
+                __m256i *z,
+                __m256i  alpha,
+                __m128i  aprec,
+                __m128i  zprec)
+{
+  __m256i lo, hi;
+  gint i;
+
+  for (i = 0; i < 4; i++)
+    z[i] = _avx2_blurinner (z[i],
+                            _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) (pixel + i * 8))),
+                            alpha, aprec, zprec);
+
+  /* the packs work within 128 bit lanes, leaving the pixels in the
+   * order 0 2 4 6 1 3 5 7 */
+  lo = _mm256_packs_epi32 (_mm256_sra_epi32 (z[0], zprec), _mm256_sra_epi32 (z[1], zprec));
+  hi = _mm256_packs_epi32 (_mm256_sra_epi32 (z[2], zprec), _mm256_sra_epi32 (z[3], zprec));
+
+  _mm256_storeu_si256 ((__m256i *) pixel,
+                       _mm256_permutevar8x32_epi32 (_mm256_packus_epi16 (lo, hi),
+                                                    _mm256_setr_epi32 (0, 4, 1, 5, 2, 6, 3, 7)));
+}
+
+__attribute__((target ("avx2")))
+static void
+_blurcols_avx2 (guchar* pixels,
+                gint    width,
+                gint    height,
+                gint    col_start,
+                gint    col_end,
+                gint    alpha,
+                gint    aprec,
+                gint    zprec)
+{
+  __m256i valpha = _mm256_set1_epi32 (alpha);
+  __m128i vaprec = _mm_cvtsi32_si128 (aprec);
+  __m128i vzprec = _mm_cvtsi32_si128 (zprec);
+  gint stride = width * 4;
+  gint col = col_start;
+  gint row;
+
+  /* eight columns at a time */
+  for (; col + 8 <= col_end; col += 8)
+    {
+      guchar *ptr = pixels + col * 4;
+      __m256i z[4];
+      gint i;
+
+      for (i = 0; i < 4; i++)
+        z[i] = _mm256_sll_epi32 (_mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) (ptr + i * 8))), vzprec);
+
+      for (row = 1; row < height - 1; row++)
+        _avx2_blurtile (ptr + row * stride, z, valpha, vaprec, vzprec);
+
+      for (row = height - 2; row >= 0; row--)
+        _avx2_blurtile (ptr + row * stride, z, valpha, vaprec, vzprec);
+    }
+
+  if (col < col_end)
+    _blurcols_sse2 (pixels, width, height, col, col_end, alpha, aprec, zprec);
+}
+
+#endif /* HAVE_X86_SIMD */
+
+/**
+ * ido_blur_impl_supported: (skip)
+ * @impl: a blur implementation
+ *
+ * Returns: whether @impl can run on this machine
+ */
+gboolean
+ido_blur_impl_supported (IdoBlurImpl impl)
+{
+  switch (impl)
+    {
+    case IDO_BLUR_IMPL_AUTO:
+    case IDO_BLUR_IMPL_SCALAR:
+      return TRUE;
+
+#ifdef HAVE_X86_SIMD
+    case IDO_BLUR_IMPL_SSE2:
+      return __builtin_cpu_supports ("sse2");
+
+    case IDO_BLUR_IMPL_AVX2:
+      return __builtin_cpu_supports ("avx2");
+#endif
+
+    default:
+      return FALSE;
+    }
+}
+
+static IdoBlurImpl
+ido_blur_get_best_impl (void)
+{
+  static IdoBlurImpl best = IDO_BLUR_IMPL_AUTO;
+
+  if (best == IDO_BLUR_IMPL_AUTO)
+    {
+      if (ido_blur_impl_supported (IDO_BLUR_IMPL_AVX2))
+        best = IDO_BLUR_IMPL_AVX2;
+      else if (ido_blur_impl_supported (IDO_BLUR_IMPL_SSE2))
+        best = IDO_BLUR_IMPL_SSE2;
+      else
+        best = IDO_BLUR_IMPL_SCALAR;
+    }
+
+  return best;
+}
+
+/*
+ * Rows, and then columns, are blurred independently of each other, so
+ * either pass can be split into bands of rows or columns that give the
+ * same pixels whichever thread runs them.
+ */
+typedef struct
+{
+  IdoBlurImpl impl;
+  guchar *pixels;
+  gint width;
+  gint height;
+  gint channels;
+  gint alpha;
+  gint aprec;
+  gint zprec;
+} IdoBlurPass;
+
+typedef struct
+{
+  const IdoBlurPass *pass;
+  gboolean columns;
+  gint start;
+  gint end;
+
+  GMutex *mutex;
+  GCond *cond;
+  gint *pending;
+} IdoBlurBand;
+
+static guint parallel_threshold = IDO_BLUR_PARALLEL_THRESHOLD_DEFAULT;
+
+static void
+ido_blur_rows (const IdoBlurPass *pass,
+               gint               start,
+               gint               end)
+{
+  gint row;
+
+  switch (pass->impl)
+    {
+#ifdef HAVE_X86_SIMD
+    case IDO_BLUR_IMPL_AVX2:
+      _blurrows_avx2 (pass->pixels, pass->width, start, end, pass->alpha, pass->aprec, pass->zprec);
+      break;
+
+    case IDO_BLUR_IMPL_SSE2:
+      _blurrows_sse2 (pass->pixels, pass->width, start, end, pass->alpha, pass->aprec, pass->zprec);
+      break;
+#endif
+
+    default:
+      for (row = start; row < end; row++)
+        _blurrow (pass->pixels, pass->width, pass->height, pass->channels, row, pass->alpha, pass->aprec, pass->zprec);
+      break;
+    }
+}
+
+static void
+ido_blur_columns (const IdoBlurPass *pass,
+                  gint               start,
+                  gint               end)
+{
+  gint col;
+
+  switch (pass->impl)
+    {
+#ifdef HAVE_X86_SIMD
+    case IDO_BLUR_IMPL_AVX2:
+      _blurcols_avx2 (pass->pixels, pass->width, pass->height, start, end, pass->alpha, pass->aprec, pass->zprec);
+      break;
+
+    case IDO_BLUR_IMPL_SSE2:
+      _blurcols_sse2 (pass->pixels, pass->width, pass->height, start, end, pass->alpha, pass->aprec, pass->zprec);
+      break;
+#endif
+
+    default:
+      for (col = start; col < end; col++)
+        _blurcol (pass->pixels, pass->width, pass->height, pass->channels, col, pass->alpha, pass->aprec, pass->zprec);
+      break;
+    }
+}
+
+static void
+ido_blur_run_band (gpointer data,
+                   gpointer user_data)
+{
+  IdoBlurBand *band = data;
+
+  if (band->columns)
+    ido_blur_columns (band->pass, band->start, band->end);
+  else
+    ido_blur_rows (band->pass, band->start, band->end);
+
+  g_mutex_lock (band->mutex);
+  if (--*band->pending == 0)
+    g_cond_signal (band->cond);
+  g_mutex_unlock (band->mutex);
+}
+
+static GThreadPool *
+ido_blur_get_pool (void)
+{
+  static GThreadPool *pool;
+
+  if (g_once_init_enter (&pool))
+    {
+      gint n_workers = CLAMP ((gint) g_get_num_processors () - 1, 1, IDO_BLUR_MAX_WORKERS);
+
+      g_once_init_leave (&pool, g_thread_pool_new (ido_blur_run_band, NULL, n_workers, FALSE, NULL));
+    }
+
+  return pool;
+}
+
+/*
+ * Splits one pass into a band per worker plus one for the calling
+ * thread, and returns once all of them are done. Column bands start on
+ * multiples of eight, so every vector tile stays whole.
+ */
+static void
+ido_blur_run_parallel (const IdoBlurPass *pass,
+                       gboolean           columns)
+{
+  IdoBlurBand bands[IDO_BLUR_MAX_WORKERS + 1];
+  GThreadPool *pool = ido_blur_get_pool ();
+  GMutex mutex;
+  GCond cond;
+  gint n_bands;
+  gint pending;
+  gint length;
+  gint i;
+
+  length = columns ? pass->width : pass->height;
+  n_bands = MIN (g_thread_pool_get_max_threads (pool) + 1, length);
+
+  g_mutex_init (&mutex);
+  g_cond_init (&cond);
+  pending = n_bands - 1;
+
+  for (i = 0; i < n_bands; i++)
+    {
+      bands[i].pass = pass;
+      bands[i].columns = columns;
+      bands[i].start = (gint64) length * i / n_bands;
+      bands[i].end = (gint64) length * (i + 1) / n_bands;
+      bands[i].mutex = &mutex;
+      bands[i].cond = &cond;
+      bands[i].pending = &pending;
+
+      if (columns)
+        {
+          bands[i].start &= ~7;
+          if (i < n_bands - 1)
+            bands[i].end &= ~7;
+        }
+    }
+
+  for (i = 1; i < n_bands; i++)
+    g_thread_pool_push (pool, &bands[i], NULL);
+
+  if (columns)
+    ido_blur_columns (pass, bands[0].start, bands[0].end);
+  else
+    ido_blur_rows (pass, bands[0].start, bands[0].end);
+
+  g_mutex_lock (&mutex);
+  while (pending > 0)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+
+  g_cond_clear (&cond);
+  g_mutex_clear (&mutex);
+}
+
+/**
+ * ido_blur_set_parallel_threshold: (skip)
+ * @n_pixels: the smallest image, in pixels, to blur on several threads
+ *
+ * Images below @n_pixels are blurred on the calling thread only, where
+ * handing the bands to the workers would cost more than it saves.
+ * %G_MAXUINT turns the parallel path off.
+ */
+void
+ido_blur_set_parallel_threshold (guint n_pixels)
+{
+  parallel_threshold = n_pixels;
+}
+
+/**
+ * ido_blur_exponential_with_impl: (skip)
+ * @impl: the implementation to use, which must be supported
+ * @pixels: the pixels, @width * @channels bytes per row
+ * @width: width in pixels
+ * @height: height in pixels
+ * @channels: bytes per pixel
+ * @radius: blur radius in pixels
+ * @aprec: precision of alpha, in bits
+ * @zprec: precision of the accumulators, in bits
+ *
+ * Like ido_blur_exponential(), with a given implementation. All of them
+ * produce the same pixels; the vector ones only handle four channels
+ * and fall back to the scalar one otherwise.
+ */
+void
+ido_blur_exponential_with_impl (IdoBlurImpl  impl,
+                                guchar      *pixels,
+                                gint         width,
+                                gint         height,
+                                gint         channels,
+                                gint         radius,
+                                gint         aprec,
+                                gint         zprec)
+{
+  IdoBlurPass pass;
+  gboolean parallel;
+
+  g_return_if_fail (ido_blur_impl_supported (impl));
+
+  if (radius < 1)
+    return;
+
+  if (impl == IDO_BLUR_IMPL_AUTO)
+    impl = ido_blur_get_best_impl ();
+
+  if (channels != 4)
+    impl = IDO_BLUR_IMPL_SCALAR;
+
+  pass.impl = impl;
+  pass.pixels = pixels;
+  pass.width = width;
+  pass.height = height;
+  pass.channels = channels;
+  pass.aprec = aprec;
+  pass.zprec = zprec;
+
+  // calculate the alpha such that 90% of
+  // the kernel is within the radius.
+  // (Kernel extends to infinity)
+  pass.alpha = (gint) ((1 << aprec) * (1.0f - expf (-2.3f / (radius + 1.f))));
+
+  parallel = (guint64) width * height >= parallel_threshold &&
+             g_get_num_processors () > 1;
+
+  if (parallel)
+    {
+      ido_blur_run_parallel (&pass, FALSE);
+      ido_blur_run_parallel (&pass, TRUE);
+    }
+  else
+    {
+      ido_blur_rows (&pass, 0, height);
+      ido_blur_columns (&pass, 0, width);
+    }
+}
+
+/**
+ * ido_blur_exponential: (skip)
+ * @pixels: the pixels, @width * @channels bytes per row
+ * @width: width in pixels
+ * @height: height in pixels
+ * @channels: bytes per pixel
+ * @radius: blur radius in pixels
+ * @aprec: precision of alpha, in bits
+ * @zprec: precision of the accumulators, in bits
+ *
+ * Blurs @pixels in place with the fastest implementation this machine
+ * supports.
+ */
+void
+ido_blur_exponential (guchar *pixels,
+                      gint    width,
+                      gint    height,
+                      gint    channels,
+                      gint    radius,
+                      gint    aprec,
+                      gint    zprec)
+{
+  ido_blur_exponential_with_impl (IDO_BLUR_IMPL_AUTO, pixels, width, height,
+                                  channels, radius, aprec, zprec);
+}
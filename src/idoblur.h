@@ -0,0 +1,60 @@
+/*
+ * Copyright 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *     Mirco Müller <mirco.mueller@canonical.com>
+ */
+
+#ifndef __IDO_BLUR_H__
+#define __IDO_BLUR_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define IDO_BLUR_PARALLEL_THRESHOLD_DEFAULT (256 * 256)
+
+typedef enum
+{
+  IDO_BLUR_IMPL_AUTO,
+  IDO_BLUR_IMPL_SCALAR,
+  IDO_BLUR_IMPL_SSE2,
+  IDO_BLUR_IMPL_AVX2
+} IdoBlurImpl;
+
+void        ido_blur_exponential            (guchar      *pixels,
+                                             gint         width,
+                                             gint         height,
+                                             gint         channels,
+                                             gint         radius,
+                                             gint         aprec,
+                                             gint         zprec);
+
+void        ido_blur_exponential_with_impl  (IdoBlurImpl  impl,
+                                             guchar      *pixels,
+                                             gint         width,
+                                             gint         height,
+                                             gint         channels,
+                                             gint         radius,
+                                             gint         aprec,
+                                             gint         zprec);
+
+gboolean    ido_blur_impl_supported         (IdoBlurImpl  impl);
+
+void        ido_blur_set_parallel_threshold (guint        n_pixels);
+
+G_END_DECLS
+
+#endif
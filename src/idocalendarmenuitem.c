@@ -662,49 +662,79 @@ on_action_state_changed (IdoActionHelper * helper,
     }
 }
 
-GtkMenuItem *
-ido_calendar_menu_item_new_from_model (GMenuItem    * menu_item,
-                                       GActionGroup * actions)
+/**
+ * ido_calendar_menu_item_update_from_model:
+ * @item: an #IdoCalendarMenuItem
+ * @menu_item: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menu_item's action
+ *
+ * Applies the selection and activation actions of @menu_item to an
+ * #IdoCalendarMenuItem built by
+ * ido_calendar_menu_item_new_from_model(). If @menu_item is %NULL, the
+ * item is left as blank as a new one, without an action binding.
+ */
+void
+ido_calendar_menu_item_update_from_model (GtkMenuItem  * item,
+                                          GMenuItem    * menu_item,
+                                          GActionGroup * actions)
 {
   GObject * o;
-  GtkWidget * calendar;
-  IdoCalendarMenuItem * ido_calendar;
+  IdoActionHelper * helper;
   gchar * selection_action_name = NULL;
   gchar * activation_action_name = NULL;
 
+  g_return_if_fail (IDO_IS_CALENDAR_MENU_ITEM (item));
+
+  o = G_OBJECT (item);
+
+  if (menu_item == NULL)
+    {
+      ido_action_helper_bind_widget (GTK_WIDGET (item), NULL, NULL, NULL);
+      g_object_set_data (o, "ido-action-group", NULL);
+      g_object_set_data (o, "ido-selection-action-name", NULL);
+      g_object_set_data (o, "ido-activation-action-name", NULL);
+      ido_calendar_menu_item_clear_marks (IDO_CALENDAR_MENU_ITEM (item));
+      return;
+    }
+
   /* get the select & activate action names */
   g_menu_item_get_attribute (menu_item, "action", "s", &selection_action_name);
   g_menu_item_get_attribute (menu_item, "activation-action", "s", &activation_action_name);
 
   /* remember the action group & action names so that we can poke them
      when user selects and double-clicks */
-  ido_calendar = IDO_CALENDAR_MENU_ITEM (ido_calendar_menu_item_new ());
-  o = G_OBJECT (ido_calendar);
-  g_object_set_data_full (o, "ido-action-group", g_object_ref(actions), g_object_unref);
+  if (g_object_get_data (o, "ido-action-group") != actions)
+    g_object_set_data_full (o, "ido-action-group", actions ? g_object_ref (actions) : NULL, g_object_unref);
   g_object_set_data_full (o, "ido-selection-action-name", selection_action_name, g_free);
   g_object_set_data_full (o, "ido-activation-action-name", activation_action_name, g_free);
+
+  /* Use an IdoActionHelper for state updates.
+     Since we have two separate actions for selection & activation,
+     we'll do the activation & targets logic here in ido-calendar */
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (item),
+                                          actions,
+                                          selection_action_name,
+                                          NULL);
+  if (helper)
+    g_signal_connect (helper, "action-state-changed",
+                      G_CALLBACK (on_action_state_changed), NULL);
+}
+
+GtkMenuItem *
+ido_calendar_menu_item_new_from_model (GMenuItem    * menu_item,
+                                       GActionGroup * actions)
+{
+  GtkWidget * calendar;
+  IdoCalendarMenuItem * ido_calendar;
+
+  ido_calendar = IDO_CALENDAR_MENU_ITEM (ido_calendar_menu_item_new ());
   calendar = ido_calendar_menu_item_get_calendar (ido_calendar);
   g_signal_connect_swapped (calendar, "day-selected",
                             G_CALLBACK(on_day_selected), ido_calendar);
   g_signal_connect_swapped (calendar, "day-selected-double-click",
                             G_CALLBACK(on_day_double_clicked), ido_calendar);
 
-  /* Use an IdoActionHelper for state updates.
-     Since we have two separate actions for selection & activation,
-     we'll do the activation & targets logic here in ido-calendar */
-  if (selection_action_name != NULL)
-    {
-      IdoActionHelper * helper;
-
-      helper = ido_action_helper_new (GTK_WIDGET(ido_calendar),
-                                      actions,
-                                      selection_action_name,
-                                      NULL);
-      g_signal_connect (helper, "action-state-changed",
-                        G_CALLBACK (on_action_state_changed), NULL);
-      g_signal_connect_swapped (ido_calendar, "destroy",
-                                G_CALLBACK (g_object_unref), helper);
-    }
+  ido_calendar_menu_item_update_from_model (GTK_MENU_ITEM (ido_calendar), menu_item, actions);
 
   return GTK_MENU_ITEM (ido_calendar);
 }
@@ -71,6 +71,10 @@ gboolean   ido_calendar_menu_item_set_date            (IdoCalendarMenuItem *menu
 GtkMenuItem * ido_calendar_menu_item_new_from_model   (GMenuItem    * menuitem,
                                                        GActionGroup * actions);
 
+void       ido_calendar_menu_item_update_from_model   (GtkMenuItem  * item,
+                                                       GMenuItem    * menuitem,
+                                                       GActionGroup * actions);
+
 
 G_END_DECLS
 
@@ -37,7 +37,6 @@ typedef struct
     GtkWidget *pLabel;
     GtkWidget *pImage;
     GtkWidget *pLevelBar;
-    IdoActionHelper *pHelper;
 
 } IdoLevelMenuItemPrivate;
 
@@ -182,7 +181,6 @@ static void ido_level_menu_item_class_init (IdoLevelMenuItemClass *klass)
 static void ido_level_menu_item_init (IdoLevelMenuItem *self)
 {
     IdoLevelMenuItemPrivate *pPrivate = ido_level_menu_item_get_instance_private (self);
-    pPrivate->pHelper = NULL;
     pPrivate->pImage = gtk_image_new();
     pPrivate->pLabel = gtk_label_new("");
     pPrivate->pLevelBar = gtk_level_bar_new_for_interval (0.0, 100.0);
@@ -211,7 +209,7 @@ void idoLevelMenuItemSetIcon (IdoLevelMenuItem *self, GIcon *pIcon)
 {
     IdoLevelMenuItemPrivate *pPrivate = ido_level_menu_item_get_instance_private (self);
 
-    if (pPrivate->pIcon != pIcon)
+    if (!g_icon_equal (pPrivate->pIcon, pIcon))
     {
         if (pPrivate->pIcon)
         {
@@ -240,55 +238,79 @@ void idoLevelMenuItemSetLevel (IdoLevelMenuItem *self, guint16 nLevel)
 {
     IdoLevelMenuItemPrivate *pPrivate = ido_level_menu_item_get_instance_private (self);
 
-    gtk_level_bar_set_value (GTK_LEVEL_BAR (pPrivate->pLevelBar), (gdouble)nLevel);
+    if (gtk_level_bar_get_value (GTK_LEVEL_BAR (pPrivate->pLevelBar)) != (gdouble)nLevel)
+    {
+        gtk_level_bar_set_value (GTK_LEVEL_BAR (pPrivate->pLevelBar), (gdouble)nLevel);
+    }
 }
 
-GtkMenuItem* ido_level_menu_item_new_from_model (GMenuItem *pMenuItem, GActionGroup *pActionGroup)
+/**
+ * ido_level_menu_item_update_from_model:
+ * @pItem: an #IdoLevelMenuItem
+ * @pMenuItem: (nullable): the #GMenuItem to apply
+ * @pActionGroup: (nullable): the #GActionGroup of @pMenuItem's action
+ *
+ * Applies the attributes and action of @pMenuItem to @pItem. If
+ * @pMenuItem is %NULL, the item is left as blank as a new one, without
+ * an action binding.
+ */
+void ido_level_menu_item_update_from_model (GtkMenuItem *pItem, GMenuItem *pMenuItem, GActionGroup *pActionGroup)
 {
-    GtkWidget *pItem = ido_level_menu_item_new ();
-    IdoLevelMenuItemPrivate *pPrivate = ido_level_menu_item_get_instance_private (IDO_LEVEL_MENU_ITEM (pItem));
-
-    gchar *sLabel;
+    g_return_if_fail (IDO_IS_LEVEL_MENU_ITEM (pItem));
 
-    if (g_menu_item_get_attribute (pMenuItem, "label", "s", &sLabel))
+    if (pMenuItem == NULL)
     {
-        idoLevelMenuItemSetText (IDO_LEVEL_MENU_ITEM (pItem), sLabel);
-        g_free (sLabel);
+        ido_action_helper_bind_widget (GTK_WIDGET (pItem), NULL, NULL, NULL);
+        idoLevelMenuItemSetText (IDO_LEVEL_MENU_ITEM (pItem), NULL);
+        idoLevelMenuItemSetIcon (IDO_LEVEL_MENU_ITEM (pItem), NULL);
+        idoLevelMenuItemSetLevel (IDO_LEVEL_MENU_ITEM (pItem), 0);
+
+        return;
     }
 
+    gchar *sLabel = NULL;
+    g_menu_item_get_attribute (pMenuItem, "label", "s", &sLabel);
+    idoLevelMenuItemSetText (IDO_LEVEL_MENU_ITEM (pItem), sLabel);
+    g_free (sLabel);
+
     GVariant *sIcon = g_menu_item_get_attribute_value (pMenuItem, "icon", NULL);
+    GIcon *pIcon = NULL;
 
     if (sIcon)
     {
-        GIcon *pIcon = g_icon_deserialize (sIcon);
-        idoLevelMenuItemSetIcon (IDO_LEVEL_MENU_ITEM (pItem), pIcon);
-        g_object_unref (pIcon);
+        pIcon = g_icon_deserialize (sIcon);
         g_variant_unref (sIcon);
     }
 
+    idoLevelMenuItemSetIcon (IDO_LEVEL_MENU_ITEM (pItem), pIcon);
+    g_clear_object (&pIcon);
+
     guint16 nProgress = 0;
+    g_menu_item_get_attribute (pMenuItem, "x-ayatana-level", "q", &nProgress);
+    idoLevelMenuItemSetLevel (IDO_LEVEL_MENU_ITEM (pItem), nProgress);
 
-    if (g_menu_item_get_attribute (pMenuItem, "x-ayatana-level", "q", &nProgress))
+    gchar *sAction = NULL;
+    g_menu_item_get_attribute (pMenuItem, "action", "s", &sAction);
+    GVariant *sTarget = g_menu_item_get_attribute_value (pMenuItem, "target", NULL);
+    IdoActionHelper *pHelper = ido_action_helper_bind_widget (GTK_WIDGET (pItem), pActionGroup, sAction, sTarget);
+
+    if (pHelper)
     {
-        idoLevelMenuItemSetLevel (IDO_LEVEL_MENU_ITEM (pItem), nProgress);
+        g_signal_connect_object (pItem, "activate", G_CALLBACK (onActivate), pHelper, 0);
     }
 
-    gchar *sAction;
-
-    if (g_menu_item_get_attribute (pMenuItem, "action", "s", &sAction))
+    if (sTarget)
     {
-        GVariant *sTarget = g_menu_item_get_attribute_value (pMenuItem, "target", NULL);
-        pPrivate->pHelper = ido_action_helper_new (pItem, pActionGroup, sAction, sTarget);
-        g_signal_connect_object (pItem, "activate", G_CALLBACK (onActivate), pPrivate->pHelper, 0);
-        g_signal_connect_swapped (pItem, "destroy", G_CALLBACK (g_object_unref), pPrivate->pHelper);
+        g_variant_unref (sTarget);
+    }
 
-        if (sTarget)
-        {
-            g_variant_unref (sTarget);
-        }
+    g_free (sAction);
+}
 
-        g_free (sAction);
-    }
+GtkMenuItem* ido_level_menu_item_new_from_model (GMenuItem *pMenuItem, GActionGroup *pActionGroup)
+{
+    GtkWidget *pItem = ido_level_menu_item_new ();
+    ido_level_menu_item_update_from_model (GTK_MENU_ITEM (pItem), pMenuItem, pActionGroup);
 
     return GTK_MENU_ITEM (pItem);
 }
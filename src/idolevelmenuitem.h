@@ -43,6 +43,7 @@ struct _IdoLevelMenuItem
 GType ido_level_menu_item_get_type (void) G_GNUC_CONST;
 GtkWidget* ido_level_menu_item_new ();
 GtkMenuItem* ido_level_menu_item_new_from_model (GMenuItem *pMenuItem, GActionGroup *pActionGroup);
+void ido_level_menu_item_update_from_model (GtkMenuItem *pItem, GMenuItem *pMenuItem, GActionGroup *pActionGroup);
 void idoLevelMenuItemSetIcon (IdoLevelMenuItem *self, GIcon *pIcon);
 void idoLevelMenuItemSetText (IdoLevelMenuItem *self, const char *sText);
 void idoLevelMenuItemSetLevel (IdoLevelMenuItem *self, guint16 nLevel);
@@ -275,92 +275,88 @@ ido_location_menu_item_set_timezone (IdoLocationMenuItem   * self,
 
   p = ido_location_menu_item_get_instance_private(self);
 
+  if (p->timezone && !g_strcmp0 (p->timezone, timezone))
+    return;
+
   g_free (p->timezone);
   p->timezone = g_strdup (timezone);
   update_timestamp (self);
 }
 
 /**
- * ido_location_menu_item_new_from_model:
- * @menu_item: the corresponding menuitem
- * @actions: action group to tell when this GtkMenuItem is activated
- *
- * Creates a new IdoLocationMenuItem with properties initialized from
- * the menuitem's attributes.
+ * ido_location_menu_item_update_from_model:
+ * @item: a menuitem built by ido_location_menu_item_new_from_model()
+ * @menu_item: (nullable): the corresponding menuitem
+ * @actions: (nullable): action group to tell when @item is activated
  *
- * If the menuitem's 'action' attribute is set, trigger that action
- * in @actions when this IdoLocationMenuItem is activated.
+ * Applies the attributes and action of @menu_item to @item, touching
+ * only what differs from the current values. If @menu_item is %NULL,
+ * the item is left as blank as a new one, without an action binding.
  */
-GtkMenuItem *
-ido_location_menu_item_new_from_model (GMenuItem    * menu_item,
-                                       GActionGroup * actions)
+void
+ido_location_menu_item_update_from_model (GtkMenuItem  * item,
+                                          GMenuItem    * menu_item,
+                                          GActionGroup * actions)
 {
-  guint i;
-  guint n;
-  gchar * str;
   IdoLocationMenuItem * ido_location;
-  const gchar * names[3];
-  GValue * values;
-  const guint n_max = 3;
+  gchar * str = NULL;
 
-  /* create the ido_location */
+  g_return_if_fail (IDO_IS_LOCATION_MENU_ITEM (item));
 
-  n = 0;
-  values = g_new0(GValue, n_max);
-
-  if (g_menu_item_get_attribute (menu_item, "label", "s", &str))
+  if (menu_item == NULL)
     {
-      names[n] = "text";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
+      /* like a new item: local time, no format and no timer */
+      stop_timestamp_timer (IDO_LOCATION_MENU_ITEM (item));
+      ido_basic_menu_item_clear (IDO_BASIC_MENU_ITEM (item));
+      ido_time_stamp_menu_item_set_format (IDO_TIME_STAMP_MENU_ITEM (item), NULL);
+      ido_location_menu_item_set_timezone (IDO_LOCATION_MENU_ITEM (item), NULL);
+      return;
     }
 
-  if (g_menu_item_get_attribute (menu_item, "x-ayatana-timezone", "s", &str))
-    {
-      names[n] = "timezone";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
-    }
+  ido_location = IDO_LOCATION_MENU_ITEM (item);
 
-  if (g_menu_item_get_attribute (menu_item, "x-ayatana-time-format", "s", &str))
-    {
-      names[n] = "format";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
-    }
+  g_menu_item_get_attribute (menu_item, "label", "s", &str);
+  ido_basic_menu_item_set_text (IDO_BASIC_MENU_ITEM (ido_location), str);
+  g_free (str);
 
-  g_assert (n <= G_N_ELEMENTS (names));
-  g_assert (n <= n_max);
-  ido_location = IDO_LOCATION_MENU_ITEM(g_object_new_with_properties (IDO_LOCATION_MENU_ITEM_TYPE, n, names, values));
+  /* a missing timezone or format is unset, like on a new item, so
+   * that the time isn't kept ticking in the previous entry's zone */
+  str = NULL;
+  g_menu_item_get_attribute (menu_item, "x-ayatana-timezone", "s", &str);
+  ido_location_menu_item_set_timezone (ido_location, str);
+  g_free (str);
 
-  for (i=0; i<n; i++)
-    g_value_unset (&values[i]);
+  str = NULL;
+  g_menu_item_get_attribute (menu_item, "x-ayatana-time-format", "s", &str);
 
-  g_free (values);
+  /* go through the property so that the timer is restarted */
+  if (g_strcmp0 (ido_time_stamp_menu_item_get_format (IDO_TIME_STAMP_MENU_ITEM (ido_location)), str))
+    g_object_set (ido_location, "format", str, NULL);
 
-  /* give it an ActionHelper */
+  g_free (str);
 
-  if (g_menu_item_get_attribute (menu_item, "action", "s", &str))
-    {
-      GVariant * target;
-      IdoActionHelper * helper;
-
-      target = g_menu_item_get_attribute_value (menu_item, "target",
-                                                G_VARIANT_TYPE_ANY);
-      helper = ido_action_helper_new (GTK_WIDGET(ido_location), actions,
-                                      str, target);
-      g_signal_connect_swapped (ido_location, "activate",
-                                G_CALLBACK (ido_action_helper_activate), helper);
-      g_signal_connect_swapped (ido_location, "destroy",
-                                G_CALLBACK (g_object_unref), helper);
-
-      if (target)
-        g_variant_unref (target);
-      g_free (str);
-    }
+  ido_basic_menu_item_bind_action (IDO_BASIC_MENU_ITEM (ido_location), menu_item, actions);
+}
+
+/**
+ * ido_location_menu_item_new_from_model:
+ * @menu_item: the corresponding menuitem
+ * @actions: action group to tell when this GtkMenuItem is activated
+ *
+ * Creates a new IdoLocationMenuItem with properties initialized from
+ * the menuitem's attributes.
+ *
+ * If the menuitem's 'action' attribute is set, trigger that action
+ * in @actions when this IdoLocationMenuItem is activated.
+ */
+GtkMenuItem *
+ido_location_menu_item_new_from_model (GMenuItem    * menu_item,
+                                       GActionGroup * actions)
+{
+  GtkWidget * ido_location;
+
+  ido_location = ido_location_menu_item_new ();
+  ido_location_menu_item_update_from_model (GTK_MENU_ITEM (ido_location), menu_item, actions);
 
   return GTK_MENU_ITEM (ido_location);
 }
@@ -57,6 +57,10 @@ GtkWidget * ido_location_menu_item_new (void);
 GtkMenuItem * ido_location_menu_item_new_from_model (GMenuItem    * menuitem,
                                                      GActionGroup * actions);
 
+void ido_location_menu_item_update_from_model (GtkMenuItem  * menuitem,
+                                               GMenuItem    * model_item,
+                                               GActionGroup * actions);
+
 void ido_location_menu_item_set_timezone (IdoLocationMenuItem * menuitem,
                                           const char          * timezone);
 
@@ -23,8 +23,7 @@
 
 #include "idomediaplayermenuitem.h"
 #include "idoactionhelper.h"
-
-#define ALBUM_ART_SIZE 60
+#include "idoalbumart.h"
 
 typedef GtkMenuItemClass IdoMediaPlayerMenuItemClass;
 
@@ -40,12 +39,30 @@ struct _IdoMediaPlayerMenuItem
   GtkWidget* artist_label;
   GtkWidget* piece_label;
   GtkWidget* container_label;
+  GtkWidget* progress_bar;
 
+  gchar *art_url;
+  GBytes *art_bytes;
+  gint art_width;
+  gint art_height;
+  gint art_scale;
   gboolean running;
+
+  gint64 position;
+  gint64 position_time;
+  gint64 duration;
+  gdouble rate;
+  guint progress_tick_id;
+  gint progress_pixel;
 };
 
+
 G_DEFINE_TYPE (IdoMediaPlayerMenuItem, ido_media_player_menu_item, GTK_TYPE_MENU_ITEM);
 
+static void ido_media_player_menu_item_scale_changed (GObject    *object,
+                                                      GParamSpec *pspec,
+                                                      gpointer    user_data);
+
 static void
 ido_media_player_menu_item_dispose (GObject *object)
 {
@@ -57,9 +74,27 @@ ido_media_player_menu_item_dispose (GObject *object)
       g_clear_object (&self->cancellable);
     }
 
+  if (self->progress_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->progress_tick_id);
+      self->progress_tick_id = 0;
+    }
+
   G_OBJECT_CLASS (ido_media_player_menu_item_parent_class)->dispose (object);
 }
 
+static void
+ido_media_player_menu_item_finalize (GObject *object)
+{
+  IdoMediaPlayerMenuItem *self = IDO_MEDIA_PLAYER_MENU_ITEM (object);
+
+  g_free (self->art_url);
+  if (self->art_bytes)
+    g_bytes_unref (self->art_bytes);
+
+  G_OBJECT_CLASS (ido_media_player_menu_item_parent_class)->finalize (object);
+}
+
 static gboolean
 ido_media_player_menu_item_draw (GtkWidget *widget,
                                  cairo_t   *cr)
@@ -108,6 +143,7 @@ ido_media_player_menu_item_class_init (IdoMediaPlayerMenuItemClass *klass)
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
   object_class->dispose = ido_media_player_menu_item_dispose;
+  object_class->finalize = ido_media_player_menu_item_finalize;
 
   widget_class->draw = ido_media_player_menu_item_draw;
 }
@@ -143,7 +179,7 @@ ido_media_player_menu_item_init (IdoMediaPlayerMenuItem *self)
   gtk_widget_set_hexpand (self->player_label, TRUE);
 
   self->album_art = gtk_image_new();
-  gtk_widget_set_size_request (self->album_art, ALBUM_ART_SIZE, ALBUM_ART_SIZE);
+  gtk_widget_set_size_request (self->album_art, IDO_ALBUM_ART_SIZE, IDO_ALBUM_ART_SIZE);
     gtk_widget_set_margin_end(self->album_art, 8);
 
   self->artist_label = track_info_label_new ();
@@ -159,6 +195,11 @@ ido_media_player_menu_item_init (IdoMediaPlayerMenuItem *self)
   gtk_grid_attach (GTK_GRID (self->metadata_widget), self->artist_label, 1, 1, 1, 1);
   gtk_grid_attach (GTK_GRID (self->metadata_widget), self->container_label, 1, 2, 1, 1);
 
+  self->progress_bar = gtk_progress_bar_new ();
+  gtk_widget_set_valign (self->progress_bar, GTK_ALIGN_END);
+  gtk_widget_set_no_show_all (self->progress_bar, TRUE);
+  gtk_grid_attach (GTK_GRID (self->metadata_widget), self->progress_bar, 1, 3, 1, 1);
+
   grid = gtk_grid_new ();
   gtk_grid_set_row_spacing (GTK_GRID (grid), 8);
   gtk_grid_attach (GTK_GRID (grid), self->player_icon, 0, 0, 1, 1);
@@ -170,6 +211,9 @@ ido_media_player_menu_item_init (IdoMediaPlayerMenuItem *self)
 
   /* hide metadata by defalut (player is not running) */
   gtk_widget_hide (self->metadata_widget);
+
+  g_signal_connect (self, "notify::scale-factor",
+                    G_CALLBACK (ido_media_player_menu_item_scale_changed), NULL);
 }
 
 static void
@@ -178,16 +222,23 @@ ido_media_player_menu_item_set_player_name (IdoMediaPlayerMenuItem *self,
 {
   g_return_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (self));
 
-  gtk_label_set_label (GTK_LABEL (self->player_label), name);
+  if (g_strcmp0 (gtk_label_get_label (GTK_LABEL (self->player_label)), name))
+    gtk_label_set_label (GTK_LABEL (self->player_label), name);
 }
 
 static void
 ido_media_player_menu_item_set_player_icon (IdoMediaPlayerMenuItem *self,
                                             GIcon                  *icon)
 {
+  GIcon *current = NULL;
+
   g_return_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (self));
 
-  gtk_image_set_from_gicon (GTK_IMAGE (self->player_icon), icon, GTK_ICON_SIZE_MENU);
+  if (gtk_image_get_storage_type (GTK_IMAGE (self->player_icon)) == GTK_IMAGE_GICON)
+    gtk_image_get_gicon (GTK_IMAGE (self->player_icon), &current, NULL);
+
+  if (current == NULL || !g_icon_equal (current, icon))
+    gtk_image_set_from_gicon (GTK_IMAGE (self->player_icon), icon, GTK_ICON_SIZE_MENU);
 }
 
 static void
@@ -209,67 +260,251 @@ album_art_received (GObject      *object,
                     gpointer      user_data)
 {
   IdoMediaPlayerMenuItem *self = user_data;
-  GdkPixbuf *pixbuf;
+  cairo_surface_t *surface;
   GError *error = NULL;
 
-  pixbuf = gdk_pixbuf_new_from_stream_finish (result, &error);
-  if (pixbuf == NULL)
+  surface = ido_album_art_load_finish (result, &error);
+  if (surface == NULL)
     {
+      /* a cancelled load may belong to a finalized item */
       if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        g_warning ("unable to fetch album art: %s", error->message);
+        {
+          g_warning ("unable to fetch album art: %s", error->message);
+
+          /* lets the next state with the same URL try again */
+          g_clear_pointer (&self->art_url, g_free);
+        }
 
       g_error_free (error);
       return;
     }
 
-  gtk_image_set_from_pixbuf (GTK_IMAGE (self->album_art), pixbuf);
-  g_object_unref (pixbuf);
+  gtk_image_set_from_surface (GTK_IMAGE (self->album_art), surface);
+  cairo_surface_destroy (surface);
 }
 
 static void
-album_art_file_opened (GObject      *object,
-                       GAsyncResult *result,
-                       gpointer      user_data)
+ido_media_player_menu_item_set_album_art (IdoMediaPlayerMenuItem *self,
+                                          const gchar            *url)
 {
-  IdoMediaPlayerMenuItem *self = user_data;
-  GFileInputStream *input;
+  cairo_surface_t *surface;
+  gint scale;
+
+  g_return_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (self));
+
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+  /* metadata updates mostly keep the art, which is already shown or
+   * still loading */
+  if (g_strcmp0 (self->art_url, url) == 0 && self->art_scale == scale && self->art_bytes == NULL)
+    return;
+
+  if (self->art_bytes)
+    {
+      g_bytes_unref (self->art_bytes);
+      self->art_bytes = NULL;
+    }
+
+  if (g_strcmp0 (self->art_url, url) != 0)
+    {
+      g_free (self->art_url);
+      self->art_url = g_strdup (url);
+    }
+
+  self->art_scale = scale;
+
+  /* the art of the previous URL would arrive too late; its load goes
+   * on for the cache and for other items waiting for it */
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+  self->cancellable = g_cancellable_new ();
+
+  if (url == NULL)
+    {
+      gtk_image_clear (GTK_IMAGE (self->album_art));
+      return;
+    }
+
+  surface = ido_album_art_cache_lookup (url, scale);
+  if (surface)
+    {
+      gtk_image_set_from_surface (GTK_IMAGE (self->album_art), surface);
+      cairo_surface_destroy (surface);
+      return;
+    }
+
+  gtk_image_clear (GTK_IMAGE (self->album_art));
+
+  /* other items showing the same art share one load */
+  ido_album_art_load_async (url, scale, self->cancellable, album_art_received, self);
+}
+
+static void
+ido_media_player_menu_item_set_album_art_bytes (IdoMediaPlayerMenuItem *self,
+                                                GBytes                 *bytes,
+                                                gint                    width,
+                                                gint                    height)
+{
+  cairo_surface_t *surface;
   GError *error = NULL;
+  gint scale;
 
-  input = g_file_read_finish (G_FILE (object), result, &error);
-  if (input == NULL)
+  g_return_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (self));
+
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+  /* the state is sent again for every change, mostly with the same
+   * thumbnail; raw pixels don't depend on the scale */
+  if (self->art_bytes && g_bytes_equal (self->art_bytes, bytes) &&
+      self->art_width == width && self->art_height == height &&
+      (self->art_scale == scale || width > 0))
+    return;
+
+  /* drops the art of a URL, loaded or still loading */
+  g_clear_pointer (&self->art_url, g_free);
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+  self->cancellable = g_cancellable_new ();
+
+  if (self->art_bytes != bytes)
     {
-      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        g_warning ("unable to fetch album art: %s", error->message);
+      if (self->art_bytes)
+        g_bytes_unref (self->art_bytes);
+      self->art_bytes = g_bytes_ref (bytes);
+    }
 
+  self->art_width = width;
+  self->art_height = height;
+  self->art_scale = scale;
+
+  surface = ido_album_art_new_from_bytes (bytes, width, height, scale, &error);
+  if (surface == NULL)
+    {
+      g_warning ("unable to read album art: %s", error->message);
       g_error_free (error);
+      gtk_image_clear (GTK_IMAGE (self->album_art));
       return;
     }
 
-  gdk_pixbuf_new_from_stream_at_scale_async (G_INPUT_STREAM (input),
-                                             ALBUM_ART_SIZE, ALBUM_ART_SIZE, TRUE,
-                                             self->cancellable,
-                                             album_art_received, self);
-
-  g_object_unref (input);
+  gtk_image_set_from_surface (GTK_IMAGE (self->album_art), surface);
+  cairo_surface_destroy (surface);
 }
 
 static void
-ido_media_player_menu_item_set_album_art (IdoMediaPlayerMenuItem *self,
-                                          const gchar            *url)
+ido_media_player_menu_item_scale_changed (GObject    *object,
+                                          GParamSpec *pspec,
+                                          gpointer    user_data)
 {
-  GFile *file;
+  IdoMediaPlayerMenuItem *self = IDO_MEDIA_PLAYER_MENU_ITEM (object);
+
+  /* the art is decoded for one scale only */
+  if (self->art_bytes)
+    ido_media_player_menu_item_set_album_art_bytes (self, self->art_bytes,
+                                                    self->art_width, self->art_height);
+  else if (self->art_url)
+    ido_media_player_menu_item_set_album_art (self, self->art_url);
+}
 
+/* Returns whether the position still moves after @time */
+static gboolean
+ido_media_player_menu_item_update_progress (IdoMediaPlayerMenuItem *self,
+                                            gint64                  time)
+{
+  gint64 position;
+  gdouble fraction;
+  gint pixel;
+
+  position = ido_media_player_menu_item_get_position (self, time);
+  fraction = (gdouble) position / self->duration;
+
+  /* the bar only looks different once its end moves to another pixel,
+   * which is seconds apart for most tracks */
+  pixel = fraction * gtk_widget_get_allocated_width (self->progress_bar) *
+                     gtk_widget_get_scale_factor (self->progress_bar);
+  if (pixel != self->progress_pixel)
+    {
+      self->progress_pixel = pixel;
+      gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (self->progress_bar), fraction);
+    }
+
+  if (self->rate > 0)
+    return position < self->duration;
+  else if (self->rate < 0)
+    return position > 0;
+  else
+    return FALSE;
+}
+
+static gboolean
+ido_media_player_menu_item_progress_tick (GtkWidget     *widget,
+                                          GdkFrameClock *frame_clock,
+                                          gpointer       user_data)
+{
+  IdoMediaPlayerMenuItem *self = IDO_MEDIA_PLAYER_MENU_ITEM (widget);
+
+  if (ido_media_player_menu_item_update_progress (self, gdk_frame_clock_get_frame_time (frame_clock)))
+    return G_SOURCE_CONTINUE;
+
+  self->progress_tick_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ido_media_player_menu_item_set_progress (IdoMediaPlayerMenuItem *self,
+                                         gint64                  position,
+                                         gint64                  position_time,
+                                         gint64                  duration,
+                                         gdouble                 rate)
+{
   g_return_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (self));
 
-  gtk_image_clear (GTK_IMAGE (self->album_art));
+  /* the state is sent again for every change; the position only needs
+   * to be taken over after a seek or a change of rate, in between it is
+   * extrapolated on the frame clock. Without a time, a position is as of
+   * when it arrives, so sending the same one again is no seek */
+  if (position_time == 0)
+    {
+      if (position == self->position && duration == self->duration && rate == self->rate)
+        return;
 
-  if (url == NULL)
+      position_time = g_get_monotonic_time ();
+    }
+  else if (position == self->position && position_time == self->position_time &&
+           duration == self->duration && rate == self->rate)
     return;
 
-  file = g_file_new_for_uri (url);
-  g_file_read_async (file, G_PRIORITY_DEFAULT, self->cancellable, album_art_file_opened, self);
+  self->position = position;
+  self->position_time = position_time;
+  self->duration = duration;
+  self->rate = rate;
+  self->progress_pixel = -1;
+
+  if (duration <= 0)
+    {
+      if (self->progress_tick_id)
+        {
+          gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->progress_tick_id);
+          self->progress_tick_id = 0;
+        }
+
+      gtk_widget_hide (self->progress_bar);
+      return;
+    }
+
+  gtk_widget_show (self->progress_bar);
 
-  g_object_unref (file);
+  if (ido_media_player_menu_item_update_progress (self, g_get_monotonic_time ()))
+    {
+      if (self->progress_tick_id == 0)
+        self->progress_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                               ido_media_player_menu_item_progress_tick,
+                                                               NULL, NULL);
+    }
+  else if (self->progress_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->progress_tick_id);
+      self->progress_tick_id = 0;
+    }
 }
 
 static void
@@ -293,7 +528,10 @@ ido_media_player_menu_item_set_metadata (IdoMediaPlayerMenuItem *self,
                                          const gchar            *title,
                                          const gchar            *artist,
                                          const gchar            *album,
-                                         const gchar            *art_url)
+                                         const gchar            *art_url,
+                                         GBytes                 *art_bytes,
+                                         gint                    art_width,
+                                         gint                    art_height)
 {
   g_return_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (self));
 
@@ -311,7 +549,10 @@ ido_media_player_menu_item_set_metadata (IdoMediaPlayerMenuItem *self,
       gtk_label_set_markup_printf_escaped (GTK_LABEL (self->piece_label), "<small>%s</small>", title);
       gtk_label_set_markup_printf_escaped (GTK_LABEL (self->artist_label), "<small>%s</small>", artist);
       gtk_label_set_markup_printf_escaped (GTK_LABEL (self->container_label), "<small>%s</small>", album);
-      ido_media_player_menu_item_set_album_art (self, art_url);
+      if (art_bytes && g_bytes_get_size (art_bytes) > 0)
+        ido_media_player_menu_item_set_album_art_bytes (self, art_bytes, art_width, art_height);
+      else
+        ido_media_player_menu_item_set_album_art (self, art_url);
       gtk_widget_show (self->metadata_widget);
     }
 }
@@ -327,6 +568,14 @@ ido_media_player_menu_item_state_changed (IdoActionHelper *helper,
   const gchar *artist = NULL;
   const gchar *album = NULL;
   const gchar *art_url = NULL;
+  GVariant *art_data = NULL;
+  GBytes *art_bytes = NULL;
+  gint art_width = 0;
+  gint art_height = 0;
+  gint64 position = 0;
+  gint64 position_time = 0;
+  gint64 duration = 0;
+  gdouble rate = 0.0;
 
   g_variant_lookup (state, "running", "b", &running);
   g_variant_lookup (state, "title", "&s", &title);
@@ -334,25 +583,81 @@ ido_media_player_menu_item_state_changed (IdoActionHelper *helper,
   g_variant_lookup (state, "album", "&s", &album);
   g_variant_lookup (state, "art-url", "&s", &art_url);
 
+  /* a thumbnail sent along with the metadata is shown instead of the
+   * art at art-url; "art-width" and "art-height" are only set when it
+   * is raw RGBA instead of an encoded image */
+  if (g_variant_lookup (state, "art-bytes", "@ay", &art_data))
+    {
+      /* refers to the data of the state, no copy */
+      art_bytes = g_variant_get_data_as_bytes (art_data);
+      g_variant_lookup (state, "art-width", "i", &art_width);
+      g_variant_lookup (state, "art-height", "i", &art_height);
+    }
+
+  /* all times in microseconds; "position-time" is the monotonic time
+   * the position was taken at, and "rate" is 0 while paused */
+  g_variant_lookup (state, "position", "x", &position);
+  g_variant_lookup (state, "position-time", "x", &position_time);
+  g_variant_lookup (state, "duration", "x", &duration);
+  g_variant_lookup (state, "rate", "d", &rate);
+
+  /* the progress is shown along with the metadata only */
+  if (title == NULL || *title == '\0')
+    duration = 0;
+
   widget = IDO_MEDIA_PLAYER_MENU_ITEM (ido_action_helper_get_widget (helper));
   ido_media_player_menu_item_set_is_running (widget, running);
-  ido_media_player_menu_item_set_metadata (widget, title, artist, album, art_url);
+  ido_media_player_menu_item_set_metadata (widget, title, artist, album, art_url,
+                                           art_bytes, art_width, art_height);
+  ido_media_player_menu_item_set_progress (widget, position, position_time, duration, rate);
+
+  if (art_bytes)
+    g_bytes_unref (art_bytes);
+  if (art_data)
+    g_variant_unref (art_data);
 }
 
-GtkMenuItem *
-ido_media_player_menu_item_new_from_model (GMenuItem    *menuitem,
-                                           GActionGroup *actions)
+/**
+ * ido_media_player_menu_item_update_from_model:
+ * @item: an #IdoMediaPlayerMenuItem
+ * @menuitem: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menuitem's action
+ *
+ * Applies the label, icon and action of @menuitem to an
+ * #IdoMediaPlayerMenuItem. If @menuitem is %NULL, the item is left as
+ * blank as a new one, without an action binding.
+ */
+void
+ido_media_player_menu_item_update_from_model (GtkMenuItem  *item,
+                                              GMenuItem    *menuitem,
+                                              GActionGroup *actions)
 {
-  GtkMenuItem *widget;
+  IdoMediaPlayerMenuItem *self;
+  IdoActionHelper *helper;
   gchar *label;
-  gchar *action;
+  gchar *action = NULL;
   GVariant *v;
 
-  widget = g_object_new (IDO_TYPE_MEDIA_PLAYER_MENU_ITEM, NULL);
+  g_return_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (item));
+
+  self = IDO_MEDIA_PLAYER_MENU_ITEM (item);
+
+  if (menuitem == NULL)
+    {
+      /* the next player shows nothing of this one until its state
+       * arrives, and no art load or progress tick is left running */
+      ido_action_helper_bind_widget (GTK_WIDGET (item), NULL, NULL, NULL);
+      ido_media_player_menu_item_set_player_name (self, NULL);
+      gtk_image_clear (GTK_IMAGE (self->player_icon));
+      ido_media_player_menu_item_set_is_running (self, FALSE);
+      ido_media_player_menu_item_set_metadata (self, NULL, NULL, NULL, NULL, NULL, 0, 0);
+      ido_media_player_menu_item_set_progress (self, 0, 0, 0, 0.0);
+      return;
+    }
 
   if (g_menu_item_get_attribute (menuitem, "label", "s", &label))
     {
-      ido_media_player_menu_item_set_player_name (IDO_MEDIA_PLAYER_MENU_ITEM (widget), label);
+      ido_media_player_menu_item_set_player_name (self, label);
       g_free (label);
     }
 
@@ -363,29 +668,60 @@ ido_media_player_menu_item_new_from_model (GMenuItem    *menuitem,
       icon = g_icon_deserialize (v);
       if (icon)
         {
-          ido_media_player_menu_item_set_player_icon (IDO_MEDIA_PLAYER_MENU_ITEM (widget), icon);
+          ido_media_player_menu_item_set_player_icon (self, icon);
           g_object_unref (icon);
         }
 
       g_variant_unref (v);
     }
 
-  if (g_menu_item_get_attribute (menuitem, "action", "s", &action))
-    {
-      IdoActionHelper *helper;
+  g_menu_item_get_attribute (menuitem, "action", "s", &action);
 
-      helper = ido_action_helper_new (GTK_WIDGET (widget), actions, action, NULL);
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (item), actions, action, NULL);
+  if (helper)
+    {
       g_signal_connect (helper, "action-state-changed",
                         G_CALLBACK (ido_media_player_menu_item_state_changed), NULL);
 
-      g_signal_connect_object (widget, "activate",
+      g_signal_connect_object (item, "activate",
                                G_CALLBACK (ido_action_helper_activate),
                                helper, G_CONNECT_SWAPPED);
+    }
 
-      g_signal_connect_swapped (widget, "destroy", G_CALLBACK (g_object_unref), helper);
+  g_free (action);
+}
 
-      g_free (action);
-    }
+GtkMenuItem *
+ido_media_player_menu_item_new_from_model (GMenuItem    *menuitem,
+                                           GActionGroup *actions)
+{
+  GtkMenuItem *widget;
+
+  widget = g_object_new (IDO_TYPE_MEDIA_PLAYER_MENU_ITEM, NULL);
+  ido_media_player_menu_item_update_from_model (widget, menuitem, actions);
 
   return widget;
 }
+
+/**
+ * ido_media_player_menu_item_get_position:
+ * @self: a #IdoMediaPlayerMenuItem
+ * @time: a time from g_get_monotonic_time(), in microseconds
+ *
+ * Extrapolates the playback position at @time from the position, rate
+ * and duration last received with the state of the item.
+ *
+ * Returns: the playback position, in microseconds
+ */
+gint64
+ido_media_player_menu_item_get_position (IdoMediaPlayerMenuItem *self,
+                                         gint64                  time)
+{
+  gint64 position;
+
+  g_return_val_if_fail (IDO_IS_MEDIA_PLAYER_MENU_ITEM (self), 0);
+
+  position = self->position + (gint64) ((time - self->position_time) * self->rate);
+
+  return CLAMP (position, 0, self->duration > 0 ? self->duration : G_MAXINT64);
+}
@@ -37,6 +37,13 @@ GType                   ido_media_player_menu_item_get_type             (void);
 GtkMenuItem *           ido_media_player_menu_item_new_from_model       (GMenuItem    *menuitem,
                                                                          GActionGroup *actions);
 
+void                    ido_media_player_menu_item_update_from_model    (GtkMenuItem  *item,
+                                                                         GMenuItem    *menuitem,
+                                                                         GActionGroup *actions);
+
+gint64                  ido_media_player_menu_item_get_position         (IdoMediaPlayerMenuItem *self,
+                                                                         gint64                  time);
+
 G_END_DECLS
 
 #endif
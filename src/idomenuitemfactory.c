@@ -21,6 +21,7 @@
 
 #include <gtk/gtk.h>
 #include "ayatanamenuitemfactory.h"
+#include "idomenuitemfactory.h"
 #include "idoalarmmenuitem.h"
 #include "idoappointmentmenuitem.h"
 #include "idobasicmenuitem.h"
@@ -52,61 +53,315 @@ G_DEFINE_TYPE_WITH_CODE (IdoMenuItemFactory, ido_menu_item_factory, G_TYPE_OBJEC
   g_io_extension_point_implement (AYATANA_MENU_ITEM_FACTORY_EXTENSION_POINT_NAME,
                                   g_define_type_id, "ido", 0);)
 
-static GtkMenuItem *
-ido_menu_item_factory_create_menu_item (AyatanaMenuItemFactory *factory,
-                                        const gchar           *type,
-                                        GMenuItem             *menuitem,
-                                        GActionGroup          *actions)
+/* released items kept per type for reuse by create_menu_item() */
+#define MAX_POOLED_ITEMS 32
+
+typedef struct
+{
+  IdoMenuItemConstructor constructor;
+  IdoMenuItemUpdater updater;
+  GQueue pool;
+  guint generation;
+} IdoMenuItemType;
+
+/* maps the quark of an "x-ayatana-type" string to its IdoMenuItemType */
+static GHashTable *types = NULL;
+
+/* tells registrations of the same type apart */
+static guint last_generation = 0;
+
+static GQuark
+ido_menu_item_factory_type_quark (void)
+{
+  static GQuark quark;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("ido-menu-item-factory-type");
+
+  return quark;
+}
+
+static GQuark
+ido_menu_item_factory_generation_quark (void)
+{
+  static GQuark quark;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("ido-menu-item-factory-generation");
+
+  return quark;
+}
+
+static void
+ido_menu_item_type_free (gpointer data)
 {
-  GtkMenuItem *item = NULL;
+  IdoMenuItemType *type = data;
+  GtkWidget *item;
 
-  if (g_str_equal (type, "org.ayatana.indicator.user-menu-item"))
-    item = ido_user_menu_item_new_from_model (menuitem, actions);
+  while ((item = g_queue_pop_head (&type->pool)))
+    {
+      gtk_widget_destroy (item);
+      g_object_unref (item);
+    }
 
-  if (g_str_equal (type, "org.ayatana.indicator.guest-menu-item"))
-    item = ido_guest_menu_item_new_from_model (menuitem, actions);
+  g_slice_free (IdoMenuItemType, type);
+}
+
+static GHashTable *
+ido_menu_item_factory_get_types (void)
+{
+  if (types == NULL)
+    {
+      types = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, ido_menu_item_type_free);
 
-  else if (g_str_equal (type, "org.ayatana.indicator.calendar"))
-    item = ido_calendar_menu_item_new_from_model (menuitem, actions);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.user-menu-item", ido_user_menu_item_new_from_model, ido_user_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.guest-menu-item", ido_guest_menu_item_new_from_model, ido_guest_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.calendar", ido_calendar_menu_item_new_from_model, ido_calendar_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.location", ido_location_menu_item_new_from_model, ido_location_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.appointment", ido_appointment_menu_item_new_from_model, ido_appointment_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.alarm", ido_alarm_menu_item_new_from_model, ido_alarm_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.basic", ido_basic_menu_item_new_from_model, ido_basic_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.progress", ido_progress_menu_item_new_from_model, ido_progress_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.slider", ido_scale_menu_item_new_from_model, ido_scale_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.media-player", ido_media_player_menu_item_new_from_model, ido_media_player_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.playback-item", ido_playback_menu_item_new_from_model, ido_playback_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.application", ido_application_menu_item_new_from_model, ido_application_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.messages.source", ido_source_menu_item_new_from_menu_model, ido_source_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.switch", ido_switch_menu_item_new_from_menu_model, ido_switch_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.removable", ido_removable_menu_item_new_from_model, ido_removable_menu_item_update_from_model);
+      ido_menu_item_factory_register_type_full ("org.ayatana.indicator.level", ido_level_menu_item_new_from_model, ido_level_menu_item_update_from_model);
+    }
 
-  else if (g_str_equal (type, "org.ayatana.indicator.location"))
-    item = ido_location_menu_item_new_from_model (menuitem, actions);
+  return types;
+}
 
-  else if (g_str_equal (type, "org.ayatana.indicator.appointment"))
-    item = ido_appointment_menu_item_new_from_model (menuitem, actions);
+static IdoMenuItemType *
+ido_menu_item_factory_lookup (const gchar *type)
+{
+  GHashTable *table;
+  GQuark quark;
 
-  else if (g_str_equal (type, "org.ayatana.indicator.alarm"))
-    item = ido_alarm_menu_item_new_from_model (menuitem, actions);
+  table = ido_menu_item_factory_get_types ();
 
-  else if (g_str_equal (type, "org.ayatana.indicator.basic"))
-    item = ido_basic_menu_item_new_from_model (menuitem, actions);
+  /* types that were never registered don't have a quark yet */
+  quark = g_quark_try_string (type);
+  if (quark == 0)
+    return NULL;
 
-  else if (g_str_equal (type, "org.ayatana.indicator.progress"))
-    item = ido_progress_menu_item_new_from_model (menuitem, actions);
+  return g_hash_table_lookup (table, GUINT_TO_POINTER (quark));
+}
 
-  else if (g_str_equal (type, "org.ayatana.indicator.slider"))
-    item = ido_scale_menu_item_new_from_model (menuitem, actions);
+/* Returns the registration @item was built by, or %NULL if its type
+ * was registered again since, as the new updater may not know how to
+ * handle items of the old constructor */
+static IdoMenuItemType *
+ido_menu_item_factory_lookup_item (GtkMenuItem *item)
+{
+  IdoMenuItemType *entry;
+  GQuark quark;
+
+  quark = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (item), ido_menu_item_factory_type_quark ()));
+  if (quark == 0)
+    return NULL;
+
+  entry = g_hash_table_lookup (ido_menu_item_factory_get_types (), GUINT_TO_POINTER (quark));
+  if (entry == NULL ||
+      entry->generation != GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (item), ido_menu_item_factory_generation_quark ())))
+    return NULL;
+
+  return entry;
+}
 
-  else if (g_str_equal (type, "org.ayatana.indicator.media-player"))
-    item = ido_media_player_menu_item_new_from_model (menuitem, actions);
+/**
+ * ido_menu_item_factory_register_type:
+ * @type: the "x-ayatana-type" of the menu items to build
+ * @constructor: (scope forever): the function building those items
+ *
+ * Makes the ido menu item factory build menu items of type @type with
+ * @constructor. Registering a type that is already known replaces its
+ * previous constructor, which allows overriding the builtin items.
+ *
+ * Passing %NULL for @constructor unregisters @type.
+ */
+void
+ido_menu_item_factory_register_type (const gchar            *type,
+                                     IdoMenuItemConstructor  constructor)
+{
+  ido_menu_item_factory_register_type_full (type, constructor, NULL);
+}
+
+/**
+ * ido_menu_item_factory_register_type_full:
+ * @type: the "x-ayatana-type" of the menu items to build
+ * @constructor: (scope forever): the function building those items
+ * @updater: (scope forever) (nullable): the function rebinding a
+ *   released item to a new menu model entry
+ *
+ * Like ido_menu_item_factory_register_type(), but also allows items of
+ * @type that were handed back with ido_menu_item_factory_release_menu_item()
+ * to be recycled. @updater is called with a %NULL menu item when an
+ * item is released, and must then reset everything the model set on the
+ * item, action binding included, so that it is as blank as a new one.
+ *
+ * Items built before @type is registered again are never passed to
+ * @updater: they are destroyed when released and have to be rebuilt on
+ * changes.
+ */
+void
+ido_menu_item_factory_register_type_full (const gchar            *type,
+                                          IdoMenuItemConstructor  constructor,
+                                          IdoMenuItemUpdater      updater)
+{
+  GHashTable *table;
+  GQuark quark;
 
-  else if (g_str_equal (type, "org.ayatana.indicator.playback-item"))
-    item = ido_playback_menu_item_new_from_model (menuitem, actions);
+  g_return_if_fail (type != NULL);
+
+  table = ido_menu_item_factory_get_types ();
+  quark = g_quark_from_string (type);
+
+  if (constructor)
+    {
+      IdoMenuItemType *entry;
+
+      entry = g_slice_new0 (IdoMenuItemType);
+      entry->constructor = constructor;
+      entry->updater = updater;
+      entry->generation = ++last_generation;
+
+      g_hash_table_insert (table, GUINT_TO_POINTER (quark), entry);
+    }
+  else
+    {
+      g_hash_table_remove (table, GUINT_TO_POINTER (quark));
+    }
+}
+
+/**
+ * ido_menu_item_factory_lookup_type:
+ * @type: an "x-ayatana-type"
+ *
+ * Returns: (nullable): the constructor registered for @type, or %NULL
+ * if the factory does not know about @type
+ */
+IdoMenuItemConstructor
+ido_menu_item_factory_lookup_type (const gchar *type)
+{
+  IdoMenuItemType *entry;
+
+  g_return_val_if_fail (type != NULL, NULL);
+
+  entry = ido_menu_item_factory_lookup (type);
+
+  return entry ? entry->constructor : NULL;
+}
+
+/**
+ * ido_menu_item_factory_release_menu_item:
+ * @item: (transfer none): a menu item built by the ido factory
+ *
+ * Hands @item back to the factory once it isn't shown anymore. If its
+ * type was registered with an updater, @item is removed from its
+ * parent, reset and kept for the next menu item of the same type, with
+ * a reference of the factory's own. Otherwise, it is destroyed, which
+ * makes its parent drop its reference.
+ *
+ * Either way, references the caller holds on @item stay valid and
+ * remain the caller's to drop; @item must not be used for anything else
+ * afterwards, as it may be handed out again.
+ */
+void
+ido_menu_item_factory_release_menu_item (GtkMenuItem *item)
+{
+  IdoMenuItemType *entry;
+  GtkWidget *parent;
+
+  g_return_if_fail (GTK_IS_MENU_ITEM (item));
+
+  entry = ido_menu_item_factory_lookup_item (item);
+  if (entry == NULL || entry->updater == NULL || entry->pool.length >= MAX_POOLED_ITEMS)
+    {
+      gtk_widget_destroy (GTK_WIDGET (item));
+      return;
+    }
+
+  /* the pool's reference, taken before the parent drops its own */
+  g_object_ref_sink (item);
+
+  parent = gtk_widget_get_parent (GTK_WIDGET (item));
+  if (parent)
+    gtk_container_remove (GTK_CONTAINER (parent), GTK_WIDGET (item));
+
+  entry->updater (item, NULL, NULL);
+  g_queue_push_tail (&entry->pool, item);
+}
+
+/**
+ * ido_menu_item_factory_update_menu_item:
+ * @item: a menu item built by the ido factory
+ * @menuitem: the #GMenuItem to apply to @item
+ * @actions: the #GActionGroup the item's action lives in
+ *
+ * Applies @menuitem to @item in place, through the updater of the type
+ * @item was built for. Only the properties and the action binding that
+ * differ from the current ones are touched, so this is cheap to call
+ * whenever a menu model entry changes.
+ *
+ * Returns: %TRUE if @item was updated, %FALSE if its type has no
+ * updater or was registered again since @item was built, and @item
+ * needs to be rebuilt instead
+ */
+gboolean
+ido_menu_item_factory_update_menu_item (GtkMenuItem  *item,
+                                        GMenuItem    *menuitem,
+                                        GActionGroup *actions)
+{
+  IdoMenuItemType *entry;
+
+  g_return_val_if_fail (GTK_IS_MENU_ITEM (item), FALSE);
+  g_return_val_if_fail (G_IS_MENU_ITEM (menuitem), FALSE);
+
+  entry = ido_menu_item_factory_lookup_item (item);
+  if (entry == NULL || entry->updater == NULL)
+    return FALSE;
+
+  entry->updater (item, menuitem, actions);
+
+  return TRUE;
+}
+
+static GtkMenuItem *
+ido_menu_item_factory_create_menu_item (AyatanaMenuItemFactory *factory,
+                                        const gchar           *type,
+                                        GMenuItem             *menuitem,
+                                        GActionGroup          *actions)
+{
+  IdoMenuItemType *entry;
+  GtkMenuItem *item;
 
-  else if (g_str_equal (type, "org.ayatana.indicator.application"))
-    item = ido_application_menu_item_new_from_model (menuitem, actions);
+  entry = ido_menu_item_factory_lookup (type);
+  if (entry == NULL)
+    return NULL;
 
-  else if (g_str_equal (type, "org.ayatana.indicator.messages.source"))
-    item = ido_source_menu_item_new_from_menu_model (menuitem, actions);
+  item = g_queue_pop_head (&entry->pool);
+  if (item)
+    {
+      entry->updater (item, menuitem, actions);
 
-  else if (g_str_equal (type, "org.ayatana.indicator.switch"))
-    item = ido_switch_menu_item_new_from_menu_model (menuitem, actions);
+      /* hand our reference over to the caller like a new widget would */
+      g_object_force_floating (G_OBJECT (item));
 
-  else if (g_str_equal (type, "org.ayatana.indicator.removable"))
-    item = ido_removable_menu_item_new_from_model (menuitem, actions);
+      return item;
+    }
 
-  else if (g_str_equal (type, "org.ayatana.indicator.level"))
-    item = ido_level_menu_item_new_from_model (menuitem, actions);
+  item = entry->constructor (menuitem, actions);
+  if (item)
+    {
+      g_object_set_qdata (G_OBJECT (item), ido_menu_item_factory_type_quark (),
+                          GUINT_TO_POINTER (g_quark_try_string (type)));
+      g_object_set_qdata (G_OBJECT (item), ido_menu_item_factory_generation_quark (),
+                          GUINT_TO_POINTER (entry->generation));
+    }
 
   return item;
 }
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2013 Canonical Ltd.
+ * Copyright 2023 Robert Tari
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *     Lars Uebernickel <lars.uebernickel@canonical.com>
+ *     Robert Tari <robert@tari.in>
+ */
+
+#ifndef __IDO_MENU_ITEM_FACTORY_H__
+#define __IDO_MENU_ITEM_FACTORY_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/**
+ * IdoMenuItemConstructor:
+ * @menuitem: the #GMenuItem describing the item
+ * @actions: the #GActionGroup the item's action lives in
+ *
+ * Builds a menu item from a menu model entry whose "x-ayatana-type"
+ * attribute matched the type this constructor was registered for.
+ *
+ * Returns: (transfer full) (nullable): a new #GtkMenuItem
+ */
+typedef GtkMenuItem * (*IdoMenuItemConstructor) (GMenuItem    *menuitem,
+                                                 GActionGroup *actions);
+
+/**
+ * IdoMenuItemUpdater:
+ * @item: a menu item previously built for the same type
+ * @menuitem: (nullable): the #GMenuItem to apply to @item
+ * @actions: (nullable): the #GActionGroup the item's action lives in
+ *
+ * Applies the attributes and action of @menuitem to an existing @item.
+ * When @menuitem is %NULL, @item is being released and must be left as
+ * blank as a new item: no action binding, labels, icons, pending loads
+ * or tick callbacks.
+ */
+typedef void          (*IdoMenuItemUpdater)     (GtkMenuItem  *item,
+                                                 GMenuItem    *menuitem,
+                                                 GActionGroup *actions);
+
+void                    ido_menu_item_factory_register_type     (const gchar            *type,
+                                                                 IdoMenuItemConstructor  constructor);
+
+void                    ido_menu_item_factory_register_type_full (const gchar            *type,
+                                                                  IdoMenuItemConstructor  constructor,
+                                                                  IdoMenuItemUpdater      updater);
+
+gboolean                ido_menu_item_factory_update_menu_item  (GtkMenuItem            *item,
+                                                                 GMenuItem              *menuitem,
+                                                                 GActionGroup           *actions);
+
+void                    ido_menu_item_factory_release_menu_item (GtkMenuItem            *item);
+
+IdoMenuItemConstructor  ido_menu_item_factory_lookup_type       (const gchar            *type);
+
+G_END_DECLS
+
+#endif
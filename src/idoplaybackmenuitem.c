@@ -23,6 +23,7 @@
  */
 
 #include "idoplaybackmenuitem.h"
+#include "idoshadowcache.h"
 
 #include <gdk/gdkkeysyms.h>
 #include <math.h>
@@ -85,6 +86,62 @@ typedef enum
   N_BUTTONS
 } Button;
 
+/* the shapes of the buttons, whose paths and shadows are shared by all
+ * playback items */
+typedef enum
+{
+  GLYPH_PREVIOUS,
+  GLYPH_NEXT,
+  GLYPH_PAUSE,
+  GLYPH_PLAY,
+  N_GLYPHS
+} Glyph;
+
+typedef struct
+{
+  Glyph glyph;
+  const double *rgba;
+} GlyphShadow;
+
+/* the artwork is rendered ARTWORK_LEFT pixels right of and ARTWORK_TOP
+ * pixels below its origin, with room for the arcs and shadows that
+ * reach past the outer gradient */
+#define ARTWORK_LEFT 17
+#define ARTWORK_TOP 2
+#define ARTWORK_WIDTH ((gint) RECT_WIDTH + 2 * ARTWORK_LEFT)
+#define ARTWORK_HEIGHT 52
+#define ARTWORK_CACHE_SIZE 6
+
+typedef struct
+{
+  double middle_end[4];
+  double middle_start[4];
+  double middle_end_prelight[4];
+  double middle_start_prelight[4];
+  double outer_end[4];
+  double outer_start[4];
+  double outer_end_prelight[4];
+  double outer_start_prelight[4];
+  double shadow_button[4];
+  double outer_play_end[4];
+  double outer_play_start[4];
+  double outer_play_end_prelight[4];
+  double outer_play_start_prelight[4];
+  double button_end[4];
+  double button_start[4];
+  double button_shadow[4];
+  double button_shadow_focus[4];
+  double inner_compressed_end[4];
+  double inner_compressed_start[4];
+} ArtworkColours;
+
+typedef struct
+{
+  guint key;
+  guint last_used;
+  cairo_surface_t *surface;
+} ArtworkEntry;
+
 typedef GtkMenuItemClass IdoPlaybackMenuItemClass;
 
 struct _IdoPlaybackMenuItem
@@ -99,11 +156,17 @@ struct _IdoPlaybackMenuItem
 
   GActionGroup *action_group;
   gchar *button_actions[N_BUTTONS];
+
+  ArtworkColours colours;
+  gboolean colours_valid;
+  ArtworkEntry artwork[ARTWORK_CACHE_SIZE];
+  guint artwork_age;
 };
 
 G_DEFINE_TYPE (IdoPlaybackMenuItem, ido_playback_menu_item, GTK_TYPE_MENU_ITEM);
 
 static gboolean ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr);
+static void ido_playback_menu_item_clear_artwork (IdoPlaybackMenuItem *item);
 
 static void
 ido_playback_menu_item_dispose (GObject *object)
@@ -128,38 +191,142 @@ ido_playback_menu_item_finalize (GObject *object)
   for (i = 0; i < N_BUTTONS; i++)
     g_free (item->button_actions[i]);
 
+  ido_playback_menu_item_clear_artwork (item);
+
   G_OBJECT_CLASS (ido_playback_menu_item_parent_class)->finalize (object);
 }
 
+/*     0    44      86    130
+ *  5        +------+
+ * 12  +-----+      +-----+
+ *     |prev   play   next|
+ * 40  +-----+      +-----+
+ * 47        +------+
+ */
+static const GdkRectangle button_areas[N_BUTTONS] =
+{
+  [BUTTON_PREVIOUS]  = {  0, 12, 44, 28 },
+  [BUTTON_PLAYPAUSE] = { 44,  5, 42, 42 },
+  [BUTTON_NEXT]      = { 86, 12, 44, 28 }
+};
+
+/* everything that changes when a button is hovered or pressed: its
+ * half of the outer gradient, the play circle and the glyph shadows */
+static const GdkRectangle button_damage[N_BUTTONS] =
+{
+  [BUTTON_PREVIOUS]  = { -1,  5, 67, 35 },
+  [BUTTON_PLAYPAUSE] = { 43,  0, 47, 48 },
+  [BUTTON_NEXT]      = { 64,  5, 67, 35 }
+};
+
+/* the x draw() paints the artwork at, in the coordinates of its cairo
+ * context, which start at the allocation */
+static gint
+ido_playback_menu_item_get_x (GtkWidget *item)
+{
+  GtkAllocation alloc;
+
+  gtk_widget_get_allocation (item, &alloc);
+
+  return alloc.x + (alloc.width - RECT_WIDTH) / 2 + OUTER_RADIUS;
+}
+
+/* the left edge of the drawn buttons, which their areas are relative to */
+static gint
+ido_playback_menu_item_get_left (GtkWidget *item)
+{
+  return floor (ido_playback_menu_item_get_x (item) - OUTER_RADIUS);
+}
+
 static Button
 ido_playback_menu_item_get_button_at_pos (GtkWidget *item,
                                           gint       x,
                                           gint       y)
 {
-  GtkAllocation alloc;
   gint left;
+  Button button;
 
-  /*     0    44      86    130
-   *  5        +------+
-   * 12  +-----+      +-----+
-   *     |prev   play   next|
-   * 40  +-----+      +-----+
-   * 47        +------+
-   */
+  left = ido_playback_menu_item_get_left (item);
 
-  gtk_widget_get_allocation (item, &alloc);
-  left = alloc.x + (alloc.width - RECT_WIDTH) / 2;
+  for (button = BUTTON_PREVIOUS; button < N_BUTTONS; button++)
+    {
+      const GdkRectangle *area = &button_areas[button];
 
-  if (x > left && x < left + 44 && y > 12 && y < 40)
-    return BUTTON_PREVIOUS;
+      if (x > left + area->x && x < left + area->x + area->width &&
+          y > area->y && y < area->y + area->height)
+        return button;
+    }
 
-  if (x > left + 44 && x < left + 86 && y > 5 && y < 47)
-    return BUTTON_PLAYPAUSE;
+  return BUTTON_NONE;
+}
 
-  if (x > left + 86 && x < left + 130 && y > 12 && y < 40)
-    return BUTTON_NEXT;
+static void
+ido_playback_menu_item_queue_draw_button (IdoPlaybackMenuItem *item,
+                                          Button               button)
+{
+  const GdkRectangle *damage = &button_damage[button];
+  GtkAllocation alloc;
 
-  return BUTTON_NONE;
+  if (button == BUTTON_NONE)
+    return;
+
+  /* the item has no window of its own, so it is damaged in the
+   * coordinates of its parent's window rather than in those of draw() */
+  gtk_widget_get_allocation (GTK_WIDGET (item), &alloc);
+
+  gtk_widget_queue_draw_area (GTK_WIDGET (item),
+                              alloc.x + ido_playback_menu_item_get_left (GTK_WIDGET (item)) + damage->x,
+                              alloc.y + damage->y, damage->width, damage->height);
+}
+
+/*
+ * Queues a redraw of the buttons whose look changes when the hovered
+ * or pushed button goes from @old_button to @new_button. While the
+ * item has focus, the play/pause glyph also loses or regains its
+ * focus shadow.
+ */
+static void
+ido_playback_menu_item_queue_draw_change (IdoPlaybackMenuItem *item,
+                                          Button               old_button,
+                                          Button               new_button)
+{
+  if (old_button == new_button)
+    return;
+
+  ido_playback_menu_item_queue_draw_button (item, old_button);
+  ido_playback_menu_item_queue_draw_button (item, new_button);
+
+  if (item->has_focus && old_button != BUTTON_PLAYPAUSE && new_button != BUTTON_PLAYPAUSE)
+    ido_playback_menu_item_queue_draw_button (item, BUTTON_PLAYPAUSE);
+}
+
+static void
+ido_playback_menu_item_set_hover_button (IdoPlaybackMenuItem *item,
+                                         Button               button)
+{
+  Button old = item->cur_hover_button;
+
+  item->cur_hover_button = button;
+  ido_playback_menu_item_queue_draw_change (item, old, button);
+}
+
+static void
+ido_playback_menu_item_set_pushed_button (IdoPlaybackMenuItem *item,
+                                          Button               button,
+                                          gboolean             keyboard_activated)
+{
+  Button old = item->cur_pushed_button;
+
+  /* a keyboard press also gives the glyph its focus shadow */
+  if (item->keyboard_activated != keyboard_activated)
+    {
+      ido_playback_menu_item_queue_draw_button (item, old);
+      ido_playback_menu_item_queue_draw_button (item, button);
+    }
+
+  item->cur_pushed_button = button;
+  item->keyboard_activated = keyboard_activated;
+  ido_playback_menu_item_queue_draw_change (item, old, button);
 }
 
 static gboolean
@@ -168,6 +335,7 @@ ido_playback_menu_item_parent_key_press_event (GtkWidget   *widget,
                                                gpointer     user_data)
 {
   IdoPlaybackMenuItem *self = user_data;
+  Button button;
 
   /* only listen to events when the playback menu item is selected */
   if (!self->has_focus)
@@ -176,36 +344,36 @@ ido_playback_menu_item_parent_key_press_event (GtkWidget   *widget,
   switch (event->keyval)
     {
     case GDK_KEY_Left:
-      self->cur_pushed_button = BUTTON_PREVIOUS;
+      button = BUTTON_PREVIOUS;
       break;
 
     case GDK_KEY_Right:
-      self->cur_pushed_button = BUTTON_NEXT;
+      button = BUTTON_NEXT;
       break;
 
     case GDK_KEY_space:
       if (self->cur_hover_button != BUTTON_NONE)
-        self->cur_pushed_button = self->cur_hover_button;
+        button = self->cur_hover_button;
       else
-        self->cur_pushed_button = BUTTON_PLAYPAUSE;
+        button = BUTTON_PLAYPAUSE;
       break;
 
     default:
-      self->cur_pushed_button = BUTTON_NONE;
+      button = BUTTON_NONE;
     }
 
-  if (self->cur_pushed_button != BUTTON_NONE)
+  if (button != BUTTON_NONE)
     {
-      const gchar *action = self->button_actions[self->cur_pushed_button];
+      const gchar *action = self->button_actions[button];
 
       if (self->action_group && action)
         g_action_group_activate_action (self->action_group, action, NULL);
 
-      self->keyboard_activated = TRUE;
-      gtk_widget_queue_draw (widget);
+      ido_playback_menu_item_set_pushed_button (self, button, TRUE);
       return TRUE;
     }
 
+  ido_playback_menu_item_set_pushed_button (self, BUTTON_NONE, self->keyboard_activated);
   return FALSE;
 }
 
@@ -221,9 +389,7 @@ ido_playback_menu_item_parent_key_release_event (GtkWidget   *widget,
     case GDK_KEY_Left:
     case GDK_KEY_Right:
     case GDK_KEY_space:
-      self->cur_pushed_button = BUTTON_NONE;
-      self->keyboard_activated = FALSE;
-      gtk_widget_queue_draw (widget);
+      ido_playback_menu_item_set_pushed_button (self, BUTTON_NONE, FALSE);
       break;
     }
 
@@ -281,8 +447,9 @@ ido_playback_menu_item_button_press_event (GtkWidget      *menuitem,
 {
   IdoPlaybackMenuItem *item = IDO_PLAYBACK_MENU_ITEM (menuitem);
 
-  item->cur_pushed_button = ido_playback_menu_item_get_button_at_pos (menuitem, event->x, event->y);
-  gtk_widget_queue_draw (menuitem);
+  ido_playback_menu_item_set_pushed_button (item,
+                                            ido_playback_menu_item_get_button_at_pos (menuitem, event->x, event->y),
+                                            item->keyboard_activated);
 
   return TRUE;
 }
@@ -297,8 +464,7 @@ ido_playback_menu_item_button_release_event (GtkWidget      *menuitem,
   if (item->action_group && action)
     g_action_group_activate_action (item->action_group, action, NULL);
 
-  item->cur_pushed_button = BUTTON_NONE;
-  gtk_widget_queue_draw (menuitem);
+  ido_playback_menu_item_set_pushed_button (item, BUTTON_NONE, item->keyboard_activated);
 
   return TRUE;
 }
@@ -309,8 +475,8 @@ ido_playback_menu_item_motion_notify_event (GtkWidget      *menuitem,
 {
   IdoPlaybackMenuItem *item = IDO_PLAYBACK_MENU_ITEM (menuitem);
 
-  item->cur_hover_button = ido_playback_menu_item_get_button_at_pos (menuitem, event->x, event->y);
-  gtk_widget_queue_draw (menuitem);
+  ido_playback_menu_item_set_hover_button (item,
+                                           ido_playback_menu_item_get_button_at_pos (menuitem, event->x, event->y));
 
   return TRUE;
 }
@@ -321,13 +487,24 @@ ido_playback_menu_item_leave_notify_event (GtkWidget        *menuitem,
 {
   IdoPlaybackMenuItem *item = IDO_PLAYBACK_MENU_ITEM (menuitem);
 
-  item->cur_pushed_button = BUTTON_NONE;
-  item->cur_hover_button = BUTTON_NONE;
-  gtk_widget_queue_draw (GTK_WIDGET(menuitem));
+  ido_playback_menu_item_set_pushed_button (item, BUTTON_NONE, item->keyboard_activated);
+  ido_playback_menu_item_set_hover_button (item, BUTTON_NONE);
 
   return TRUE;
 }
 
+static void
+ido_playback_menu_item_style_updated (GtkWidget *widget)
+{
+  IdoPlaybackMenuItem *item = IDO_PLAYBACK_MENU_ITEM (widget);
+
+  GTK_WIDGET_CLASS (ido_playback_menu_item_parent_class)->style_updated (widget);
+
+  item->colours_valid = FALSE;
+  ido_playback_menu_item_clear_artwork (item);
+  gtk_widget_queue_draw (widget);
+}
+
 static void
 ido_playback_menu_item_class_init (IdoPlaybackMenuItemClass *klass)
 {
@@ -344,6 +521,7 @@ ido_playback_menu_item_class_init (IdoPlaybackMenuItemClass *klass)
   widget_class->leave_notify_event = ido_playback_menu_item_leave_notify_event;
   widget_class->parent_set = ido_playback_menu_item_parent_set;
   widget_class->draw = ido_playback_menu_item_draw;
+  widget_class->style_updated = ido_playback_menu_item_style_updated;
 
   menuitem_class->select = ido_playback_menu_item_select;
   menuitem_class->deselect = ido_playback_menu_item_deselect;
@@ -437,29 +615,80 @@ ido_playback_menu_item_action_state_changed (GActionGroup *action_group,
     }
 }
 
-GtkMenuItem *
-ido_playback_menu_item_new_from_model (GMenuItem    *item,
-                                       GActionGroup *actions)
+/**
+ * ido_playback_menu_item_update_from_model:
+ * @menuitem: an #IdoPlaybackMenuItem
+ * @item: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @item's action
+ *
+ * Applies the button actions of @item to an #IdoPlaybackMenuItem and
+ * tracks @actions for their state, reconnecting only if the action
+ * group changed. If @item is %NULL, the item stops tracking actions and
+ * goes back to its paused state, with no button hovered or pushed.
+ */
+void
+ido_playback_menu_item_update_from_model (GtkMenuItem  *menuitem,
+                                          GMenuItem    *item,
+                                          GActionGroup *actions)
 {
   IdoPlaybackMenuItem *widget;
   gchar *play_action;
+  gint i;
 
-  widget = g_object_new (IDO_TYPE_PLAYBACK_MENU_ITEM, NULL);
+  g_return_if_fail (IDO_IS_PLAYBACK_MENU_ITEM (menuitem));
+
+  widget = IDO_PLAYBACK_MENU_ITEM (menuitem);
+
+  if (item == NULL)
+    actions = NULL;
 
-  widget->action_group = g_object_ref (actions);
-  g_signal_connect (actions, "action-state-changed", G_CALLBACK (ido_playback_menu_item_action_state_changed), widget);
-  g_signal_connect (actions, "action-added", G_CALLBACK (ido_playback_menu_item_action_added), widget);
-  g_signal_connect (actions, "action-removed", G_CALLBACK (ido_playback_menu_item_action_removed), widget);
+  if (widget->action_group != actions)
+    {
+      if (widget->action_group)
+        {
+          g_signal_handlers_disconnect_by_data (widget->action_group, widget);
+          g_clear_object (&widget->action_group);
+        }
+
+      if (actions)
+        {
+          widget->action_group = g_object_ref (actions);
+          g_signal_connect (actions, "action-state-changed", G_CALLBACK (ido_playback_menu_item_action_state_changed), widget);
+          g_signal_connect (actions, "action-added", G_CALLBACK (ido_playback_menu_item_action_added), widget);
+          g_signal_connect (actions, "action-removed", G_CALLBACK (ido_playback_menu_item_action_removed), widget);
+        }
+    }
+
+  for (i = 0; i < N_BUTTONS; i++)
+    g_clear_pointer (&widget->button_actions[i], g_free);
+
+  if (item == NULL)
+    {
+      ido_playback_menu_item_set_state (widget, STATE_PAUSED);
+      ido_playback_menu_item_set_pushed_button (widget, BUTTON_NONE, FALSE);
+      ido_playback_menu_item_set_hover_button (widget, BUTTON_NONE);
+      return;
+    }
 
   g_menu_item_get_attribute (item, "x-ayatana-play-action", "s", &widget->button_actions[BUTTON_PLAYPAUSE]);
   g_menu_item_get_attribute (item, "x-ayatana-next-action", "s", &widget->button_actions[BUTTON_NEXT]);
   g_menu_item_get_attribute (item, "x-ayatana-previous-action", "s", &widget->button_actions[BUTTON_PREVIOUS]);
 
   play_action = widget->button_actions[BUTTON_PLAYPAUSE];
-  if (play_action && g_action_group_has_action (actions, play_action))
+  if (actions && play_action && g_action_group_has_action (actions, play_action))
     ido_playback_menu_item_action_added (actions, play_action, widget);
+}
+
+GtkMenuItem *
+ido_playback_menu_item_new_from_model (GMenuItem    *item,
+                                       GActionGroup *actions)
+{
+  GtkMenuItem *widget;
+
+  widget = g_object_new (IDO_TYPE_PLAYBACK_MENU_ITEM, NULL);
+  ido_playback_menu_item_update_from_model (widget, item, actions);
 
-  return GTK_MENU_ITEM (widget);
+  return widget;
 }
 
 
@@ -473,8 +702,8 @@ draw_gradient (cairo_t* cr,
                double   y,
                double   w,
                double   r,
-               double*  rgba_start,
-               double*  rgba_end)
+               const double* rgba_start,
+               const double* rgba_end)
 {
   cairo_pattern_t* pattern = NULL;
 
@@ -518,8 +747,8 @@ draw_circle (cairo_t* cr,
        double   x,
        double   y,
        double   r,
-       double*  rgba_start,
-       double*  rgba_end)
+       const double* rgba_start,
+       const double* rgba_end)
 {
   cairo_pattern_t* pattern = NULL;
 
@@ -625,9 +854,6 @@ _mask_pause (cairo_t* cr,
   if (!cr)
     return;
 
-  cairo_set_line_width (cr, bar_width);
-  cairo_set_line_cap (cr, CAIRO_LINE_CAP_ROUND);
-
   x += bar_width;
   y += bar_width;
   cairo_move_to (cr, x,              y);
@@ -660,8 +886,8 @@ _fill (cairo_t* cr,
        double   y_start,
        double   x_end,
        double   y_end,
-       double*  rgba_start,
-       double*  rgba_end,
+       const double* rgba_start,
+       const double* rgba_end,
        gboolean stroke)
 {
   cairo_pattern_t* pattern = NULL;
@@ -706,26 +932,180 @@ _finalize (cairo_t*          cr,
   cairo_destroy (*cr_surf);
 }
 
+/*
+ * Appends the outline of @glyph to the current path of @cr. The
+ * outlines don't depend on the item, state or device scale, so each
+ * one is built once, in user space, and then copied for every draw.
+ */
 static void
-_finalize_repaint (cairo_t*          cr,
-             cairo_t**         cr_surf,
-             cairo_surface_t** surf,
-             double            x,
-             double            y,
-             int               repaints)
+_append_glyph_path (cairo_t* cr,
+                    Glyph    glyph)
 {
-  if (!cr || !cr_surf || !surf)
-    return;
+  static cairo_path_t* paths[N_GLYPHS];
+
+  if (paths[glyph] == NULL)
+  {
+    cairo_save (cr);
+    cairo_identity_matrix (cr);
+    cairo_new_path (cr);
+
+    switch (glyph)
+    {
+      case GLYPH_PREVIOUS:
+        _mask_prev (cr,
+                    (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
+                    (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
+                    TRI_WIDTH,
+                    TRI_HEIGHT,
+                    TRI_OFFSET);
+      break;
+
+      case GLYPH_NEXT:
+        _mask_next (cr,
+                    (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
+                    (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
+                    TRI_WIDTH,
+                    TRI_HEIGHT,
+                    TRI_OFFSET);
+      break;
+
+      case GLYPH_PAUSE:
+        _mask_pause (cr,
+                     (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
+                     (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
+                     BAR_WIDTH,
+                     BAR_HEIGHT - 2.0f * BAR_WIDTH,
+                     BAR_OFFSET);
+      break;
+
+      case GLYPH_PLAY:
+        _mask_play (cr,
+                    PLAY_PADDING,
+                    PLAY_PADDING,
+                    PLAY_WIDTH - (2*PLAY_PADDING),
+                    PLAY_HEIGHT - (2*PLAY_PADDING));
+      break;
+
+      default:
+      break;
+    }
+
+    paths[glyph] = cairo_copy_path (cr);
+    cairo_new_path (cr);
+    cairo_restore (cr);
+  }
+
+  cairo_append_path (cr, paths[glyph]);
+}
+
+/*
+ * Draws @glyph the way the buttons and their shadows are drawn, in a
+ * surface of the size of the glyph's button.
+ */
+static void
+_draw_glyph (cairo_t*      cr,
+             Glyph         glyph,
+             const double* rgba_start,
+             const double* rgba_end)
+{
+  _append_glyph_path (cr, glyph);
+
+  switch (glyph)
+  {
+    case GLYPH_PREVIOUS:
+      _fill (cr,
+             (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
+             (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
+             (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
+             (double) TRI_HEIGHT,
+             rgba_start,
+             rgba_end,
+             FALSE);
+    break;
+
+    case GLYPH_NEXT:
+      _fill (cr,
+             (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
+             (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
+             (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
+             (double) TRI_HEIGHT,
+             rgba_start,
+             rgba_end,
+             FALSE);
+    break;
+
+    case GLYPH_PAUSE:
+      // the pause bars are stroked, not filled
+      cairo_set_line_width (cr, BAR_WIDTH);
+      cairo_set_line_cap (cr, CAIRO_LINE_CAP_ROUND);
+      _fill (cr,
+             (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
+             (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
+             (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
+             (double) BAR_HEIGHT,
+             rgba_start,
+             rgba_end,
+             TRUE);
+    break;
+
+    case GLYPH_PLAY:
+      _fill (cr,
+             PLAY_PADDING,
+             PLAY_PADDING,
+             PLAY_WIDTH - (2*PLAY_PADDING),
+             PLAY_HEIGHT - (2*PLAY_PADDING),
+             rgba_start,
+             rgba_end,
+             FALSE);
+    break;
+
+    default:
+    break;
+  }
+}
+
+static void
+_draw_glyph_shadow (cairo_t* cr,
+                    gpointer user_data)
+{
+  GlyphShadow *shadow = user_data;
+
+  _draw_glyph (cr, shadow->glyph, shadow->rgba, shadow->rgba);
+}
+
+/*
+ * Paints the shadow of @glyph @repaints times at @x, @y. The blurred
+ * surface comes from the shadow cache, shared by all playback items,
+ * and is rendered at the device scale of @cr's target.
+ */
+static void
+_paint_shadow (cairo_t*      cr,
+               Glyph         glyph,
+               gint          width,
+               gint          height,
+               guint         radius,
+               const double* rgba,
+               double        x,
+               double        y,
+               int           repaints)
+{
+  GlyphShadow shadow = { glyph, rgba };
+  cairo_surface_t* surf;
+  double scale;
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &scale, NULL);
+
+  surf = ido_shadow_cache_get (glyph, width, height, radius, rgba, (gint) scale,
+                               _draw_glyph_shadow, &shadow);
 
   while (repaints > 0)
   {
-    cairo_set_source_surface (cr, *surf, x, y);
+    cairo_set_source_surface (cr, surf, x, y);
     cairo_paint (cr);
     repaints--;
   }
 
-  cairo_surface_destroy (*surf);
-  cairo_destroy (*cr_surf);
+  cairo_surface_destroy (surf);
 }
 
 static void
@@ -924,213 +1304,6 @@ static void _color_shade(const GdkRGBA *a, float k, GdkRGBA *b)
   b->blue = blue;
 }
 
-static inline void
-_blurinner (guchar* pixel,
-      gint*   zR,
-      gint*   zG,
-      gint*   zB,
-      gint*   zA,
-      gint    alpha,
-      gint    aprec,
-      gint    zprec)
-{
-  gint R;
-  gint G;
-  gint B;
-  guchar A;
-
-  R = *pixel;
-  G = *(pixel + 1);
-  B = *(pixel + 2);
-  A = *(pixel + 3);
-
-  *zR += (alpha * ((R << zprec) - *zR)) >> aprec;
-  *zG += (alpha * ((G << zprec) - *zG)) >> aprec;
-  *zB += (alpha * ((B << zprec) - *zB)) >> aprec;
-  *zA += (alpha * ((A << zprec) - *zA)) >> aprec;
-
-  *pixel       = *zR >> zprec;
-  *(pixel + 1) = *zG >> zprec;
-  *(pixel + 2) = *zB >> zprec;
-  *(pixel + 3) = *zA >> zprec;
-}
-
-static inline void
-_blurrow (guchar* pixels,
-    gint    width,
-    gint    height,
-    gint    channels,
-    gint    line,
-    gint    alpha,
-    gint    aprec,
-    gint    zprec)
-{
-  gint    zR;
-  gint    zG;
-  gint    zB;
-  gint    zA;
-  gint    index;
-  guchar* scanline;
-
-  scanline = &(pixels[line * width * channels]);
-
-  zR = *scanline << zprec;
-  zG = *(scanline + 1) << zprec;
-  zB = *(scanline + 2) << zprec;
-  zA = *(scanline + 3) << zprec;
-
-  for (index = 0; index < width; index ++)
-    _blurinner (&scanline[index * channels],
-          &zR,
-          &zG,
-          &zB,
-          &zA,
-          alpha,
-          aprec,
-          zprec);
-
-  for (index = width - 2; index >= 0; index--)
-    _blurinner (&scanline[index * channels],
-          &zR,
-          &zG,
-          &zB,
-          &zA,
-          alpha,
-          aprec,
-          zprec);
-}
-
-static inline void
-_blurcol (guchar* pixels,
-    gint    width,
-    gint    height,
-    gint    channels,
-    gint    x,
-    gint    alpha,
-    gint    aprec,
-    gint    zprec)
-{
-  gint zR;
-  gint zG;
-  gint zB;
-  gint zA;
-  gint index;
-  guchar* ptr;
-
-  ptr = pixels;
-
-  ptr += x * channels;
-
-  zR = *((guchar*) ptr    ) << zprec;
-  zG = *((guchar*) ptr + 1) << zprec;
-  zB = *((guchar*) ptr + 2) << zprec;
-  zA = *((guchar*) ptr + 3) << zprec;
-
-  for (index = width; index < (height - 1) * width; index += width)
-    _blurinner ((guchar*) &ptr[index * channels],
-          &zR,
-          &zG,
-          &zB,
-          &zA,
-          alpha,
-          aprec,
-          zprec);
-
-  for (index = (height - 2) * width; index >= 0; index -= width)
-    _blurinner ((guchar*) &ptr[index * channels],
-          &zR,
-          &zG,
-          &zB,
-          &zA,
-          alpha,
-          aprec,
-          zprec);
-}
-
-static void
-_expblur (guchar* pixels,
-    gint    width,
-    gint    height,
-    gint    channels,
-    gint    radius,
-    gint    aprec,
-    gint    zprec)
-{
-  gint alpha;
-  gint row = 0;
-  gint col = 0;
-
-  if (radius < 1)
-    return;
-
-  // calculate the alpha such that 90% of
-  // the kernel is within the radius.
-  // (Kernel extends to infinity)
-  alpha = (gint) ((1 << aprec) * (1.0f - expf (-2.3f / (radius + 1.f))));
-
-  for (; row < height; row++)
-    _blurrow (pixels,
-        width,
-        height,
-        channels,
-        row,
-        alpha,
-        aprec,
-        zprec);
-
-  for(; col < width; col++)
-    _blurcol (pixels,
-        width,
-        height,
-        channels,
-        col,
-        alpha,
-        aprec,
-        zprec);
-
-  return;
-}
-
-static void
-_surface_blur (cairo_surface_t* surface,
-               guint            radius)
-{
-  guchar*        pixels;
-  guint          width;
-  guint          height;
-  cairo_format_t format;
-
-  // before we mess with the surface execute any pending drawing
-  cairo_surface_flush (surface);
-
-  pixels = cairo_image_surface_get_data (surface);
-  width  = cairo_image_surface_get_width (surface);
-  height = cairo_image_surface_get_height (surface);
-  format = cairo_image_surface_get_format (surface);
-
-  switch (format)
-  {
-    case CAIRO_FORMAT_ARGB32:
-      _expblur (pixels, width, height, 4, radius, 16, 7);
-    break;
-
-    case CAIRO_FORMAT_RGB24:
-      _expblur (pixels, width, height, 3, radius, 16, 7);
-    break;
-
-    case CAIRO_FORMAT_A8:
-      _expblur (pixels, width, height, 1, radius, 16, 7);
-    break;
-
-    default :
-      // do nothing
-    break;
-  }
-
-  // inform cairo we altered the surfaces contents
-  cairo_surface_mark_dirty (surface);
-}
-
 static void get_colour(GtkStyleContext *pStyleContext, GtkStateFlags nState, const gchar *sColour, GdkRGBA *pRGBA)
 {
     GdkRGBA *pRGBATmp;
@@ -1139,36 +1312,40 @@ static void get_colour(GtkStyleContext *pStyleContext, GtkStateFlags nState, con
     gdk_rgba_free(pRGBATmp);
 }
 
-static gboolean
-ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
+static void
+_set_rgba (double        *rgba,
+           const GdkRGBA *colour,
+           double         alpha)
 {
-  IdoPlaybackMenuItem *item = IDO_PLAYBACK_MENU_ITEM (button);
-  GtkAllocation alloc;
-  gint X;
-  gint abs_pause_x;
-  gint abs_prev_x;
-  gint abs_next_x;
-
-  g_return_val_if_fail(IDO_IS_PLAYBACK_MENU_ITEM (button), FALSE);
-  g_return_val_if_fail(cr != NULL, FALSE);
+  rgba[0] = colour->red;
+  rgba[1] = colour->green;
+  rgba[2] = colour->blue;
+  rgba[3] = alpha;
+}
 
-  cairo_surface_t*  surf = NULL;
-  cairo_t*       cr_surf = NULL;
+/* The theme colours and their shades only change with the style, so
+ * they are computed once and kept until the next style-updated. */
+static const ArtworkColours *
+ido_playback_menu_item_get_colours (IdoPlaybackMenuItem *item)
+{
+  ArtworkColours *colours = &item->colours;
+  GtkStyleContext *pStyleContext;
 
-    GtkStyleContext *pStyleContext;
+  GdkRGBA bg_color, fg_color, bg_selected, bg_prelight;
+  GdkRGBA color_middle[2], color_middle_prelight[2], color_outer[2], color_outer_prelight[2],
+          color_play_outer[2], color_play_outer_prelight[2],
+          color_button[4], color_button_shadow, color_inner_compressed[2];
 
-    GdkRGBA bg_color, fg_color, bg_selected, bg_prelight;
-    GdkRGBA color_middle[2], color_middle_prelight[2], color_outer[2], color_outer_prelight[2],
-                color_play_outer[2], color_play_outer_prelight[2],
-                color_button[4], color_button_shadow, color_inner[2], color_inner_compressed[2];
+  if (item->colours_valid)
+    return colours;
 
-    pStyleContext = gtk_widget_get_style_context(gtk_widget_get_parent(button));
-    // Some buggy themes don't define a fallback "background-color" - let's make this a button, then.
-    gtk_style_context_add_class(pStyleContext, GTK_STYLE_CLASS_BUTTON);
-    get_colour(pStyleContext, GTK_STATE_FLAG_NORMAL, GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &bg_color);
-    get_colour(pStyleContext, GTK_STATE_FLAG_PRELIGHT, GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &bg_prelight);
-    get_colour(pStyleContext, GTK_STATE_FLAG_SELECTED, GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &bg_selected);
-    get_colour(pStyleContext, GTK_STATE_FLAG_NORMAL, GTK_STYLE_PROPERTY_COLOR, &fg_color);
+  pStyleContext = gtk_widget_get_style_context(gtk_widget_get_parent(GTK_WIDGET (item)));
+  // Some buggy themes don't define a fallback "background-color" - let's make this a button, then.
+  gtk_style_context_add_class(pStyleContext, GTK_STYLE_CLASS_BUTTON);
+  get_colour(pStyleContext, GTK_STATE_FLAG_NORMAL, GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &bg_color);
+  get_colour(pStyleContext, GTK_STATE_FLAG_PRELIGHT, GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &bg_prelight);
+  get_colour(pStyleContext, GTK_STATE_FLAG_SELECTED, GTK_STYLE_PROPERTY_BACKGROUND_COLOR, &bg_selected);
+  get_colour(pStyleContext, GTK_STATE_FLAG_NORMAL, GTK_STYLE_PROPERTY_COLOR, &fg_color);
 
   _color_shade (&bg_color,    MIDDLE_START_SHADE, &color_middle[0]);
   _color_shade (&bg_color,    MIDDLE_END_SHADE, &color_middle[1]);
@@ -1182,8 +1359,6 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
   _color_shade (&bg_color,    OUTER_PLAY_END_SHADE, &color_play_outer[1]);
   _color_shade (&bg_prelight, OUTER_PLAY_START_SHADE, &color_play_outer_prelight[0]);
   _color_shade (&bg_prelight, OUTER_PLAY_END_SHADE, &color_play_outer_prelight[1]);
-  _color_shade (&bg_color, INNER_START_SHADE, &color_inner[0]);
-  _color_shade (&bg_color, INNER_END_SHADE, &color_inner[1]);
   _color_shade (&fg_color, BUTTON_START_SHADE, &color_button[0]);
   _color_shade (&fg_color, BUTTON_END_SHADE, &color_button[1]);
   _color_shade (&bg_color, BUTTON_SHADOW_SHADE, &color_button[2]);
@@ -1192,28 +1367,50 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
   _color_shade (&bg_color, INNER_COMPRESSED_START_SHADE, &color_inner_compressed[0]);
   _color_shade (&bg_color, INNER_COMPRESSED_END_SHADE, &color_inner_compressed[1]);
 
-  double MIDDLE_END[]   = {color_middle[0].red, color_middle[0].green, color_middle[0].blue, 1.0f};
-  double MIDDLE_START[] = {color_middle[1].red, color_middle[1].green, color_middle[1].blue, 1.0f};
-  double MIDDLE_END_PRELIGHT[]   = {color_middle_prelight[0].red, color_middle_prelight[0].green, color_middle_prelight[0].blue, 1.0f};
-  double MIDDLE_START_PRELIGHT[] = {color_middle_prelight[1].red, color_middle_prelight[1].green, color_middle_prelight[1].blue, 1.0f};
-  double OUTER_END[]   = {color_outer[0].red, color_outer[0].green, color_outer[0].blue, 1.0f};
-  double OUTER_START[] = {color_outer[1].red, color_outer[1].green, color_outer[1].blue, 1.0f};
-  double OUTER_END_PRELIGHT[]   = {color_outer_prelight[0].red, color_outer_prelight[0].green, color_outer_prelight[0].blue, 1.0f};
-  double OUTER_START_PRELIGHT[] = {color_outer_prelight[1].red, color_outer_prelight[1].green, color_outer_prelight[1].blue, 1.0f};
-  double SHADOW_BUTTON[] = {color_button_shadow.red, color_button_shadow.green, color_button_shadow.blue, 0.3f};
-  double OUTER_PLAY_END[] = {color_play_outer[0].red, color_play_outer[0].green, color_play_outer[0].blue, 1.0f};
-  double OUTER_PLAY_START[] = {color_play_outer[1].red, color_play_outer[1].green, color_play_outer[1].blue, 1.0f};
-  double OUTER_PLAY_END_PRELIGHT[] = {color_play_outer_prelight[0].red, color_play_outer_prelight[0].green, color_play_outer_prelight[0].blue, 1.0f};
-  double OUTER_PLAY_START_PRELIGHT[] = {color_play_outer_prelight[1].red, color_play_outer_prelight[1].green, color_play_outer_prelight[1].blue, 1.0f};
-  double BUTTON_END[] = {color_button[0].red, color_button[0].green, color_button[0].blue, 1.0f};
-  double BUTTON_START[] = {color_button[1].red, color_button[1].green, color_button[1].blue, 1.0f};
-  double BUTTON_SHADOW[] = {color_button[2].red, color_button[2].green, color_button[2].blue, 0.75f};
-  double BUTTON_SHADOW_FOCUS[] = {color_button[3].red, color_button[3].green, color_button[3].blue, 1.0f};
-  double INNER_COMPRESSED_END[] = {color_inner_compressed[1].red, color_inner_compressed[1].green, color_inner_compressed[1].blue, 1.0f};
-  double INNER_COMPRESSED_START[] = {color_inner_compressed[0].red, color_inner_compressed[0].green, color_inner_compressed[0].blue, 1.0f};
+  _set_rgba (colours->middle_end, &color_middle[0], 1.0f);
+  _set_rgba (colours->middle_start, &color_middle[1], 1.0f);
+  _set_rgba (colours->middle_end_prelight, &color_middle_prelight[0], 1.0f);
+  _set_rgba (colours->middle_start_prelight, &color_middle_prelight[1], 1.0f);
+  _set_rgba (colours->outer_end, &color_outer[0], 1.0f);
+  _set_rgba (colours->outer_start, &color_outer[1], 1.0f);
+  _set_rgba (colours->outer_end_prelight, &color_outer_prelight[0], 1.0f);
+  _set_rgba (colours->outer_start_prelight, &color_outer_prelight[1], 1.0f);
+  _set_rgba (colours->shadow_button, &color_button_shadow, 0.3f);
+  _set_rgba (colours->outer_play_end, &color_play_outer[0], 1.0f);
+  _set_rgba (colours->outer_play_start, &color_play_outer[1], 1.0f);
+  _set_rgba (colours->outer_play_end_prelight, &color_play_outer_prelight[0], 1.0f);
+  _set_rgba (colours->outer_play_start_prelight, &color_play_outer_prelight[1], 1.0f);
+  _set_rgba (colours->button_end, &color_button[0], 1.0f);
+  _set_rgba (colours->button_start, &color_button[1], 1.0f);
+  _set_rgba (colours->button_shadow, &color_button[2], 0.75f);
+  _set_rgba (colours->button_shadow_focus, &color_button[3], 1.0f);
+  _set_rgba (colours->inner_compressed_end, &color_inner_compressed[1], 1.0f);
+  _set_rgba (colours->inner_compressed_start, &color_inner_compressed[0], 1.0f);
+
+  item->colours_valid = TRUE;
+
+  return colours;
+}
+
+/*
+ * Renders the buttons, shadows and glyphs for the current state of
+ * @item, with the left edge of the outer gradient at @X.
+ */
+static void
+ido_playback_menu_item_render_artwork (IdoPlaybackMenuItem *item,
+                                       cairo_t             *cr,
+                                       gint                 X)
+{
+  const ArtworkColours *colours;
+  gint abs_pause_x;
+  gint abs_prev_x;
+  gint abs_next_x;
+
+  cairo_surface_t*  surf = NULL;
+  cairo_t*       cr_surf = NULL;
+
+  colours = ido_playback_menu_item_get_colours (item);
 
-  gtk_widget_get_allocation (button, &alloc);
-  X = alloc.x + (alloc.width - RECT_WIDTH) / 2 + OUTER_RADIUS;
   abs_pause_x = X + PAUSE_X;
   abs_prev_x = X + PREV_X;
   abs_next_x = X + NEXT_X;
@@ -1223,24 +1420,24 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                  Y,
                  RECT_WIDTH,
                  OUTER_RADIUS,
-                 OUTER_START,
-                 OUTER_END);
+                 colours->outer_start,
+                 colours->outer_end);
 
   draw_gradient (cr,
                  X,
                  Y + 1,
                  RECT_WIDTH - 2,
                  MIDDLE_RADIUS,
-                 MIDDLE_START,
-                 MIDDLE_END);
+                 colours->middle_start,
+                 colours->middle_end);
 
   draw_gradient (cr,
                  X,
                  Y + 2,
                  RECT_WIDTH - 4,
                  MIDDLE_RADIUS,
-                 MIDDLE_START,
-                 MIDDLE_END);
+                 colours->middle_start,
+                 colours->middle_end);
 
 
   if(item->cur_pushed_button == BUTTON_PREVIOUS)
@@ -1250,24 +1447,24 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                    Y,
                    RECT_WIDTH/2,
                    OUTER_RADIUS,
-                   OUTER_END,
-                   OUTER_START);
+                   colours->outer_end,
+                   colours->outer_start);
 
     draw_gradient (cr,
                    X,
                    Y + 1,
                    RECT_WIDTH/2,
                    MIDDLE_RADIUS,
-                   INNER_COMPRESSED_START,
-                   INNER_COMPRESSED_END);
+                   colours->inner_compressed_start,
+                   colours->inner_compressed_end);
 
     draw_gradient (cr,
                    X,
                    Y + 2,
                    RECT_WIDTH/2,
                    MIDDLE_RADIUS,
-                   INNER_COMPRESSED_START,
-                   INNER_COMPRESSED_END);
+                   colours->inner_compressed_start,
+                   colours->inner_compressed_end);
   }
   else if(item->cur_pushed_button == BUTTON_NEXT)
   {
@@ -1276,24 +1473,24 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                    Y,
                    RECT_WIDTH/2,
                    OUTER_RADIUS,
-                   OUTER_END,
-                   OUTER_START);
+                   colours->outer_end,
+                   colours->outer_start);
 
     draw_gradient (cr,
                    RECT_WIDTH / 2 + X,
                    Y + 1,
                    (RECT_WIDTH - 4.5)/2,
                    MIDDLE_RADIUS,
-                   INNER_COMPRESSED_START,
-                   INNER_COMPRESSED_END);
+                   colours->inner_compressed_start,
+                   colours->inner_compressed_end);
 
     draw_gradient (cr,
                    RECT_WIDTH / 2 + X,
                    Y + 2,
                    (RECT_WIDTH - 7)/2,
                    MIDDLE_RADIUS,
-                   INNER_COMPRESSED_START,
-                   INNER_COMPRESSED_END);
+                   colours->inner_compressed_start,
+                   colours->inner_compressed_end);
   }
   else if (item->cur_hover_button == BUTTON_PREVIOUS)
   {
@@ -1302,24 +1499,24 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                    Y,
                    RECT_WIDTH/2,
                    OUTER_RADIUS,
-                   OUTER_START_PRELIGHT,
-                   OUTER_END_PRELIGHT);
+                   colours->outer_start_prelight,
+                   colours->outer_end_prelight);
 
     draw_gradient (cr,
                    X,
                    Y + 1,
                    RECT_WIDTH/2,
                    MIDDLE_RADIUS,
-                   MIDDLE_START_PRELIGHT,
-                   MIDDLE_END_PRELIGHT);
+                   colours->middle_start_prelight,
+                   colours->middle_end_prelight);
 
     draw_gradient (cr,
                    X,
                    Y + 2,
                    RECT_WIDTH/2,
                    MIDDLE_RADIUS,
-                   MIDDLE_START_PRELIGHT,
-                   MIDDLE_END_PRELIGHT);
+                   colours->middle_start_prelight,
+                   colours->middle_end_prelight);
   }
   else if (item->cur_hover_button == BUTTON_NEXT)
   {
@@ -1328,24 +1525,24 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                    Y,
                    RECT_WIDTH/2,
                    OUTER_RADIUS,
-                   OUTER_START_PRELIGHT,
-                   OUTER_END_PRELIGHT);
+                   colours->outer_start_prelight,
+                   colours->outer_end_prelight);
 
     draw_gradient (cr,
                    RECT_WIDTH / 2 + X,
                    Y + 1,
                    (RECT_WIDTH - 4.5)/2,
                    MIDDLE_RADIUS,
-                   MIDDLE_START_PRELIGHT,
-                   MIDDLE_END_PRELIGHT);
+                   colours->middle_start_prelight,
+                   colours->middle_end_prelight);
 
     draw_gradient (cr,
                    RECT_WIDTH / 2 + X,
                    Y + 2,
                    (RECT_WIDTH - 7)/2,
                    MIDDLE_RADIUS,
-                   MIDDLE_START_PRELIGHT,
-                   MIDDLE_END_PRELIGHT);
+                   colours->middle_start_prelight,
+                   colours->middle_end_prelight);
   }
 
   // play/pause shadow
@@ -1359,8 +1556,8 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                  X + RECT_WIDTH / 2.0f - 2.0f * OUTER_RADIUS - 5.5f - 1.0f,
                  Y - ((CIRCLE_RADIUS - OUTER_RADIUS)) - 1.0f,
                  CIRCLE_RADIUS + 1.0f,
-                 SHADOW_BUTTON,
-                 SHADOW_BUTTON);
+                 colours->shadow_button,
+                 colours->shadow_button);
 
     cairo_restore (cr);
   }
@@ -1372,15 +1569,15 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                  X + RECT_WIDTH / 2.0f - 2.0f * OUTER_RADIUS - 5.5f,
                  Y - ((CIRCLE_RADIUS - OUTER_RADIUS)) ,
                  CIRCLE_RADIUS,
-                 OUTER_PLAY_END,
-                 OUTER_PLAY_START);
+                 colours->outer_play_end,
+                 colours->outer_play_start);
 
     draw_circle (cr,
                  X + RECT_WIDTH / 2.0f - 2.0f * OUTER_RADIUS - 5.5f + 1.25f,
                  Y - ((CIRCLE_RADIUS - OUTER_RADIUS)) + 1.25f,
                  CIRCLE_RADIUS - 1.25,
-                 INNER_COMPRESSED_START,
-                 INNER_COMPRESSED_END);
+                 colours->inner_compressed_start,
+                 colours->inner_compressed_end);
   }
   else if (item->cur_hover_button == BUTTON_PLAYPAUSE)
   {
@@ -1389,15 +1586,15 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                  X + RECT_WIDTH / 2.0f - 2.0f * OUTER_RADIUS - 5.5f + 0.1,
                  Y - ((CIRCLE_RADIUS - OUTER_RADIUS)) + 0.1,
                  CIRCLE_RADIUS - 0.1,
-                 OUTER_PLAY_START_PRELIGHT,
-                 OUTER_PLAY_END_PRELIGHT);
+                 colours->outer_play_start_prelight,
+                 colours->outer_play_end_prelight);
 
     draw_circle (cr,
                  X + RECT_WIDTH / 2.0f - 2.0f * OUTER_RADIUS - 5.5f + 1.25f,
                  Y - ((CIRCLE_RADIUS - OUTER_RADIUS)) + 1.25f,
                  CIRCLE_RADIUS - 1.25,
-                 MIDDLE_START_PRELIGHT,
-                 MIDDLE_END_PRELIGHT);
+                 colours->middle_start_prelight,
+                 colours->middle_end_prelight);
   }
   else
   {
@@ -1405,137 +1602,51 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
                  X + RECT_WIDTH / 2.0f - 2.0f * OUTER_RADIUS - 5.5f,
                  Y - ((CIRCLE_RADIUS - OUTER_RADIUS)),
                  CIRCLE_RADIUS,
-                 OUTER_PLAY_START,
-                 OUTER_PLAY_END);
+                 colours->outer_play_start,
+                 colours->outer_play_end);
 
     draw_circle (cr,
                  X + RECT_WIDTH / 2.0f - 2.0f * OUTER_RADIUS - 5.5f + 1.25f,
                  Y - ((CIRCLE_RADIUS - OUTER_RADIUS)) + 1.25f,
                  CIRCLE_RADIUS - 1.25,
-                 MIDDLE_START,
-                 MIDDLE_END);
+                 colours->middle_start,
+                 colours->middle_end);
   }
 
   // draw previous-button drop-shadow
   if ((item->cur_pushed_button == BUTTON_PREVIOUS && item->keyboard_activated) ||
       item->cur_hover_button == BUTTON_PREVIOUS)
   {
-    _setup (&cr_surf, &surf, PREV_WIDTH+6, PREV_HEIGHT+6);
-    _mask_prev (cr_surf,
-                (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-                (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
-                TRI_WIDTH,
-                TRI_HEIGHT,
-                TRI_OFFSET);
-    _fill (cr_surf,
-           (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
-           (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (double) TRI_HEIGHT,
-           BUTTON_SHADOW_FOCUS,
-           BUTTON_SHADOW_FOCUS,
-           FALSE);
-    _surface_blur (surf, 3);
-    _finalize_repaint (cr, &cr_surf, &surf, abs_prev_x, PREV_Y + 0.5f, 3);
+    _paint_shadow (cr, GLYPH_PREVIOUS, PREV_WIDTH+6, PREV_HEIGHT+6, 3, colours->button_shadow_focus,
+                   abs_prev_x, PREV_Y + 0.5f, 3);
   }
   else
   {
-    _setup (&cr_surf, &surf, PREV_WIDTH, PREV_HEIGHT);
-    _mask_prev (cr_surf,
-                (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-                (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
-                TRI_WIDTH,
-                TRI_HEIGHT,
-                TRI_OFFSET);
-    _fill (cr_surf,
-           (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
-           (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (double) TRI_HEIGHT,
-           BUTTON_SHADOW,
-           BUTTON_SHADOW,
-           FALSE);
-    _surface_blur (surf, 1);
-    _finalize (cr, &cr_surf, &surf, abs_prev_x, PREV_Y + 1.0f);
+    _paint_shadow (cr, GLYPH_PREVIOUS, PREV_WIDTH, PREV_HEIGHT, 1, colours->button_shadow,
+                   abs_prev_x, PREV_Y + 1.0f, 1);
   }
 
   // draw previous-button
   _setup (&cr_surf, &surf, PREV_WIDTH, PREV_HEIGHT);
-  _mask_prev (cr_surf,
-              (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-              (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
-              TRI_WIDTH,
-              TRI_HEIGHT,
-              TRI_OFFSET);
-  _fill (cr_surf,
-       (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-       (PREV_HEIGHT - TRI_HEIGHT) / 2.0f,
-       (PREV_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-       (double) TRI_HEIGHT,
-       BUTTON_START,
-       BUTTON_END,
-       FALSE);
+  _draw_glyph (cr_surf, GLYPH_PREVIOUS, colours->button_start, colours->button_end);
   _finalize (cr, &cr_surf, &surf, abs_prev_x, PREV_Y);
 
   // draw next-button drop-shadow
   if ((item->cur_pushed_button == BUTTON_NEXT && item->keyboard_activated) ||
       item->cur_hover_button == BUTTON_NEXT)
   {
-    _setup (&cr_surf, &surf, NEXT_WIDTH+6, NEXT_HEIGHT+6);
-    _mask_next (cr_surf,
-                (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-                (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
-                TRI_WIDTH,
-                TRI_HEIGHT,
-                TRI_OFFSET);
-    _fill (cr_surf,
-           (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
-           (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (double) TRI_HEIGHT,
-           BUTTON_SHADOW_FOCUS,
-           BUTTON_SHADOW_FOCUS,
-           FALSE);
-    _surface_blur (surf, 3);
-    _finalize_repaint (cr, &cr_surf, &surf, abs_next_x, NEXT_Y + 0.5f, 3);
+    _paint_shadow (cr, GLYPH_NEXT, NEXT_WIDTH+6, NEXT_HEIGHT+6, 3, colours->button_shadow_focus,
+                   abs_next_x, NEXT_Y + 0.5f, 3);
   }
   else
   {
-    _setup (&cr_surf, &surf, NEXT_WIDTH, NEXT_HEIGHT);
-    _mask_next (cr_surf,
-                (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-                (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
-                TRI_WIDTH,
-                TRI_HEIGHT,
-                TRI_OFFSET);
-    _fill (cr_surf,
-           (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
-           (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-           (double) TRI_HEIGHT,
-           BUTTON_SHADOW,
-           BUTTON_SHADOW,
-           FALSE);
-    _surface_blur (surf, 1);
-    _finalize (cr, &cr_surf, &surf, abs_next_x, NEXT_Y + 1.0f);
+    _paint_shadow (cr, GLYPH_NEXT, NEXT_WIDTH, NEXT_HEIGHT, 1, colours->button_shadow,
+                   abs_next_x, NEXT_Y + 1.0f, 1);
   }
 
   // draw next-button
   _setup (&cr_surf, &surf, NEXT_WIDTH, NEXT_HEIGHT);
-  _mask_next (cr_surf,
-              (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-              (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
-              TRI_WIDTH,
-              TRI_HEIGHT,
-              TRI_OFFSET);
-  _fill (cr_surf,
-         (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-         (NEXT_HEIGHT - TRI_HEIGHT) / 2.0f,
-         (NEXT_WIDTH - (2.0f * TRI_WIDTH - TRI_OFFSET)) / 2.0f,
-         (double) TRI_HEIGHT,
-         BUTTON_START,
-         BUTTON_END,
-         FALSE);
+  _draw_glyph (cr_surf, GLYPH_NEXT, colours->button_start, colours->button_end);
   _finalize (cr, &cr_surf, &surf, abs_next_x, NEXT_Y);
 
   // draw pause-button drop-shadow
@@ -1545,61 +1656,18 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
         (item->cur_hover_button == BUTTON_NONE || item->cur_hover_button == BUTTON_PLAYPAUSE) &&
         (item->cur_pushed_button == BUTTON_NONE || item->cur_pushed_button == BUTTON_PLAYPAUSE))
     {
-      _setup (&cr_surf, &surf, PAUSE_WIDTH+6, PAUSE_HEIGHT+6);
-      _mask_pause (cr_surf,
-                   (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-                   (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
-                   BAR_WIDTH,
-                   BAR_HEIGHT - 2.0f * BAR_WIDTH,
-                   BAR_OFFSET);
-      _fill (cr_surf,
-             (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-             (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
-             (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-             (double) BAR_HEIGHT,
-             BUTTON_SHADOW_FOCUS,
-             BUTTON_SHADOW_FOCUS,
-             TRUE);
-      _surface_blur (surf, 3);
-      _finalize_repaint (cr, &cr_surf, &surf, abs_pause_x, PAUSE_Y + 0.5f, 3);
+      _paint_shadow (cr, GLYPH_PAUSE, PAUSE_WIDTH+6, PAUSE_HEIGHT+6, 3, colours->button_shadow_focus,
+                     abs_pause_x, PAUSE_Y + 0.5f, 3);
     }
     else
     {
-      _setup (&cr_surf, &surf, PAUSE_WIDTH, PAUSE_HEIGHT);
-      _mask_pause (cr_surf,
-                   (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-                   (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
-                   BAR_WIDTH,
-                   BAR_HEIGHT - 2.0f * BAR_WIDTH,
-                   BAR_OFFSET);
-      _fill (cr_surf,
-             (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-             (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
-             (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-             (double) BAR_HEIGHT,
-             BUTTON_SHADOW,
-             BUTTON_SHADOW,
-             TRUE);
-      _surface_blur (surf, 1);
-      _finalize (cr, &cr_surf, &surf, abs_pause_x, PAUSE_Y + 1.0f);
+      _paint_shadow (cr, GLYPH_PAUSE, PAUSE_WIDTH, PAUSE_HEIGHT, 1, colours->button_shadow,
+                     abs_pause_x, PAUSE_Y + 1.0f, 1);
     }
 
     // draw pause-button
     _setup (&cr_surf, &surf, PAUSE_WIDTH, PAUSE_HEIGHT);
-    _mask_pause (cr_surf,
-                 (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-                 (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
-                 BAR_WIDTH,
-                 BAR_HEIGHT - 2.0f * BAR_WIDTH,
-                 BAR_OFFSET);
-    _fill (cr_surf,
-           (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-           (PAUSE_HEIGHT - BAR_HEIGHT) / 2.0f,
-           (PAUSE_WIDTH - (2.0f * BAR_WIDTH + BAR_OFFSET)) / 2.0f,
-           (double) BAR_HEIGHT,
-           BUTTON_START,
-           BUTTON_END,
-           TRUE);
+    _draw_glyph (cr_surf, GLYPH_PAUSE, colours->button_start, colours->button_end);
     _finalize (cr, &cr_surf, &surf, abs_pause_x, PAUSE_Y);
   }
   else if (item->current_state == STATE_PAUSED)
@@ -1608,41 +1676,13 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
         (item->cur_hover_button == BUTTON_NONE || item->cur_hover_button == BUTTON_PLAYPAUSE) &&
         (item->cur_pushed_button == BUTTON_NONE || item->cur_pushed_button == BUTTON_PLAYPAUSE))
     {
-      _setup (&cr_surf, &surf, PLAY_WIDTH+6, PLAY_HEIGHT+6);
-      _mask_play (cr_surf,
-                  PLAY_PADDING,
-                  PLAY_PADDING,
-                  PLAY_WIDTH - (2*PLAY_PADDING),
-                  PLAY_HEIGHT - (2*PLAY_PADDING));
-      _fill (cr_surf,
-             PLAY_PADDING,
-             PLAY_PADDING,
-             PLAY_WIDTH - (2*PLAY_PADDING),
-             PLAY_HEIGHT - (2*PLAY_PADDING),
-             BUTTON_SHADOW_FOCUS,
-             BUTTON_SHADOW_FOCUS,
-             FALSE);
-      _surface_blur (surf, 3);
-      _finalize_repaint (cr, &cr_surf, &surf, abs_pause_x-0.5f, PAUSE_Y + 0.5f, 3);
+      _paint_shadow (cr, GLYPH_PLAY, PLAY_WIDTH+6, PLAY_HEIGHT+6, 3, colours->button_shadow_focus,
+                     abs_pause_x-0.5f, PAUSE_Y + 0.5f, 3);
     }
     else
     {
-      _setup (&cr_surf, &surf, PLAY_WIDTH, PLAY_HEIGHT);
-      _mask_play (cr_surf,
-                  PLAY_PADDING,
-                  PLAY_PADDING,
-                  PLAY_WIDTH - (2*PLAY_PADDING),
-                  PLAY_HEIGHT - (2*PLAY_PADDING));
-      _fill (cr_surf,
-             PLAY_PADDING,
-             PLAY_PADDING,
-             PLAY_WIDTH - (2*PLAY_PADDING),
-             PLAY_HEIGHT - (2*PLAY_PADDING),
-             BUTTON_SHADOW,
-             BUTTON_SHADOW,
-             FALSE);
-      _surface_blur (surf, 1);
-      _finalize (cr, &cr_surf, &surf, abs_pause_x-0.75f, PAUSE_Y + 1.0f);
+      _paint_shadow (cr, GLYPH_PLAY, PLAY_WIDTH, PLAY_HEIGHT, 1, colours->button_shadow,
+                     abs_pause_x-0.75f, PAUSE_Y + 1.0f, 1);
     }
 
     // draw play-button
@@ -1650,22 +1690,107 @@ ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
     cairo_set_line_width (cr, 10.5);
     cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
     cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
-    _mask_play (cr_surf,
-                PLAY_PADDING,
-                PLAY_PADDING,
-                PLAY_WIDTH - (2*PLAY_PADDING),
-                PLAY_HEIGHT - (2*PLAY_PADDING));
-    _fill (cr_surf,
-           PLAY_PADDING,
-           PLAY_PADDING,
-           PLAY_WIDTH - (2*PLAY_PADDING),
-           PLAY_HEIGHT - (2*PLAY_PADDING),
-           BUTTON_START,
-           BUTTON_END,
-           FALSE);
+    _draw_glyph (cr_surf, GLYPH_PLAY, colours->button_start, colours->button_end);
     _finalize (cr, &cr_surf, &surf, abs_pause_x-0.5f, PAUSE_Y);
   }
-  else if (item->current_state == STATE_LAUNCHING)
+}
+
+static guint
+ido_playback_menu_item_artwork_key (IdoPlaybackMenuItem *item,
+                                    gint                 scale)
+{
+  return item->current_state |
+         item->cur_pushed_button << 2 |
+         item->cur_hover_button << 4 |
+         item->has_focus << 6 |
+         item->keyboard_activated << 7 |
+         scale << 8;
+}
+
+static void
+ido_playback_menu_item_clear_artwork (IdoPlaybackMenuItem *item)
+{
+  gint i;
+
+  for (i = 0; i < ARTWORK_CACHE_SIZE; i++)
+    g_clear_pointer (&item->artwork[i].surface, cairo_surface_destroy);
+}
+
+/*
+ * Returns the artwork for the current state, rendering it into a new
+ * surface only if it isn't cached yet. The least recently used entry
+ * makes room for it when the cache is full.
+ */
+static cairo_surface_t *
+ido_playback_menu_item_get_artwork (IdoPlaybackMenuItem *item,
+                                    gint                 scale)
+{
+  ArtworkEntry *entry = NULL;
+  guint key;
+  cairo_t *cr;
+  gint i;
+
+  key = ido_playback_menu_item_artwork_key (item, scale);
+
+  for (i = 0; i < ARTWORK_CACHE_SIZE; i++)
+    {
+      ArtworkEntry *candidate = &item->artwork[i];
+
+      if (candidate->surface && candidate->key == key)
+        {
+          candidate->last_used = ++item->artwork_age;
+          return candidate->surface;
+        }
+
+      if (entry == NULL || candidate->surface == NULL ||
+          (entry->surface && candidate->last_used < entry->last_used))
+        entry = candidate;
+    }
+
+  g_clear_pointer (&entry->surface, cairo_surface_destroy);
+
+  entry->surface = gdk_window_create_similar_image_surface (gtk_widget_get_window (GTK_WIDGET (item)),
+                                                            CAIRO_FORMAT_ARGB32,
+                                                            ARTWORK_WIDTH, ARTWORK_HEIGHT,
+                                                            scale);
+  entry->key = key;
+  entry->last_used = ++item->artwork_age;
+
+  cr = cairo_create (entry->surface);
+  cairo_translate (cr, 0, ARTWORK_TOP);
+  ido_playback_menu_item_render_artwork (item, cr, ARTWORK_LEFT);
+  cairo_destroy (cr);
+
+  return entry->surface;
+}
+
+static gboolean
+ido_playback_menu_item_draw (GtkWidget* button, cairo_t *cr)
+{
+  IdoPlaybackMenuItem *item = IDO_PLAYBACK_MENU_ITEM (button);
+  GtkAllocation alloc;
+  GdkRectangle clip;
+  gint X;
+
+  g_return_val_if_fail(IDO_IS_PLAYBACK_MENU_ITEM (button), FALSE);
+  g_return_val_if_fail(cr != NULL, FALSE);
+
+  /* hovering and pressing only damage the buttons that changed */
+  if (!gdk_cairo_get_clip_rectangle (cr, &clip))
+    return FALSE;
+
+  gtk_widget_get_allocation (button, &alloc);
+  X = ido_playback_menu_item_get_x (button);
+
+  /* X is whole pixels, so the blit lands exactly where the artwork
+   * would have been drawn directly */
+  cairo_set_source_surface (cr,
+                            ido_playback_menu_item_get_artwork (item, gtk_widget_get_scale_factor (button)),
+                            X - ARTWORK_LEFT, -ARTWORK_TOP);
+  cairo_rectangle (cr, clip.x, clip.y, clip.width, clip.height);
+  cairo_fill (cr);
+
+  if (item->current_state == STATE_LAUNCHING)
   {
         gtk_render_activity (gtk_widget_get_style_context (button), cr, (alloc.width / 2) - 15, (alloc.height / 2) - 15, 30, 30);
   }
@@ -34,4 +34,8 @@ GType                   ido_playback_menu_item_get_type                 (void);
 GtkMenuItem *           ido_playback_menu_item_new_from_model           (GMenuItem    *item,
                                                                          GActionGroup *actions);
 
+void                    ido_playback_menu_item_update_from_model        (GtkMenuItem  *menuitem,
+                                                                         GMenuItem    *item,
+                                                                         GActionGroup *actions);
+
 #endif
@@ -21,10 +21,58 @@
 #include "idobasicmenuitem.h"
 #include "idoactionhelper.h"
 
-static void onActivate (GtkMenuItem *item, gpointer pData)
+/**
+ * ido_progress_menu_item_update_from_model:
+ * @pItem: a menuitem built by ido_progress_menu_item_new_from_model()
+ * @pMenuItem: (nullable): the corresponding menuitem
+ * @pActionGroup: (nullable): action group to tell when @pItem is activated
+ *
+ * Applies the attributes and action of @pMenuItem to @pItem. If
+ * @pMenuItem is %NULL, the item is left as blank as a new one, without
+ * an action binding.
+ */
+void ido_progress_menu_item_update_from_model (GtkMenuItem *pItem, GMenuItem *pMenuItem, GActionGroup *pActionGroup)
 {
-    IdoActionHelper *pHelper = pData;
-    ido_action_helper_activate (pHelper);
+    g_return_if_fail (IDO_IS_BASIC_MENU_ITEM (pItem));
+
+    IdoBasicMenuItem *pBasicMenuItem = IDO_BASIC_MENU_ITEM (pItem);
+
+    if (pMenuItem == NULL)
+    {
+        ido_basic_menu_item_clear (pBasicMenuItem);
+
+        return;
+    }
+
+    gchar *sLabel = NULL;
+    g_menu_item_get_attribute (pMenuItem, "label", "s", &sLabel);
+    ido_basic_menu_item_set_text (pBasicMenuItem, sLabel);
+    g_free (sLabel);
+
+    GVariant *pIconVariant = g_menu_item_get_attribute_value (pMenuItem, "icon", NULL);
+    GIcon *pIcon = NULL;
+
+    if (pIconVariant)
+    {
+        pIcon = g_icon_deserialize (pIconVariant);
+        g_variant_unref (pIconVariant);
+    }
+
+    ido_basic_menu_item_set_icon (pBasicMenuItem, pIcon);
+    g_clear_object (&pIcon);
+
+    guint16 nProgress = 0;
+    gchar *sProgress = NULL;
+
+    if (g_menu_item_get_attribute (pMenuItem, "x-ayatana-progress", "q", &nProgress))
+    {
+        sProgress = g_strdup_printf ("%"G_GUINT16_FORMAT"%%", nProgress);
+    }
+
+    ido_basic_menu_item_set_secondary_text (pBasicMenuItem, sProgress);
+    g_free (sProgress);
+
+    ido_basic_menu_item_bind_action (pBasicMenuItem, pMenuItem, pActionGroup);
 }
 
 /**
@@ -40,51 +88,13 @@ static void onActivate (GtkMenuItem *item, gpointer pData)
  */
 GtkMenuItem *ido_progress_menu_item_new_from_model (GMenuItem *pMenuItem, GActionGroup *pActionGroup)
 {
-    IdoBasicMenuItem *pBasicMenuItem = NULL;
-    gchar *sLabel = NULL;
+    GtkWidget *pItem = NULL;
 
-    if (g_menu_item_get_attribute (pMenuItem, "label", "s", &sLabel))
+    if (g_menu_item_get_attribute (pMenuItem, "label", "s", NULL))
     {
-        pBasicMenuItem = IDO_BASIC_MENU_ITEM (g_object_new (IDO_TYPE_BASIC_MENU_ITEM, "text", sLabel, NULL));
-        g_free (sLabel);
-
-        GVariant *pIconVariant = g_menu_item_get_attribute_value (pMenuItem, "icon", NULL);
-
-        if (pIconVariant)
-        {
-            GIcon *pIcon = g_icon_deserialize (pIconVariant);
-            ido_basic_menu_item_set_icon (pBasicMenuItem, pIcon);
-            g_object_unref (pIcon);
-            g_variant_unref (pIconVariant);
-        }
-
-        guint16 nProgress = 0;
-
-        if (g_menu_item_get_attribute (pMenuItem, "x-ayatana-progress", "q", &nProgress))
-        {
-            gchar *sProgress = g_strdup_printf ("%"G_GUINT16_FORMAT"%%", nProgress);
-            ido_basic_menu_item_set_secondary_text (pBasicMenuItem, sProgress);
-            g_free (sProgress);
-        }
-
-        gchar *sAction = NULL;
-
-        if (g_menu_item_get_attribute (pMenuItem, "action", "s", &sAction))
-        {
-            GVariant *pTarget = g_menu_item_get_attribute_value (pMenuItem, "target", NULL);
-            IdoActionHelper *pHelper = ido_action_helper_new (GTK_WIDGET (pBasicMenuItem), pActionGroup, sAction, pTarget);
-            g_signal_connect_object (pBasicMenuItem, "activate", G_CALLBACK (onActivate), pHelper, 0);
-            g_signal_connect_swapped (pBasicMenuItem, "destroy", G_CALLBACK (g_object_unref), pHelper);
-
-            if (pTarget)
-            {
-                g_variant_unref (pTarget);
-            }
-
-            g_free (sAction);
-        }
+        pItem = ido_basic_menu_item_new ();
+        ido_progress_menu_item_update_from_model (GTK_MENU_ITEM (pItem), pMenuItem, pActionGroup);
     }
 
-    return GTK_MENU_ITEM (pBasicMenuItem);
+    return GTK_MENU_ITEM (pItem);
 }
-
@@ -25,4 +25,8 @@
 GtkMenuItem * ido_progress_menu_item_new_from_model (GMenuItem    * menuitem,
                                                      GActionGroup * actions);
 
+void ido_progress_menu_item_update_from_model (GtkMenuItem  * item,
+                                               GMenuItem    * menuitem,
+                                               GActionGroup * actions);
+
 #endif
@@ -42,7 +42,6 @@ typedef struct
     GtkWidget *pLabel;
     GtkWidget *pButton;
     gboolean bClosePressed;
-    IdoActionHelper *pHelper;
 
 } IdoRemovableMenuItemPrivate;
 
@@ -221,9 +220,11 @@ static gboolean onButtonRelease(GtkWidget *pWidget, GdkEventButton *pEventButton
 
                 g_list_free(lMenuItems);
 
-                if (pPrivate->pHelper)
+                IdoActionHelper *pHelper = ido_action_helper_get_for_widget(GTK_WIDGET(self));
+
+                if (pHelper)
                 {
-                    ido_action_helper_activate(pPrivate->pHelper);
+                    ido_action_helper_activate(pHelper);
                 }
                 else
                 {
@@ -356,7 +357,6 @@ static void ido_removable_menu_item_init(IdoRemovableMenuItem *self)
 {
     IdoRemovableMenuItemPrivate *pPrivate = ido_removable_menu_item_get_instance_private(self);
     pPrivate->bClosePressed = FALSE;
-    pPrivate->pHelper = NULL;
     pPrivate->pImage = gtk_image_new();
 
     gtk_widget_set_halign(pPrivate->pImage, GTK_ALIGN_START);
@@ -394,7 +394,7 @@ void idoRemovableMenuItemSetIcon(IdoRemovableMenuItem *self, GIcon *pIcon)
 {
     IdoRemovableMenuItemPrivate *pPrivate = ido_removable_menu_item_get_instance_private(self);
 
-    if (pPrivate->pIcon != pIcon)
+    if (pPrivate->pIcon != pIcon && !(pPrivate->pIcon && pIcon && g_icon_equal(pPrivate->pIcon, pIcon)))
     {
         if (pPrivate->pIcon)
         {
@@ -430,47 +430,59 @@ void idoRemovableMenuItemSetText(IdoRemovableMenuItem *self, const char *sText)
     }
 }
 
-GtkMenuItem *ido_removable_menu_item_new_from_model(GMenuItem *pMenuItem, GActionGroup *pActionGroup)
+void ido_removable_menu_item_update_from_model(GtkMenuItem *pItem, GMenuItem *pMenuItem, GActionGroup *pActionGroup)
 {
-    GtkWidget *pItem = ido_removable_menu_item_new();
-    IdoRemovableMenuItemPrivate *pPrivate = ido_removable_menu_item_get_instance_private(IDO_REMOVABLE_MENU_ITEM(pItem));
-    gboolean bUseMarkup = FALSE;
-    g_menu_item_get_attribute(pMenuItem, "x-ayatana-use-markup", "b", &bUseMarkup);
-    idoRemovableMenuItemUseMarkup(IDO_REMOVABLE_MENU_ITEM(pItem), bUseMarkup);
-
-    gchar *sLabel;
+    g_return_if_fail(IDO_IS_REMOVABLE_MENU_ITEM(pItem));
 
-    if (g_menu_item_get_attribute(pMenuItem, "label", "s", &sLabel))
+    if (!pMenuItem)
     {
-        idoRemovableMenuItemSetText(IDO_REMOVABLE_MENU_ITEM(pItem), sLabel);
-        g_free(sLabel);
+        ido_action_helper_bind_widget(GTK_WIDGET(pItem), NULL, NULL, NULL);
+        idoRemovableMenuItemUseMarkup(IDO_REMOVABLE_MENU_ITEM(pItem), FALSE);
+        idoRemovableMenuItemSetText(IDO_REMOVABLE_MENU_ITEM(pItem), NULL);
+        idoRemovableMenuItemSetIcon(IDO_REMOVABLE_MENU_ITEM(pItem), NULL);
+
+        return;
     }
 
+    IdoRemovableMenuItem *self = IDO_REMOVABLE_MENU_ITEM(pItem);
+    gboolean bUseMarkup = FALSE;
+    g_menu_item_get_attribute(pMenuItem, "x-ayatana-use-markup", "b", &bUseMarkup);
+    idoRemovableMenuItemUseMarkup(self, bUseMarkup);
+
+    gchar *sLabel = NULL;
+    g_menu_item_get_attribute(pMenuItem, "label", "s", &sLabel);
+    idoRemovableMenuItemSetText(self, sLabel);
+    g_free(sLabel);
+
     GVariant *sIcon = g_menu_item_get_attribute_value(pMenuItem, "icon", NULL);
+    GIcon *pIcon = NULL;
 
     if (sIcon)
     {
-        GIcon *pIcon = g_icon_deserialize(sIcon);
-        idoRemovableMenuItemSetIcon(IDO_REMOVABLE_MENU_ITEM(pItem), pIcon);
-        g_object_unref(pIcon);
+        pIcon = g_icon_deserialize(sIcon);
         g_variant_unref(sIcon);
     }
 
-    gchar *sAction;
+    idoRemovableMenuItemSetIcon(self, pIcon);
+    g_clear_object(&pIcon);
+
+    gchar *sAction = NULL;
+    g_menu_item_get_attribute(pMenuItem, "action", "s", &sAction);
+    GVariant *sTarget = g_menu_item_get_attribute_value(pMenuItem, "target", NULL);
+    ido_action_helper_bind_widget(GTK_WIDGET(pItem), pActionGroup, sAction, sTarget);
 
-    if (g_menu_item_get_attribute(pMenuItem, "action", "s", &sAction))
+    if (sTarget)
     {
-        GVariant *sTarget = g_menu_item_get_attribute_value(pMenuItem, "target", NULL);
-        pPrivate->pHelper = ido_action_helper_new(pItem, pActionGroup, sAction, sTarget);
-        g_signal_connect_swapped(pItem, "destroy", G_CALLBACK (g_object_unref), pPrivate->pHelper);
+        g_variant_unref(sTarget);
+    }
 
-        if (sTarget)
-        {
-            g_variant_unref(sTarget);
-        }
+    g_free(sAction);
+}
 
-        g_free(sAction);
-    }
+GtkMenuItem *ido_removable_menu_item_new_from_model(GMenuItem *pMenuItem, GActionGroup *pActionGroup)
+{
+    GtkWidget *pItem = ido_removable_menu_item_new();
+    ido_removable_menu_item_update_from_model(GTK_MENU_ITEM(pItem), pMenuItem, pActionGroup);
 
     return GTK_MENU_ITEM(pItem);
 }
@@ -31,6 +31,7 @@ void idoRemovableMenuItemSetIconFromFile(IdoRemovableMenuItem *self, const char
 void idoRemovableMenuItemSetText(IdoRemovableMenuItem *self, const char *sText);
 void idoRemovableMenuItemUseMarkup(IdoRemovableMenuItem *self, gboolean bUse);
 GtkMenuItem* ido_removable_menu_item_new_from_model(GMenuItem *pMenuItem, GActionGroup *pActionGroup);
+void ido_removable_menu_item_update_from_model(GtkMenuItem *pItem, GMenuItem *pMenuItem, GActionGroup *pActionGroup);
 
 G_END_DECLS
 
@@ -63,6 +63,7 @@ static void     update_packing                             (IdoScaleMenuItem
                                                             IdoScaleMenuItemStyle  style);
 static void     default_primary_clicked_handler            (IdoScaleMenuItem      *self);
 static void     default_secondary_clicked_handler          (IdoScaleMenuItem      *self);
+static void     ido_scale_menu_item_flush_value            (IdoScaleMenuItem      *self);
 
 typedef struct {
   GtkWidget            *scale;
@@ -79,6 +80,12 @@ typedef struct {
   gboolean              ignore_value_changed;
   gboolean              has_focus;
   gboolean              bCloseOnChange;
+  gint                  change_rate;
+  gboolean              has_pending_value;
+  gdouble               pending_value;
+  gint64                last_change_time;
+  guint                 throttle_source_id;
+  guint                 throttle_tick_id;
 } IdoScaleMenuItemPrivate;
 
 enum {
@@ -95,7 +102,8 @@ enum {
   PROP_ADJUSTMENT,
   PROP_REVERSE_SCROLL_EVENTS,
   PROP_STYLE,
-  PROP_RANGE_STYLE
+  PROP_RANGE_STYLE,
+  PROP_CHANGE_RATE
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -201,6 +209,29 @@ ido_scale_menu_item_constructed (GObject *object)
   gtk_widget_add_events (GTK_WIDGET(self), GDK_SCROLL_MASK);
 }
 
+static void
+ido_scale_menu_item_dispose (GObject *object)
+{
+  IdoScaleMenuItem *self = IDO_SCALE_MENU_ITEM (object);
+  IdoScaleMenuItemPrivate *priv = ido_scale_menu_item_get_instance_private (self);
+
+  if (priv->throttle_source_id)
+    {
+      g_source_remove (priv->throttle_source_id);
+      priv->throttle_source_id = 0;
+    }
+
+  if (priv->throttle_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->throttle_tick_id);
+      priv->throttle_tick_id = 0;
+    }
+
+  priv->has_pending_value = FALSE;
+
+  G_OBJECT_CLASS (ido_scale_menu_item_parent_class)->dispose (object);
+}
+
 static void
 ido_scale_menu_item_class_init (IdoScaleMenuItemClass *item_class)
 {
@@ -221,6 +252,7 @@ ido_scale_menu_item_class_init (IdoScaleMenuItemClass *item_class)
   widget_class->parent_set           = ido_scale_menu_item_parent_set;
 
   gobject_class->constructed  = ido_scale_menu_item_constructed;
+  gobject_class->dispose      = ido_scale_menu_item_dispose;
   gobject_class->set_property = ido_scale_menu_item_set_property;
   gobject_class->get_property = ido_scale_menu_item_get_property;
 
@@ -258,6 +290,23 @@ ido_scale_menu_item_class_init (IdoScaleMenuItemClass *item_class)
                                                          TRUE,
                                                          G_PARAM_READWRITE));
 
+  /**
+   * IdoScaleMenuItem:change-rate:
+   *
+   * Limits how often a value the user picks is sent to the item's
+   * action as a state change, in changes per second. 0 sends every
+   * change and %IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME sends at most one
+   * change per frame. The last value is always sent when the slider is
+   * released. Can be set with the "change-rate" menu model attribute.
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_CHANGE_RATE,
+                                   g_param_spec_int ("change-rate",
+                                                     "Change rate",
+                                                     "Maximum number of action state changes per second",
+                                                     IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME, G_MAXINT, 0,
+                                                     G_PARAM_READWRITE));
+
   /**
    * IdoScaleMenuItem::slider-grabbed:
    * @menuitem: The #IdoScaleMenuItem emitting the signal.
@@ -409,6 +458,10 @@ ido_scale_menu_item_set_property (GObject         *object,
       priv->range_style = g_value_get_enum (value);
       break;
 
+    case PROP_CHANGE_RATE:
+      ido_scale_menu_item_set_change_rate (menu_item, g_value_get_int (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -440,6 +493,10 @@ ido_scale_menu_item_get_property (GObject         *object,
       g_value_set_enum (value, priv->range_style);
       break;
 
+    case PROP_CHANGE_RATE:
+      g_value_set_int (value, priv->change_rate);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -573,6 +630,9 @@ ido_scale_menu_item_button_release_event (GtkWidget *menuitem,
       g_signal_emit (menuitem, signals[SLIDER_RELEASED], 0);
     }
 
+  /* don't leave the action behind the slider */
+  ido_scale_menu_item_flush_value (item);
+
   return TRUE;
 }
 
@@ -824,6 +884,27 @@ ido_scale_menu_item_get_secondary_image (IdoScaleMenuItem *menuitem)
   return priv->secondary_image;
 }
 
+static void
+image_set_gicon (GtkImage *image,
+                 GIcon    *icon)
+{
+  GIcon *current = NULL;
+
+  if (gtk_image_get_storage_type (image) == GTK_IMAGE_GICON)
+    gtk_image_get_gicon (image, &current, NULL);
+
+  if (icon == NULL && gtk_image_get_storage_type (image) == GTK_IMAGE_EMPTY)
+    return;
+
+  if (icon && current && g_icon_equal (icon, current))
+    return;
+
+  if (icon)
+    gtk_image_set_from_gicon (image, icon, GTK_ICON_SIZE_MENU);
+  else
+    gtk_image_clear (image);
+}
+
 /**
  * ido_scale_menu_item_set_icons:
  * @item: a #IdoScaleMenuItem
@@ -844,15 +925,8 @@ ido_scale_menu_item_set_icons (IdoScaleMenuItem *item,
   primary = ido_scale_menu_item_get_primary_image (item);
   secondary = ido_scale_menu_item_get_secondary_image (item);
 
-  if (primary_icon)
-    gtk_image_set_from_gicon (GTK_IMAGE (primary), primary_icon, GTK_ICON_SIZE_MENU);
-  else
-    gtk_image_clear (GTK_IMAGE (primary));
-
-  if (secondary_icon)
-    gtk_image_set_from_gicon (GTK_IMAGE (secondary), secondary_icon, GTK_ICON_SIZE_MENU);
-  else
-    gtk_image_clear (GTK_IMAGE (secondary));
+  image_set_gicon (GTK_IMAGE (primary), primary_icon);
+  image_set_gicon (GTK_IMAGE (secondary), secondary_icon);
 }
 
 /**
@@ -1033,14 +1107,151 @@ ido_scale_menu_item_state_changed (IdoActionHelper *helper,
   ido_scale_menu_item_set_value (IDO_SCALE_MENU_ITEM (menuitem), g_variant_get_double (state));
 }
 
+/*
+ * Sends the last value the user picked to the item's action, if it
+ * wasn't sent yet.
+ */
 static void
-ido_scale_menu_item_value_changed (GtkScale *scale,
-                                   gdouble   value,
-                                   gpointer  user_data)
+ido_scale_menu_item_flush_value (IdoScaleMenuItem *self)
 {
+  IdoScaleMenuItemPrivate *priv = ido_scale_menu_item_get_instance_private (self);
+  IdoActionHelper *helper;
+
+  if (priv->throttle_source_id)
+    {
+      g_source_remove (priv->throttle_source_id);
+      priv->throttle_source_id = 0;
+    }
+
+  if (priv->throttle_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->throttle_tick_id);
+      priv->throttle_tick_id = 0;
+    }
+
+  if (!priv->has_pending_value)
+    return;
+
+  priv->has_pending_value = FALSE;
+  priv->last_change_time = g_get_monotonic_time ();
+
+  helper = ido_action_helper_get_for_widget (GTK_WIDGET (self));
+  if (helper)
+    ido_action_helper_change_action_state (helper, g_variant_new_double (priv->pending_value));
+}
+
+static gboolean
+ido_scale_menu_item_throttle_timeout (gpointer user_data)
+{
+  IdoScaleMenuItem *self = user_data;
+  IdoScaleMenuItemPrivate *priv = ido_scale_menu_item_get_instance_private (self);
+
+  priv->throttle_source_id = 0;
+  ido_scale_menu_item_flush_value (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+ido_scale_menu_item_throttle_tick (GtkWidget     *widget,
+                                   GdkFrameClock *frame_clock,
+                                   gpointer       user_data)
+{
+  IdoScaleMenuItem *self = IDO_SCALE_MENU_ITEM (widget);
+  IdoScaleMenuItemPrivate *priv = ido_scale_menu_item_get_instance_private (self);
+
+  priv->throttle_tick_id = 0;
+  ido_scale_menu_item_flush_value (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ido_scale_menu_item_value_changed (IdoScaleMenuItem *self,
+                                   gdouble           value,
+                                   gpointer          user_data)
+{
+  IdoScaleMenuItemPrivate *priv = ido_scale_menu_item_get_instance_private (self);
   IdoActionHelper *helper = user_data;
+  gint64 interval;
+  gint64 elapsed;
+
+  if (priv->change_rate == 0)
+    {
+      ido_action_helper_change_action_state (helper, g_variant_new_double (value));
+      return;
+    }
 
-  ido_action_helper_change_action_state (helper, g_variant_new_double (value));
+  priv->pending_value = value;
+  priv->has_pending_value = TRUE;
+
+  /* a flush is already scheduled and will pick up the new value */
+  if (priv->throttle_source_id || priv->throttle_tick_id)
+    return;
+
+  if (priv->change_rate == IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME)
+    {
+      priv->throttle_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                             ido_scale_menu_item_throttle_tick,
+                                                             NULL, NULL);
+      return;
+    }
+
+  interval = G_USEC_PER_SEC / priv->change_rate;
+  elapsed = g_get_monotonic_time () - priv->last_change_time;
+
+  if (elapsed >= interval)
+    ido_scale_menu_item_flush_value (self);
+  else
+    priv->throttle_source_id = g_timeout_add ((interval - elapsed + 999) / 1000,
+                                              ido_scale_menu_item_throttle_timeout, self);
+}
+
+/**
+ * ido_scale_menu_item_set_change_rate:
+ * @menuitem: The #IdoScaleMenuItem
+ * @rate: the maximum number of state changes per second, 0 for no
+ *   limit, or %IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME
+ *
+ * Sets #IdoScaleMenuItem:change-rate. A value that is held back by the
+ * previous rate is sent right away.
+ */
+void
+ido_scale_menu_item_set_change_rate (IdoScaleMenuItem *menuitem,
+                                     gint              rate)
+{
+  IdoScaleMenuItemPrivate *priv;
+
+  g_return_if_fail (IDO_IS_SCALE_MENU_ITEM (menuitem));
+  g_return_if_fail (rate >= IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME);
+
+  priv = ido_scale_menu_item_get_instance_private (menuitem);
+
+  if (priv->change_rate != rate)
+    {
+      ido_scale_menu_item_flush_value (menuitem);
+      priv->change_rate = rate;
+      g_object_notify (G_OBJECT (menuitem), "change-rate");
+    }
+}
+
+/**
+ * ido_scale_menu_item_get_change_rate:
+ * @menuitem: The #IdoScaleMenuItem
+ *
+ * Returns: the maximum number of action state changes per second, 0 if
+ * they aren't limited, or %IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME
+ */
+gint
+ido_scale_menu_item_get_change_rate (IdoScaleMenuItem *menuitem)
+{
+  IdoScaleMenuItemPrivate *priv;
+
+  g_return_val_if_fail (IDO_IS_SCALE_MENU_ITEM (menuitem), 0);
+
+  priv = ido_scale_menu_item_get_instance_private (menuitem);
+
+  return priv->change_rate;
 }
 
 static GIcon *
@@ -1062,51 +1273,84 @@ static gchar* onFormatValue (GtkScale *pScale, gdouble fValue)
     return sValue;
 }
 /**
- * ido_scale_menu_item_new_from_model:
+ * ido_scale_menu_item_update_from_model:
+ * @item: an #IdoScaleMenuItem
+ * @menuitem: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menuitem's action
  *
- * Creates a new #IdoScaleMenuItem. If @menuitem contains an action, it
- * will be bound to that action in @actions.
- *
- * Returns: (transfer full): a new #IdoScaleMenuItem
+ * Applies the range, marks, icons and action of @menuitem to an
+ * #IdoScaleMenuItem built by ido_scale_menu_item_new_from_model(). Only
+ * the properties that differ from the current ones are touched. If
+ * @menuitem is %NULL, the item is left as blank as a new one, without
+ * an action binding.
  */
-GtkMenuItem *
-ido_scale_menu_item_new_from_model (GMenuItem    *menuitem,
-                                    GActionGroup *actions)
+void
+ido_scale_menu_item_update_from_model (GtkMenuItem  *item,
+                                       GMenuItem    *menuitem,
+                                       GActionGroup *actions)
 {
-  GtkWidget *item;
-  gchar *action;
+  IdoScaleMenuItemPrivate *pPrivate;
+  GtkAdjustment *pAdjustment;
+  IdoActionHelper *helper;
+  gchar *action = NULL;
   gdouble min = 0.0;
   gdouble max = 100.0;
   gdouble step = 1.0;
+  gboolean bRangeChanged;
   GIcon *min_icon;
   GIcon *max_icon;
 
-  g_menu_item_get_attribute (menuitem, "min-value", "d", &min);
-  g_menu_item_get_attribute (menuitem, "max-value", "d", &max);
-  g_menu_item_get_attribute (menuitem, "step", "d", &step);
+  g_return_if_fail (IDO_IS_SCALE_MENU_ITEM (item));
 
-  item = ido_scale_menu_item_new_with_range ("Volume", IDO_RANGE_STYLE_DEFAULT, 0.0, min, max, step);
-  ido_scale_menu_item_set_style (IDO_SCALE_MENU_ITEM (item), IDO_SCALE_MENU_ITEM_STYLE_IMAGE);
+  pPrivate = ido_scale_menu_item_get_instance_private (IDO_SCALE_MENU_ITEM (item));
 
-  if (g_menu_item_get_attribute (menuitem, "action", "s", &action))
+  if (menuitem == NULL)
     {
-      IdoActionHelper *helper;
+      /* the pending value belongs to the action that is dropped */
+      pPrivate->has_pending_value = FALSE;
+      ido_scale_menu_item_flush_value (IDO_SCALE_MENU_ITEM (item));
+      ido_action_helper_bind_widget (GTK_WIDGET (item), NULL, NULL, NULL);
+
+      /* back to how a new item looks, GtkScale shows one digit */
+      ido_scale_menu_item_set_icons (IDO_SCALE_MENU_ITEM (item), NULL, NULL);
+      gtk_scale_clear_marks (GTK_SCALE (pPrivate->scale));
+      g_signal_handlers_disconnect_by_func (pPrivate->scale, onFormatValue, NULL);
+      gtk_scale_set_draw_value (GTK_SCALE (pPrivate->scale), FALSE);
+      gtk_scale_set_digits (GTK_SCALE (pPrivate->scale), 1);
+      gtk_range_set_round_digits (GTK_RANGE (pPrivate->scale), 1);
+      ido_scale_menu_item_set_value (IDO_SCALE_MENU_ITEM (item),
+                                     gtk_adjustment_get_lower (gtk_range_get_adjustment (GTK_RANGE (pPrivate->scale))));
+      pPrivate->bCloseOnChange = FALSE;
+      ido_scale_menu_item_set_change_rate (IDO_SCALE_MENU_ITEM (item), 0);
+      return;
+    }
 
-      helper = ido_action_helper_new (item, actions, action, NULL);
-      g_signal_connect (helper, "action-state-changed",
-                        G_CALLBACK (ido_scale_menu_item_state_changed), NULL);
+  g_menu_item_get_attribute (menuitem, "min-value", "d", &min);
+  g_menu_item_get_attribute (menuitem, "max-value", "d", &max);
+  g_menu_item_get_attribute (menuitem, "step", "d", &step);
 
-      g_signal_connect (item, "value-changed", G_CALLBACK (ido_scale_menu_item_value_changed), helper);
-      g_signal_connect_swapped (item, "destroy", G_CALLBACK (g_object_unref), helper);
+  pAdjustment = gtk_range_get_adjustment (GTK_RANGE (pPrivate->scale));
+  bRangeChanged = gtk_adjustment_get_lower (pAdjustment) != min ||
+                  gtk_adjustment_get_upper (pAdjustment) != max ||
+                  gtk_adjustment_get_step_increment (pAdjustment) != step;
 
-      g_free (action);
+  if (bRangeChanged)
+    {
+      pPrivate->ignore_value_changed = TRUE;
+      gtk_adjustment_configure (pAdjustment, CLAMP (gtk_adjustment_get_value (pAdjustment), min, max), min, max, step, step, 0);
+      pPrivate->ignore_value_changed = FALSE;
     }
 
-  IdoScaleMenuItemPrivate *pPrivate = ido_scale_menu_item_get_instance_private (IDO_SCALE_MENU_ITEM (item));
   guchar nDigits = 0;
   gboolean bFound = g_menu_item_get_attribute (menuitem, "digits", "y", &nDigits);
 
-  if (bFound)
+  /* without the attribute, GtkScale's default of one digit, like a new item */
+  if (!bFound)
+  {
+        nDigits = 1;
+  }
+
+  if (gtk_scale_get_digits (GTK_SCALE (pPrivate->scale)) != nDigits)
   {
         gtk_scale_set_digits (GTK_SCALE (pPrivate->scale), nDigits);
         gtk_range_set_round_digits (GTK_RANGE (pPrivate->scale), nDigits);
@@ -1115,19 +1359,31 @@ ido_scale_menu_item_new_from_model (GMenuItem    *menuitem,
   gboolean bMarks = FALSE;
   bFound = g_menu_item_get_attribute (menuitem, "marks", "b", &bMarks);
 
-  if (bFound)
+  if (bFound != gtk_scale_get_draw_value (GTK_SCALE (pPrivate->scale)) || (bFound && bRangeChanged))
   {
-        gtk_scale_set_draw_value (GTK_SCALE (pPrivate->scale), TRUE);
+        gtk_scale_clear_marks (GTK_SCALE (pPrivate->scale));
+        g_signal_handlers_disconnect_by_func (pPrivate->scale, onFormatValue, NULL);
+        gtk_scale_set_draw_value (GTK_SCALE (pPrivate->scale), bFound);
 
-        for (gdouble fValue = min; fValue < (max + step); fValue += step)
+        if (bFound)
         {
-            gtk_scale_add_mark (GTK_SCALE (pPrivate->scale), round (fValue * 10) / 10, GTK_POS_BOTTOM, NULL);
-        }
+            for (gdouble fValue = min; fValue < (max + step); fValue += step)
+            {
+                gtk_scale_add_mark (GTK_SCALE (pPrivate->scale), round (fValue * 10) / 10, GTK_POS_BOTTOM, NULL);
+            }
 
-        g_signal_connect (pPrivate->scale, "format-value", G_CALLBACK (onFormatValue), NULL);
+            g_signal_connect (pPrivate->scale, "format-value", G_CALLBACK (onFormatValue), NULL);
+        }
   }
 
+  pPrivate->bCloseOnChange = FALSE;
   g_menu_item_get_attribute (menuitem, "close-on-change", "b", &pPrivate->bCloseOnChange);
+
+  /* a rate set in code stays unless the model has its own */
+  gint nChangeRate = 0;
+  if (g_menu_item_get_attribute (menuitem, "change-rate", "i", &nChangeRate))
+    ido_scale_menu_item_set_change_rate (IDO_SCALE_MENU_ITEM (item), MAX (nChangeRate, IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME));
+
   min_icon = menu_item_get_icon (menuitem, "min-icon");
   max_icon = menu_item_get_icon (menuitem, "max-icon");
   ido_scale_menu_item_set_icons (IDO_SCALE_MENU_ITEM (item), min_icon, max_icon);
@@ -1135,7 +1391,45 @@ ido_scale_menu_item_new_from_model (GMenuItem    *menuitem,
   if (min_icon)
     g_object_unref (min_icon);
   if (max_icon)
-  g_object_unref (max_icon);
+    g_object_unref (max_icon);
+
+  g_menu_item_get_attribute (menuitem, "action", "s", &action);
+
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (item), actions, action, NULL);
+  if (helper)
+    {
+      /* a value held back for the previous action isn't sent to this one */
+      pPrivate->has_pending_value = FALSE;
+
+      /* services stream volume and brightness faster than we draw */
+      ido_action_helper_set_coalesce_states (helper, TRUE);
+      g_signal_connect (helper, "action-state-changed",
+                        G_CALLBACK (ido_scale_menu_item_state_changed), NULL);
+
+      g_signal_connect_object (item, "value-changed", G_CALLBACK (ido_scale_menu_item_value_changed), helper, 0);
+    }
+
+  g_free (action);
+}
+
+/**
+ * ido_scale_menu_item_new_from_model:
+ *
+ * Creates a new #IdoScaleMenuItem. If @menuitem contains an action, it
+ * will be bound to that action in @actions.
+ *
+ * Returns: (transfer full): a new #IdoScaleMenuItem
+ */
+GtkMenuItem *
+ido_scale_menu_item_new_from_model (GMenuItem    *menuitem,
+                                    GActionGroup *actions)
+{
+  GtkWidget *item;
+
+  item = ido_scale_menu_item_new_with_range ("Volume", IDO_RANGE_STYLE_DEFAULT, 0.0, 0.0, 100.0, 1.0);
+  ido_scale_menu_item_set_style (IDO_SCALE_MENU_ITEM (item), IDO_SCALE_MENU_ITEM_STYLE_IMAGE);
+
+  ido_scale_menu_item_update_from_model (GTK_MENU_ITEM (item), menuitem, actions);
 
   return GTK_MENU_ITEM (item);
 }
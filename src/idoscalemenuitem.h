@@ -45,6 +45,9 @@ typedef enum
   IDO_SCALE_MENU_ITEM_STYLE_LABEL
 } IdoScaleMenuItemStyle;
 
+/* IdoScaleMenuItem:change-rate sending at most one change per frame */
+#define IDO_SCALE_MENU_ITEM_CHANGE_RATE_FRAME (-1)
+
 typedef struct _IdoScaleMenuItem        IdoScaleMenuItem;
 typedef struct _IdoScaleMenuItemClass   IdoScaleMenuItemClass;
 
@@ -88,10 +91,17 @@ void                   ido_scale_menu_item_set_secondary_label (IdoScaleMenuItem
                                                                 const gchar           *label);
 void                   ido_scale_menu_item_primary_clicked     (IdoScaleMenuItem      *menuitem);
 void                   ido_scale_menu_item_secondary_clicked   (IdoScaleMenuItem      *menuitem);
+void                   ido_scale_menu_item_set_change_rate     (IdoScaleMenuItem      *menuitem,
+                                                                gint                   rate);
+gint                   ido_scale_menu_item_get_change_rate     (IdoScaleMenuItem      *menuitem);
 
 GtkMenuItem *          ido_scale_menu_item_new_from_model      (GMenuItem             *menuitem,
                                                                 GActionGroup          *actions);
 
+void                   ido_scale_menu_item_update_from_model   (GtkMenuItem           *item,
+                                                                GMenuItem             *menuitem,
+                                                                GActionGroup          *actions);
+
 G_END_DECLS
 
 #endif /* __IDO_SCALE_MENU_ITEM_H__ */
@@ -0,0 +1,287 @@
+/*
+ * Copyright 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "idoshadowcache.h"
+#include "idoblur.h"
+
+#include <string.h>
+
+/*
+ * A blurred shadow only depends on the shape it was drawn from, its
+ * size, the blur radius, its colour and the device scale, so every
+ * widget in the process can share one copy of it. Entries are kept in
+ * most recently used order and dropped from the other end once they
+ * take up more than max_bytes. Like the rest of GTK, this is only used
+ * from the main thread.
+ */
+
+typedef struct
+{
+  guint shape;
+  gint width;
+  gint height;
+  guint radius;
+  gdouble rgba[4];
+  gint scale;
+} IdoShadowKey;
+
+typedef struct
+{
+  IdoShadowKey key;
+  cairo_surface_t *surface;
+  gsize n_bytes;
+  GList link;
+} IdoShadowEntry;
+
+typedef struct
+{
+  GHashTable *entries;
+  GQueue lru;
+  gsize n_bytes;
+  gsize max_bytes;
+} IdoShadowCache;
+
+static guint
+ido_shadow_key_hash (gconstpointer data)
+{
+  const IdoShadowKey *key = data;
+  guint hash;
+  gint i;
+
+  hash = key->shape;
+  hash = hash * 31 + key->width;
+  hash = hash * 31 + key->height;
+  hash = hash * 31 + key->radius;
+  hash = hash * 31 + key->scale;
+
+  for (i = 0; i < 4; i++)
+    hash = hash * 31 + (guint) (key->rgba[i] * 255.0 + 0.5);
+
+  return hash;
+}
+
+static gboolean
+ido_shadow_key_equal (gconstpointer a,
+                      gconstpointer b)
+{
+  return memcmp (a, b, sizeof (IdoShadowKey)) == 0;
+}
+
+static void
+ido_shadow_entry_free (gpointer data)
+{
+  IdoShadowEntry *entry = data;
+
+  cairo_surface_destroy (entry->surface);
+  g_slice_free (IdoShadowEntry, entry);
+}
+
+static IdoShadowCache *
+ido_shadow_cache_get_default (void)
+{
+  static IdoShadowCache cache;
+
+  if (cache.entries == NULL)
+    {
+      cache.entries = g_hash_table_new_full (ido_shadow_key_hash, ido_shadow_key_equal,
+                                             NULL, ido_shadow_entry_free);
+      g_queue_init (&cache.lru);
+      cache.max_bytes = IDO_SHADOW_CACHE_DEFAULT_MAX_BYTES;
+    }
+
+  return &cache;
+}
+
+static void
+ido_shadow_cache_remove (IdoShadowCache *cache,
+                         IdoShadowEntry *entry)
+{
+  g_queue_unlink (&cache->lru, &entry->link);
+  cache->n_bytes -= entry->n_bytes;
+  g_hash_table_remove (cache->entries, &entry->key);
+}
+
+static void
+ido_shadow_cache_trim (IdoShadowCache *cache)
+{
+  while (cache->n_bytes > cache->max_bytes)
+    ido_shadow_cache_remove (cache, cache->lru.tail->data);
+}
+
+static cairo_surface_t *
+ido_shadow_render (const IdoShadowKey *key,
+                   IdoShadowDrawFunc   draw,
+                   gpointer            user_data)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        key->width * key->scale,
+                                        key->height * key->scale);
+  cairo_surface_set_device_scale (surface, key->scale, key->scale);
+
+  cr = cairo_create (surface);
+  draw (cr, user_data);
+  cairo_destroy (cr);
+
+  // before we mess with the surface execute any pending drawing
+  cairo_surface_flush (surface);
+
+  ido_blur_exponential (cairo_image_surface_get_data (surface),
+                        key->width * key->scale,
+                        key->height * key->scale,
+                        4, key->radius * key->scale, 16, 7);
+
+  // inform cairo we altered the surfaces contents
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
+
+/**
+ * ido_shadow_cache_get: (skip)
+ * @shape: identifies what @draw draws, unique among the callers
+ * @width: width of the shadow, in user space units
+ * @height: height of the shadow, in user space units
+ * @radius: blur radius, in user space units
+ * @rgba: the colour of the shadow
+ * @scale: the device scale of the surface the shadow will be painted on
+ * @draw: (scope call): draws the shape when the shadow isn't cached yet
+ * @user_data: data for @draw
+ *
+ * Looks up the blurred shadow for the given parameters, drawing and
+ * blurring it at @scale only if no widget has asked for it before.
+ *
+ * Returns: (transfer full): an image surface of @width by @height user
+ *   space units, with a device scale of @scale
+ */
+cairo_surface_t *
+ido_shadow_cache_get (guint              shape,
+                      gint               width,
+                      gint               height,
+                      guint              radius,
+                      const gdouble     *rgba,
+                      gint               scale,
+                      IdoShadowDrawFunc  draw,
+                      gpointer           user_data)
+{
+  IdoShadowCache *cache = ido_shadow_cache_get_default ();
+  IdoShadowEntry *entry;
+  IdoShadowKey key;
+
+  g_return_val_if_fail (rgba != NULL, NULL);
+  g_return_val_if_fail (draw != NULL, NULL);
+
+  /* zero the padding too, keys are compared byte by byte */
+  memset (&key, 0, sizeof (IdoShadowKey));
+  key.shape = shape;
+  key.width = width;
+  key.height = height;
+  key.radius = radius;
+  memcpy (key.rgba, rgba, sizeof (key.rgba));
+  key.scale = MAX (scale, 1);
+
+  entry = g_hash_table_lookup (cache->entries, &key);
+  if (entry)
+    {
+      g_queue_unlink (&cache->lru, &entry->link);
+      g_queue_push_head_link (&cache->lru, &entry->link);
+
+      return cairo_surface_reference (entry->surface);
+    }
+
+  entry = g_slice_new0 (IdoShadowEntry);
+  entry->key = key;
+  entry->surface = ido_shadow_render (&key, draw, user_data);
+  entry->n_bytes = (gsize) cairo_image_surface_get_stride (entry->surface) *
+                   cairo_image_surface_get_height (entry->surface);
+  entry->link.data = entry;
+
+  g_hash_table_insert (cache->entries, &entry->key, entry);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  cache->n_bytes += entry->n_bytes;
+
+  /* the reference is taken first, the new entry may not fit at all */
+  cairo_surface_reference (entry->surface);
+  ido_shadow_cache_trim (cache);
+
+  return entry->surface;
+}
+
+/**
+ * ido_shadow_cache_set_max_bytes: (skip)
+ * @max_bytes: how many bytes of pixels the shadow cache may hold
+ *
+ * Sets the budget of the shadow cache, shared by the whole process.
+ * The least recently used shadows are dropped until the cache fits.
+ */
+void
+ido_shadow_cache_set_max_bytes (gsize max_bytes)
+{
+  IdoShadowCache *cache = ido_shadow_cache_get_default ();
+
+  cache->max_bytes = max_bytes;
+  ido_shadow_cache_trim (cache);
+}
+
+/**
+ * ido_shadow_cache_get_max_bytes: (skip)
+ *
+ * Returns: the budget of the shadow cache, in bytes
+ */
+gsize
+ido_shadow_cache_get_max_bytes (void)
+{
+  return ido_shadow_cache_get_default ()->max_bytes;
+}
+
+/**
+ * ido_shadow_cache_get_n_bytes: (skip)
+ *
+ * Returns: how many bytes of pixels the shadow cache holds
+ */
+gsize
+ido_shadow_cache_get_n_bytes (void)
+{
+  return ido_shadow_cache_get_default ()->n_bytes;
+}
+
+/**
+ * ido_shadow_cache_get_n_entries: (skip)
+ *
+ * Returns: how many shadows the shadow cache holds
+ */
+guint
+ido_shadow_cache_get_n_entries (void)
+{
+  return g_hash_table_size (ido_shadow_cache_get_default ()->entries);
+}
+
+/**
+ * ido_shadow_cache_clear: (skip)
+ *
+ * Drops every shadow from the cache. Surfaces still referenced
+ * elsewhere stay valid.
+ */
+void
+ido_shadow_cache_clear (void)
+{
+  IdoShadowCache *cache = ido_shadow_cache_get_default ();
+
+  while (cache->lru.head)
+    ido_shadow_cache_remove (cache, cache->lru.head->data);
+}
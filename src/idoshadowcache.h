@@ -0,0 +1,59 @@
+/*
+ * Copyright 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __IDO_SHADOW_CACHE_H__
+#define __IDO_SHADOW_CACHE_H__
+
+#include <cairo.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define IDO_SHADOW_CACHE_DEFAULT_MAX_BYTES (256 * 1024)
+
+/**
+ * IdoShadowDrawFunc:
+ * @cr: a context on a cleared surface of the requested size
+ * @user_data: the data passed to ido_shadow_cache_get()
+ *
+ * Draws the shape of a shadow, before it is blurred, in the colour it
+ * was requested in. @cr is in user space units.
+ */
+typedef void (*IdoShadowDrawFunc) (cairo_t  *cr,
+                                   gpointer  user_data);
+
+cairo_surface_t *   ido_shadow_cache_get            (guint              shape,
+                                                     gint               width,
+                                                     gint               height,
+                                                     guint              radius,
+                                                     const gdouble     *rgba,
+                                                     gint               scale,
+                                                     IdoShadowDrawFunc  draw,
+                                                     gpointer           user_data);
+
+void                ido_shadow_cache_set_max_bytes  (gsize              max_bytes);
+
+gsize               ido_shadow_cache_get_max_bytes  (void);
+
+gsize               ido_shadow_cache_get_n_bytes    (void);
+
+guint               ido_shadow_cache_get_n_entries  (void);
+
+void                ido_shadow_cache_clear          (void);
+
+G_END_DECLS
+
+#endif
@@ -160,16 +160,25 @@ static void
 ido_source_menu_item_set_label (IdoSourceMenuItem *item,
                                 const gchar       *label)
 {
-  gtk_label_set_label (GTK_LABEL (item->label), label ? label : "");
+  if (g_strcmp0 (gtk_label_get_label (GTK_LABEL (item->label)), label ? label : ""))
+    gtk_label_set_label (GTK_LABEL (item->label), label ? label : "");
 }
 
 static void
 ido_source_menu_item_set_icon (IdoSourceMenuItem *item,
                                GIcon             *icon)
 {
+  GIcon *current = NULL;
+
+  if (gtk_image_get_storage_type (GTK_IMAGE (item->icon)) == GTK_IMAGE_GICON)
+    gtk_image_get_gicon (GTK_IMAGE (item->icon), &current, NULL);
+
+  if (icon && current && g_icon_equal (icon, current))
+    return;
+
   if (icon)
     gtk_image_set_from_gicon (GTK_IMAGE (item->icon), icon, GTK_ICON_SIZE_MENU);
-  else
+  else if (gtk_image_get_storage_type (GTK_IMAGE (item->icon)) != GTK_IMAGE_EMPTY)
     gtk_image_clear (GTK_IMAGE (item->icon));
 }
 
@@ -217,49 +226,86 @@ ido_source_menu_item_state_changed (IdoActionHelper *helper,
     ido_detail_label_set_text (IDO_DETAIL_LABEL (item->detail), str);
 }
 
-GtkMenuItem *
-ido_source_menu_item_new_from_menu_model (GMenuItem    *menuitem,
-                                          GActionGroup *actions)
+/**
+ * ido_source_menu_item_update_from_model:
+ * @item: an #IdoSourceMenuItem
+ * @menuitem: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menuitem's action
+ *
+ * Applies the label, icon and action of @menuitem to an
+ * #IdoSourceMenuItem. If @menuitem is %NULL, the item is left as blank
+ * as a new one, without an action binding or a detail timer.
+ */
+void
+ido_source_menu_item_update_from_model (GtkMenuItem  *item,
+                                        GMenuItem    *menuitem,
+                                        GActionGroup *actions)
 {
-  GtkMenuItem *item;
+  IdoSourceMenuItem *self;
+  IdoActionHelper *helper;
   GVariant *serialized_icon;
   GIcon *icon = NULL;
-  gchar *label;
+  gchar *label = NULL;
   gchar *action = NULL;
 
-  item = g_object_new (IDO_TYPE_SOURCE_MENU_ITEM, NULL);
+  g_return_if_fail (IDO_IS_SOURCE_MENU_ITEM (item));
+
+  self = IDO_SOURCE_MENU_ITEM (item);
 
-  if (g_menu_item_get_attribute (menuitem, "label", "s", &label))
+  if (menuitem == NULL)
     {
-      ido_source_menu_item_set_label (IDO_SOURCE_MENU_ITEM (item), label);
-      g_free (label);
+      if (self->timer_id != 0)
+        {
+          g_source_remove (self->timer_id);
+          self->timer_id = 0;
+        }
+
+      ido_action_helper_bind_widget (GTK_WIDGET (item), NULL, NULL, NULL);
+      ido_source_menu_item_set_label (self, NULL);
+      ido_source_menu_item_set_icon (self, NULL);
+      ido_detail_label_set_text (IDO_DETAIL_LABEL (self->detail), NULL);
+      self->time = 0;
+      return;
     }
 
+  g_menu_item_get_attribute (menuitem, "label", "s", &label);
+  ido_source_menu_item_set_label (self, label);
+  g_free (label);
+
   serialized_icon = g_menu_item_get_attribute_value (menuitem, "icon", NULL);
   if (serialized_icon)
     {
       icon = g_icon_deserialize (serialized_icon);
       g_variant_unref (serialized_icon);
     }
-  ido_source_menu_item_set_icon (IDO_SOURCE_MENU_ITEM (item), icon);
+  ido_source_menu_item_set_icon (self, icon);
 
-  if (g_menu_item_get_attribute (menuitem, "action", "s", &action))
-    {
-      IdoActionHelper *helper;
+  g_menu_item_get_attribute (menuitem, "action", "s", &action);
 
-      helper = ido_action_helper_new (GTK_WIDGET (item), actions, action, NULL);
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (item), actions, action, NULL);
+  if (helper)
+    {
       g_signal_connect (helper, "action-state-changed",
                         G_CALLBACK (ido_source_menu_item_state_changed), item);
       g_signal_connect_object (item, "activate",
                                G_CALLBACK (ido_source_menu_item_activate), helper,
                                0);
-      g_signal_connect_swapped (item, "destroy", G_CALLBACK (g_object_unref), helper);
-
-      g_free (action);
     }
 
+  g_free (action);
+
   if (icon)
     g_object_unref (icon);
+}
+
+GtkMenuItem *
+ido_source_menu_item_new_from_menu_model (GMenuItem    *menuitem,
+                                          GActionGroup *actions)
+{
+  GtkMenuItem *item;
+
+  item = g_object_new (IDO_TYPE_SOURCE_MENU_ITEM, NULL);
+  ido_source_menu_item_update_from_model (item, menuitem, actions);
 
   return item;
 }
@@ -33,4 +33,8 @@ GType                   ido_source_menu_item_get_type                   (void);
 GtkMenuItem *           ido_source_menu_item_new_from_menu_model        (GMenuItem    *menuitem,
                                                                          GActionGroup *actions);
 
+void                    ido_source_menu_item_update_from_model          (GtkMenuItem  *item,
+                                                                         GMenuItem    *menuitem,
+                                                                         GActionGroup *actions);
+
 #endif
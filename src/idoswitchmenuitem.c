@@ -172,7 +172,8 @@ ido_switch_menu_item_set_label (IdoSwitchMenuItem *item,
       gtk_box_pack_start (GTK_BOX (priv->content_area), priv->label, TRUE, TRUE, 0);
     }
 
-  gtk_label_set_text (GTK_LABEL (priv->label), label);
+  if (g_strcmp0 (gtk_label_get_text (GTK_LABEL (priv->label)), label))
+    gtk_label_set_text (GTK_LABEL (priv->label), label);
 }
 
 /**
@@ -236,7 +237,13 @@ ido_switch_menu_item_set_icon (IdoSwitchMenuItem *item,
           gtk_box_pack_start (GTK_BOX (priv->content_area), priv->image, FALSE, FALSE, 0);
         }
 
-      gtk_image_set_from_gicon (GTK_IMAGE (priv->image), icon, GTK_ICON_SIZE_MENU);
+      GIcon *current = NULL;
+
+      if (gtk_image_get_storage_type (GTK_IMAGE (priv->image)) == GTK_IMAGE_GICON)
+        gtk_image_get_gicon (GTK_IMAGE (priv->image), &current, NULL);
+
+      if (!g_icon_equal (current, icon))
+        gtk_image_set_from_gicon (GTK_IMAGE (priv->image), icon, GTK_ICON_SIZE_MENU);
     }
   else if (priv->image)
     {
@@ -266,22 +273,52 @@ static void ido_switch_menu_item_activate(IdoSwitchMenuItem *self, gpointer user
     ido_action_helper_activate_with_parameter(helper, g_variant_new_boolean(active));
 }
 
-GtkMenuItem *
-ido_switch_menu_item_new_from_menu_model (GMenuItem    *menuitem,
-                                          GActionGroup *actions)
+/**
+ * ido_switch_menu_item_update_from_model:
+ * @item: an #IdoSwitchMenuItem
+ * @menuitem: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menuitem's action
+ *
+ * Applies the attributes and action of @menuitem to @item. If @menuitem
+ * is %NULL, the item is left as blank as a new one, without an action
+ * binding.
+ */
+void
+ido_switch_menu_item_update_from_model (GtkMenuItem  *item,
+                                        GMenuItem    *menuitem,
+                                        GActionGroup *actions)
 {
-  GtkMenuItem *item;
+  IdoSwitchMenuItemPrivate *priv;
+  IdoActionHelper *helper;
   gchar *label;
   GVariant *serialized_icon;
+  GIcon *icon = NULL;
   gchar *action = NULL;
 
-  item = g_object_new (IDO_TYPE_SWITCH_MENU_ITEM, NULL);
+  g_return_if_fail (IDO_IS_SWITCH_MENU_ITEM (item));
+
+  priv = ido_switch_menu_item_get_instance_private (IDO_SWITCH_MENU_ITEM (item));
+
+  if (menuitem == NULL)
+    {
+      ido_action_helper_bind_widget (GTK_WIDGET (item), NULL, NULL, NULL);
+      ido_switch_menu_item_set_icon (IDO_SWITCH_MENU_ITEM (item), NULL);
+      if (priv->label)
+        gtk_label_set_text (GTK_LABEL (priv->label), "");
+      if (priv->accelerator)
+        gtk_label_set_text (GTK_LABEL (priv->accelerator), "");
+      return;
+    }
 
   if (g_menu_item_get_attribute (menuitem, "label", "s", &label))
     {
       ido_switch_menu_item_set_label (IDO_SWITCH_MENU_ITEM (item), label);
       g_free (label);
     }
+  else if (priv->label)
+    {
+      gtk_label_set_text (GTK_LABEL (priv->label), "");
+    }
 
     gchar *sAccelerator;
     gboolean bAccelerator = g_menu_item_get_attribute (menuitem, "accel", "s", &sAccelerator);
@@ -291,35 +328,43 @@ ido_switch_menu_item_new_from_menu_model (GMenuItem    *menuitem,
         ido_switch_menu_item_set_accelerator (IDO_SWITCH_MENU_ITEM (item), sAccelerator);
         g_free (sAccelerator);
     }
+    else if (priv->accelerator)
+    {
+        gtk_label_set_text (GTK_LABEL (priv->accelerator), "");
+    }
 
   serialized_icon = g_menu_item_get_attribute_value (menuitem, "icon", NULL);
   if (serialized_icon)
     {
-      GIcon *icon;
-
       icon = g_icon_deserialize (serialized_icon);
-      if (icon)
-        {
-          ido_switch_menu_item_set_icon (IDO_SWITCH_MENU_ITEM (item), icon);
-          g_object_unref (icon);
-        }
-
       g_variant_unref (serialized_icon);
     }
 
-  if (g_menu_item_get_attribute (menuitem, "action", "s", &action))
-    {
-      IdoActionHelper *helper;
+  ido_switch_menu_item_set_icon (IDO_SWITCH_MENU_ITEM (item), icon);
+  g_clear_object (&icon);
+
+  g_menu_item_get_attribute (menuitem, "action", "s", &action);
 
-      helper = ido_action_helper_new (GTK_WIDGET (item), actions, action, NULL);
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (item), actions, action, NULL);
+  if (helper)
+    {
       g_signal_connect (helper, "action-state-changed",
                         G_CALLBACK (ido_source_menu_item_state_changed), item);
       g_signal_connect(item, "activate", G_CALLBACK(ido_switch_menu_item_activate), helper);
-      g_signal_connect_swapped (item, "destroy", G_CALLBACK (g_object_unref), helper);
-
-      g_free (action);
     }
 
+  g_free (action);
+}
+
+GtkMenuItem *
+ido_switch_menu_item_new_from_menu_model (GMenuItem    *menuitem,
+                                          GActionGroup *actions)
+{
+  GtkMenuItem *item;
+
+  item = g_object_new (IDO_TYPE_SWITCH_MENU_ITEM, NULL);
+  ido_switch_menu_item_update_from_model (item, menuitem, actions);
+
   return item;
 }
 
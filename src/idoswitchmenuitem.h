@@ -52,6 +52,10 @@ GtkContainer *ido_switch_menu_item_get_content_area (IdoSwitchMenuItem * item);
 GtkMenuItem  * ido_switch_menu_item_new_from_menu_model (GMenuItem    *menuitem,
                                                          GActionGroup *actions);
 
+void           ido_switch_menu_item_update_from_model   (GtkMenuItem  *item,
+                                                         GMenuItem    *menuitem,
+                                                         GActionGroup *actions);
+
 void          ido_switch_menu_item_set_label        (IdoSwitchMenuItem *item,
                                                      const gchar       *label);
 
@@ -24,22 +24,34 @@
 
 #include <gtk/gtk.h>
 #include <math.h>
+#include <string.h>
 
 #define MSECS_PER_SEC 1000
-#define FRAME_INTERVAL(nframes) (MSECS_PER_SEC / nframes)
+/* at least 1 ms, a 0 ms timeout would spin the main loop */
+#define FRAME_INTERVAL(nframes) (MAX (MSECS_PER_SEC / (nframes), 1))
 #define DEFAULT_FPS 30
 
 typedef struct {
   guint duration;
   guint fps;
-  guint source_id;
+  guint scheduled : 1;
 
-  GTimer *timer;
+  IdoTimelineClock *clock;
+  GtkWidget *widget;
+  GdkFrameClock *frame_clock;
+  GtkWidget *frame_widget;
+  gulong update_id;
+  gulong unrealize_id;
+  gint64 last_frame_time;
 
   gdouble progress;
   gdouble last_progress;
 
+  IdoTimelineStats stats;
+
   GdkScreen *screen;
+  GtkSettings *settings;
+  gulong settings_id;
 
   guint animations_enabled : 1;
   guint loop               : 1;
@@ -52,7 +64,9 @@ enum {
   PROP_DURATION,
   PROP_LOOP,
   PROP_DIRECTION,
-  PROP_SCREEN
+  PROP_SCREEN,
+  PROP_WIDGET,
+  PROP_CLOCK
 };
 
 enum {
@@ -75,6 +89,8 @@ static void  ido_timeline_get_property  (GObject         *object,
                                          GValue          *value,
                                          GParamSpec      *pspec);
 static void  ido_timeline_finalize      (GObject *object);
+static void  ido_timeline_stop_source   (IdoTimeline *timeline);
+static void  ido_timeline_watch_settings (IdoTimeline *timeline);
 
 
 G_DEFINE_TYPE_WITH_PRIVATE (IdoTimeline, ido_timeline, G_TYPE_OBJECT)
@@ -127,6 +143,35 @@ ido_timeline_class_init (IdoTimelineClass *klass)
 							"Screen to get the settings from",
 							GDK_TYPE_SCREEN,
 							G_PARAM_READWRITE));
+  /**
+   * IdoTimeline:widget:
+   *
+   * The widget the timeline animates. While it is realized, the
+   * timeline advances with the frame clock of the widget, in step with
+   * the frames that are drawn. Otherwise, the timeline falls back to a
+   * timeout of #IdoTimeline:fps.
+   */
+  g_object_class_install_property (object_class,
+				   PROP_WIDGET,
+				   g_param_spec_object ("widget",
+							"Widget",
+							"Widget whose frame clock drives the timeline",
+							GTK_TYPE_WIDGET,
+							G_PARAM_READWRITE));
+  /**
+   * IdoTimeline:clock:
+   *
+   * The clock the timeline measures time with when it is not driven by
+   * the frame clock of #IdoTimeline:widget. Setting a clock other than
+   * the default one also takes precedence over the frame clock.
+   */
+  g_object_class_install_property (object_class,
+				   PROP_CLOCK,
+				   g_param_spec_object ("clock",
+							"Clock",
+							"Clock that advances the timeline",
+							IDO_TYPE_TIMELINE_CLOCK,
+							G_PARAM_READWRITE));
 
   /**
    * IdoTimeline::started:
@@ -200,8 +245,13 @@ ido_timeline_init (IdoTimeline *timeline)
   priv->duration = 0.0;
   priv->direction = IDO_TIMELINE_DIRECTION_FORWARD;
   priv->screen = gdk_screen_get_default ();
+  if (priv->screen)
+    g_object_ref (priv->screen);
+  priv->clock = g_object_ref (ido_timeline_clock_get_default ());
 
   priv->last_progress = 0;
+
+  ido_timeline_watch_settings (timeline);
 }
 
 static void
@@ -232,6 +282,14 @@ ido_timeline_set_property (GObject      *object,
       ido_timeline_set_screen (timeline,
                                (GdkScreen*)g_value_get_object (value));
       break;
+    case PROP_WIDGET:
+      ido_timeline_set_widget (timeline,
+                               (GtkWidget*)g_value_get_object (value));
+      break;
+    case PROP_CLOCK:
+      ido_timeline_set_clock (timeline,
+                              (IdoTimelineClock*)g_value_get_object (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -263,6 +321,12 @@ ido_timeline_get_property (GObject    *object,
     case PROP_SCREEN:
       g_value_set_object (value, priv->screen);
       break;
+    case PROP_WIDGET:
+      g_value_set_object (value, priv->widget);
+      break;
+    case PROP_CLOCK:
+      g_value_set_object (value, priv->clock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -274,32 +338,450 @@ ido_timeline_finalize (GObject *object)
   IdoTimeline *timeline = IDO_TIMELINE (object);
   IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
 
-  if (priv->source_id)
+  ido_timeline_stop_source (timeline);
+
+  if (priv->widget)
+    g_object_remove_weak_pointer (G_OBJECT (priv->widget), (gpointer *) &priv->widget);
+
+  if (priv->settings)
     {
-      g_source_remove (priv->source_id);
-      priv->source_id = 0;
+      g_signal_handler_disconnect (priv->settings, priv->settings_id);
+      g_object_unref (priv->settings);
     }
 
-  if (priv->timer)
-    g_timer_destroy (priv->timer);
+  g_clear_object (&priv->screen);
+  g_object_unref (priv->clock);
 
   G_OBJECT_CLASS (ido_timeline_parent_class)->finalize (object);
 }
 
+/*
+ * Timelines without a frame clock are ticked by the #IdoTimelineClock
+ * they run on instead of one timeout each. The default clock follows
+ * monotonic time with a single timeout for the whole process, at the
+ * frame rate of the fastest running timeline. It emits ::frame for all
+ * of them in one pass and removes its source when no timeline is
+ * running. A manual clock only moves when ido_timeline_clock_advance()
+ * is called, which makes runs reproducible.
+ */
+struct _IdoTimelineClock
+{
+  GObject parent_instance;
+
+  GPtrArray *timelines;
+  gboolean manual;
+  gint64 time;
+
+  guint source_id;
+  guint interval;
+
+  guint64 wakeups;
+  gint64 window_start;
+  guint window_wakeups;
+  gdouble wakeups_per_second;
+};
+
+struct _IdoTimelineClockClass
+{
+  GObjectClass parent_class;
+};
+
+G_DEFINE_TYPE (IdoTimelineClock, ido_timeline_clock, G_TYPE_OBJECT)
+
+static gboolean ido_timeline_advance (IdoTimeline *timeline,
+                                      gdouble      elapsed);
+
+static void
+ido_timeline_clock_finalize (GObject *object)
+{
+  IdoTimelineClock *clock = IDO_TIMELINE_CLOCK (object);
+
+  /* running timelines hold a reference, so none are left here */
+  g_ptr_array_unref (clock->timelines);
+
+  if (clock->source_id)
+    g_source_remove (clock->source_id);
+
+  G_OBJECT_CLASS (ido_timeline_clock_parent_class)->finalize (object);
+}
+
+static void
+ido_timeline_clock_class_init (IdoTimelineClockClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = ido_timeline_clock_finalize;
+}
+
+static void
+ido_timeline_clock_init (IdoTimelineClock *clock)
+{
+  clock->timelines = g_ptr_array_new ();
+}
+
+/**
+ * ido_timeline_clock_get_default:
+ *
+ * Returns the clock timelines run on unless another one was set with
+ * ido_timeline_set_clock(). It follows g_get_monotonic_time().
+ *
+ * Return Value: (transfer none): the default #IdoTimelineClock
+ **/
+IdoTimelineClock *
+ido_timeline_clock_get_default (void)
+{
+  static IdoTimelineClock *default_clock;
+
+  if (default_clock == NULL)
+    default_clock = g_object_new (IDO_TYPE_TIMELINE_CLOCK, NULL);
+
+  return default_clock;
+}
+
+/**
+ * ido_timeline_clock_new_manual:
+ *
+ * Creates a clock that starts at 0 and only moves forward when
+ * ido_timeline_clock_advance() is called. Timelines on it never wake
+ * up the main loop, so whole runs can be stepped through synchronously
+ * and replayed exactly.
+ *
+ * Return Value: (transfer full): a new manual #IdoTimelineClock
+ **/
+IdoTimelineClock *
+ido_timeline_clock_new_manual (void)
+{
+  IdoTimelineClock *clock;
+
+  clock = g_object_new (IDO_TYPE_TIMELINE_CLOCK, NULL);
+  clock->manual = TRUE;
+
+  return clock;
+}
+
+/**
+ * ido_timeline_clock_get_time:
+ * @clock: A #IdoTimelineClock
+ *
+ * Return Value: the current time of @clock, in microseconds
+ **/
+gint64
+ido_timeline_clock_get_time (IdoTimelineClock *clock)
+{
+  g_return_val_if_fail (IDO_IS_TIMELINE_CLOCK (clock), 0);
+
+  if (clock->manual)
+    return clock->time;
+
+  return g_get_monotonic_time ();
+}
+
+static void
+ido_timeline_clock_count_wakeup (IdoTimelineClock *clock,
+                                 gint64            now)
+{
+  clock->wakeups++;
+  clock->window_wakeups++;
+
+  if (now - clock->window_start >= G_USEC_PER_SEC)
+    {
+      clock->wakeups_per_second = clock->window_wakeups * (gdouble) G_USEC_PER_SEC / (now - clock->window_start);
+      clock->window_start = now;
+      clock->window_wakeups = 0;
+    }
+}
+
+static void
+ido_timeline_clock_tick (IdoTimelineClock *clock)
+{
+  GPtrArray *timelines;
+  gint64 now;
+  guint i;
+
+  now = ido_timeline_clock_get_time (clock);
+  ido_timeline_clock_count_wakeup (clock, now);
+
+  /* handlers may start and stop timelines */
+  timelines = g_ptr_array_new_full (clock->timelines->len, g_object_unref);
+  for (i = 0; i < clock->timelines->len; i++)
+    g_ptr_array_add (timelines, g_object_ref (g_ptr_array_index (clock->timelines, i)));
+
+  for (i = 0; i < timelines->len; i++)
+    {
+      IdoTimeline *timeline = g_ptr_array_index (timelines, i);
+      IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+      gint64 elapsed;
+
+      /* stopped by an earlier handler in this pass, or moved to
+       * another clock */
+      if (!priv->scheduled || priv->clock != clock)
+        continue;
+
+      elapsed = MAX (now - priv->last_frame_time, 0);
+      priv->last_frame_time = now;
+
+      ido_timeline_advance (timeline, elapsed / 1000.);
+    }
+
+  g_ptr_array_unref (timelines);
+}
+
+static gboolean
+ido_timeline_clock_timeout (gpointer user_data)
+{
+  ido_timeline_clock_tick (user_data);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/**
+ * ido_timeline_clock_advance:
+ * @clock: A manual #IdoTimelineClock
+ * @usecs: microseconds to move @clock forward by
+ *
+ * Moves @clock forward and advances every timeline running on it by
+ * one frame, before returning.
+ **/
+void
+ido_timeline_clock_advance (IdoTimelineClock *clock,
+                            gint64            usecs)
+{
+  g_return_if_fail (IDO_IS_TIMELINE_CLOCK (clock));
+  g_return_if_fail (clock->manual);
+  g_return_if_fail (usecs >= 0);
+
+  clock->time += usecs;
+
+  if (clock->timelines->len > 0)
+    ido_timeline_clock_tick (clock);
+}
+
+/**
+ * ido_timeline_clock_get_n_running:
+ * @clock: A #IdoTimelineClock
+ *
+ * Return Value: the number of timelines currently running on @clock
+ **/
+guint
+ido_timeline_clock_get_n_running (IdoTimelineClock *clock)
+{
+  g_return_val_if_fail (IDO_IS_TIMELINE_CLOCK (clock), 0);
+
+  return clock->timelines->len;
+}
+
+/**
+ * ido_timeline_clock_get_wakeups_per_second:
+ * @clock: A #IdoTimelineClock
+ *
+ * Returns how many times per second @clock woke up to advance its
+ * timelines, measured over the last second of clock time it had any
+ * running. This is 0 while no timeline is running on it.
+ *
+ * Return Value: wakeups per second
+ **/
+gdouble
+ido_timeline_clock_get_wakeups_per_second (IdoTimelineClock *clock)
+{
+  g_return_val_if_fail (IDO_IS_TIMELINE_CLOCK (clock), 0);
+
+  return clock->wakeups_per_second;
+}
+
+static void
+ido_timeline_clock_update (IdoTimelineClock *clock)
+{
+  guint interval = 0;
+  guint i;
+
+  if (clock->timelines->len == 0)
+    {
+      /* fully idle: no source and nothing to report */
+      if (clock->source_id)
+        {
+          g_source_remove (clock->source_id);
+          clock->source_id = 0;
+        }
+
+      clock->window_start = 0;
+      clock->window_wakeups = 0;
+      clock->wakeups_per_second = 0;
+      return;
+    }
+
+  if (clock->window_start == 0)
+    clock->window_start = ido_timeline_clock_get_time (clock);
+
+  /* manual clocks are only ever ticked by ido_timeline_clock_advance() */
+  if (clock->manual)
+    return;
+
+  for (i = 0; i < clock->timelines->len; i++)
+    {
+      IdoTimelinePrivate *priv = ido_timeline_get_instance_private (g_ptr_array_index (clock->timelines, i));
+
+      if (interval == 0 || FRAME_INTERVAL (priv->fps) < interval)
+        interval = FRAME_INTERVAL (priv->fps);
+    }
+
+  if (interval == clock->interval && clock->source_id)
+    return;
+
+  if (clock->source_id)
+    g_source_remove (clock->source_id);
+
+  clock->interval = interval;
+  clock->source_id = gdk_threads_add_timeout (interval, ido_timeline_clock_timeout, clock);
+}
+
+static gint64
+ido_timeline_now (IdoTimelinePrivate *priv)
+{
+  if (priv->frame_clock)
+    return gdk_frame_clock_get_frame_time (priv->frame_clock);
+
+  return ido_timeline_clock_get_time (priv->clock);
+}
+
+static void
+ido_timeline_schedule (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+
+  g_ptr_array_add (priv->clock->timelines, timeline);
+  priv->scheduled = TRUE;
+  priv->last_frame_time = ido_timeline_clock_get_time (priv->clock);
+
+  ido_timeline_clock_update (priv->clock);
+}
+
+static void
+ido_timeline_unschedule (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+
+  g_ptr_array_remove_fast (priv->clock->timelines, timeline);
+  priv->scheduled = FALSE;
+
+  ido_timeline_clock_update (priv->clock);
+}
+
+/**
+ * ido_timeline_get_wakeups_per_second:
+ *
+ * Returns how many times per second the default #IdoTimelineClock
+ * woke up to advance timelines that are not driven by a frame clock.
+ * See ido_timeline_clock_get_wakeups_per_second().
+ *
+ * Return Value: scheduler wakeups per second
+ **/
+gdouble
+ido_timeline_get_wakeups_per_second (void)
+{
+  return ido_timeline_clock_get_wakeups_per_second (ido_timeline_clock_get_default ());
+}
+
+static gboolean
+ido_timeline_is_active (IdoTimelinePrivate *priv)
+{
+  return priv->update_id != 0 || priv->scheduled;
+}
+
+static void
+ido_timeline_stop_source (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+
+  if (priv->scheduled)
+    ido_timeline_unschedule (timeline);
+
+  if (priv->update_id)
+    {
+      g_signal_handler_disconnect (priv->frame_clock, priv->update_id);
+      priv->update_id = 0;
+      gdk_frame_clock_end_updating (priv->frame_clock);
+    }
+
+  if (priv->unrealize_id)
+    {
+      g_signal_handler_disconnect (priv->frame_widget, priv->unrealize_id);
+      priv->unrealize_id = 0;
+      priv->frame_widget = NULL;
+    }
+
+  g_clear_object (&priv->frame_clock);
+}
+
+static void
+ido_timeline_record_frame (IdoTimelinePrivate *priv,
+                           gdouble             elapsed)
+{
+  gdouble target = FRAME_INTERVAL (priv->fps);
+  guint bucket;
+
+  if (!priv->animations_enabled)
+    {
+      /* the frames the animation would have had until the end */
+      gdouble remaining = (priv->direction == IDO_TIMELINE_DIRECTION_FORWARD) ?
+                          1. - priv->last_progress : priv->last_progress;
+
+      priv->stats.skipped_frames += ceil (CLAMP (remaining, 0., 1.) * priv->duration / target);
+      return;
+    }
+
+  priv->stats.frames++;
+
+  bucket = MIN (elapsed * 2 / target, IDO_TIMELINE_STATS_N_BUCKETS - 1);
+  priv->stats.histogram[bucket]++;
+
+  /* more than half a frame behind */
+  if (elapsed > target * 1.5)
+    priv->stats.late_frames++;
+
+  priv->stats.max_interval = MAX (priv->stats.max_interval, elapsed);
+}
+
+static void
+ido_timeline_dump_stats (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+  GString *histogram;
+  guint i;
+
+  if (g_getenv ("G_MESSAGES_DEBUG") == NULL)
+    return;
+
+  histogram = g_string_new (NULL);
+  for (i = 0; i < IDO_TIMELINE_STATS_N_BUCKETS; i++)
+    g_string_append_printf (histogram, " %u", priv->stats.histogram[i]);
+
+  g_debug ("timeline %p finished: %u frames at %u fps, %u late, %u skipped, "
+           "longest %.1f ms, intervals in half frames:%s",
+           timeline, priv->stats.frames, priv->fps, priv->stats.late_frames,
+           priv->stats.skipped_frames, priv->stats.max_interval, histogram->str);
+
+  g_string_free (histogram, TRUE);
+}
+
+/*
+ * Moves the timeline @elapsed milliseconds forward and emits ::frame.
+ * Returns %FALSE if the timeline finished and stopped.
+ */
 static gboolean
-ido_timeline_run_frame (IdoTimeline *timeline)
+ido_timeline_advance (IdoTimeline *timeline,
+                      gdouble      elapsed)
 {
   gdouble delta_progress, progress;
-  guint elapsed_time;
 
   IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
 
-  elapsed_time = (guint) (g_timer_elapsed (priv->timer, NULL) * 1000);
-  g_timer_start (priv->timer);
+  ido_timeline_record_frame (priv, elapsed);
 
-  if (priv->animations_enabled)
+  /* a timeline without length has nothing to animate, and 0 / 0 would
+   * make the progress NaN, which never reaches the end */
+  if (priv->animations_enabled && priv->duration > 0)
     {
-      delta_progress = (gdouble) elapsed_time / priv->duration;
+      delta_progress = elapsed / priv->duration;
       progress = priv->last_progress;
 
       if (priv->direction == IDO_TIMELINE_DIRECTION_BACKWARD)
@@ -312,7 +794,10 @@ ido_timeline_run_frame (IdoTimeline *timeline)
       progress = CLAMP (progress, 0., 1.);
     }
   else
-    progress = (priv->direction == IDO_TIMELINE_DIRECTION_FORWARD) ? 1.0 : 0.0;
+    {
+      progress = (priv->direction == IDO_TIMELINE_DIRECTION_FORWARD) ? 1.0 : 0.0;
+      priv->last_progress = progress;
+    }
 
   priv->progress = progress;
   g_signal_emit (timeline, signals [FRAME], 0, progress);
@@ -320,14 +805,11 @@ ido_timeline_run_frame (IdoTimeline *timeline)
   if ((priv->direction == IDO_TIMELINE_DIRECTION_FORWARD && progress == 1.0) ||
       (priv->direction == IDO_TIMELINE_DIRECTION_BACKWARD && progress == 0.0))
     {
-      if (!priv->loop)
+      /* without animations there is nothing to loop */
+      if (!priv->loop || !priv->animations_enabled)
 	{
-	  if (priv->source_id)
-	    {
-	      g_source_remove (priv->source_id);
-	      priv->source_id = 0;
-	    }
-          g_timer_stop (priv->timer);
+	  ido_timeline_stop_source (timeline);
+	  ido_timeline_dump_stats (timeline);
 	  g_signal_emit (timeline, signals [FINISHED], 0);
 	  return FALSE;
 	}
@@ -338,6 +820,81 @@ ido_timeline_run_frame (IdoTimeline *timeline)
   return TRUE;
 }
 
+static void
+ido_timeline_enable_animations_changed (GtkSettings *settings,
+                                        GParamSpec  *pspec,
+                                        IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+  gboolean enable_animations;
+
+  g_object_get (settings, "gtk-enable-animations", &enable_animations, NULL);
+
+  /* a running animation finishes as soon as animations are turned
+   * off; turning them on applies from the next start */
+  if (!enable_animations && ido_timeline_is_active (priv))
+    {
+      ido_timeline_stop_source (timeline);
+      priv->animations_enabled = FALSE;
+      ido_timeline_advance (timeline, 0);
+    }
+}
+
+static void
+ido_timeline_watch_settings (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+  GtkSettings *settings = NULL;
+
+  if (priv->screen)
+    settings = gtk_settings_get_for_screen (priv->screen);
+
+  if (settings == priv->settings)
+    return;
+
+  if (priv->settings)
+    {
+      g_signal_handler_disconnect (priv->settings, priv->settings_id);
+      g_clear_object (&priv->settings);
+      priv->settings_id = 0;
+    }
+
+  if (settings)
+    {
+      priv->settings = g_object_ref (settings);
+      priv->settings_id = g_signal_connect (settings, "notify::gtk-enable-animations",
+                                            G_CALLBACK (ido_timeline_enable_animations_changed),
+                                            timeline);
+    }
+}
+
+static void
+ido_timeline_frame_clock_update (GdkFrameClock *frame_clock,
+                                 IdoTimeline   *timeline)
+{
+  IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timeline);
+  gint64 frame_time;
+  gint64 elapsed;
+
+  /* progress follows the time the frame will be presented at, not the
+   * time the handler happens to run */
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  elapsed = MAX (frame_time - priv->last_frame_time, 0);
+  priv->last_frame_time = frame_time;
+
+  ido_timeline_advance (timeline, elapsed / 1000.);
+}
+
+static void
+ido_timeline_widget_unrealized (GtkWidget   *widget,
+                                IdoTimeline *timeline)
+{
+  /* the frame clock of an unrealized widget doesn't tick anymore; the
+   * rest of the animation runs on the shared clock */
+  ido_timeline_stop_source (timeline);
+  ido_timeline_schedule (timeline);
+}
+
 /**
  * ido_timeline_new:
  * @duration: duration in milliseconds for the timeline
@@ -373,6 +930,29 @@ ido_timeline_new_for_screen (guint      duration,
 		       NULL);
 }
 
+/**
+ * ido_timeline_new_for_widget:
+ * @duration: duration in milliseconds for the timeline
+ * @widget: the #GtkWidget the timeline animates
+ *
+ * Creates a new #IdoTimeline that advances with the frame clock of
+ * @widget, on the screen of @widget.
+ *
+ * Return Value: the newly created #IdoTimeline
+ **/
+IdoTimeline *
+ido_timeline_new_for_widget (guint      duration,
+                             GtkWidget *widget)
+{
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), NULL);
+
+  return g_object_new (IDO_TYPE_TIMELINE,
+		       "duration", duration,
+		       "screen", gtk_widget_get_screen (widget),
+		       "widget", widget,
+		       NULL);
+}
+
 /**
  * ido_timeline_start:
  * @timeline: A #IdoTimeline
@@ -383,44 +963,49 @@ void
 ido_timeline_start (IdoTimeline *timeline)
 {
   IdoTimelinePrivate *priv;
-  gboolean enable_animations = FALSE;
+  gboolean enable_animations = TRUE;
 
   g_return_if_fail (IDO_IS_TIMELINE (timeline));
 
   priv = ido_timeline_get_instance_private (timeline);
 
-  if (!priv->source_id)
+  if (!ido_timeline_is_active (priv))
     {
-      if (priv->timer)
-        g_timer_continue (priv->timer);
-      else
-        priv->timer = g_timer_new ();
-
       /* sanity check; CID: 12651 */
       priv->fps = priv->fps > 0 ? priv->fps : DEFAULT_FPS;
 
-      if (priv->screen)
-        {
-#if 0
-          GtkSettings *settings = gtk_settings_get_for_screen (priv->screen);
-          g_object_get (settings, "ido-enable-animations", &enable_animations, NULL);
-#else
-          // XXX
-          enable_animations = TRUE;
-#endif
-        }
+      if (priv->settings)
+        g_object_get (priv->settings, "gtk-enable-animations", &enable_animations, NULL);
 
       priv->animations_enabled = (enable_animations == TRUE);
 
       g_signal_emit (timeline, signals [STARTED], 0);
 
-      if (enable_animations)
-        priv->source_id = gdk_threads_add_timeout (FRAME_INTERVAL (priv->fps),
-                                                   (GSourceFunc) ido_timeline_run_frame,
-                                                   timeline);
+      if (priv->widget && enable_animations &&
+          priv->clock == ido_timeline_clock_get_default ())
+        priv->frame_clock = gtk_widget_get_frame_clock (priv->widget);
+
+      if (priv->frame_clock)
+        {
+          g_object_ref (priv->frame_clock);
+          priv->last_frame_time = g_get_monotonic_time ();
+          priv->update_id = g_signal_connect (priv->frame_clock, "update",
+                                              G_CALLBACK (ido_timeline_frame_clock_update),
+                                              timeline);
+          gdk_frame_clock_begin_updating (priv->frame_clock);
+
+          priv->frame_widget = priv->widget;
+          priv->unrealize_id = g_signal_connect (priv->frame_widget, "unrealize",
+                                                 G_CALLBACK (ido_timeline_widget_unrealized),
+                                                 timeline);
+        }
+      else if (enable_animations)
+        ido_timeline_schedule (timeline);
       else
-        priv->source_id = gdk_threads_add_idle ((GSourceFunc) ido_timeline_run_frame,
-                                                timeline);
+        {
+          /* jump to the end right away, without waking up again */
+          ido_timeline_advance (timeline, 0);
+        }
     }
 }
 
@@ -439,11 +1024,9 @@ ido_timeline_pause (IdoTimeline *timeline)
 
   priv = ido_timeline_get_instance_private (timeline);
 
-  if (priv->source_id)
+  if (ido_timeline_is_active (priv))
     {
-      g_timer_stop (priv->timer);
-      g_source_remove (priv->source_id);
-      priv->source_id = 0;
+      ido_timeline_stop_source (timeline);
       g_signal_emit (timeline, signals [PAUSED], 0);
     }
 }
@@ -468,14 +1051,9 @@ ido_timeline_rewind (IdoTimeline *timeline)
   else
     priv->progress = priv->last_progress = 0.;
 
-  /* reset timer */
-  if (priv->timer)
-    {
-      g_timer_start (priv->timer);
-
-      if (!priv->source_id)
-        g_timer_stop (priv->timer);
-    }
+  /* restart measuring time from here */
+  if (ido_timeline_is_active (priv))
+    priv->last_frame_time = ido_timeline_now (priv);
 }
 
 /**
@@ -495,7 +1073,7 @@ ido_timeline_is_running (IdoTimeline *timeline)
 
   priv = ido_timeline_get_instance_private (timeline);
 
-  return (priv->source_id != 0);
+  return ido_timeline_is_active (priv);
 }
 
 /**
@@ -540,13 +1118,9 @@ ido_timeline_set_fps (IdoTimeline *timeline,
   /* Coverity CID: 12650/12651: guard against division by 0. */
   priv->fps = fps > 0 ? fps : priv->fps;
 
-  if (ido_timeline_is_running (timeline))
-    {
-      g_source_remove (priv->source_id);
-      priv->source_id = gdk_threads_add_timeout (FRAME_INTERVAL (priv->fps),
-						 (GSourceFunc) ido_timeline_run_frame,
-						 timeline);
-    }
+  /* frame clock driven timelines don't depend on the frame rate */
+  if (priv->scheduled)
+    ido_timeline_clock_update (priv->clock);
 
   g_object_notify (G_OBJECT (timeline), "fps");
 }
@@ -708,6 +1282,8 @@ ido_timeline_set_screen (IdoTimeline *timeline,
 
   priv->screen = g_object_ref (screen);
 
+  ido_timeline_watch_settings (timeline);
+
   g_object_notify (G_OBJECT (timeline), "screen");
 }
 
@@ -731,6 +1307,120 @@ ido_timeline_get_screen (IdoTimeline *timeline)
   return priv->screen;
 }
 
+/**
+ * ido_timeline_set_widget:
+ * @timeline: A #IdoTimeline
+ * @widget: (allow-none): the #GtkWidget the timeline animates, or %NULL
+ *
+ * Sets the widget whose frame clock drives the timeline. This takes
+ * effect the next time the timeline is started. @widget is not
+ * referenced.
+ */
+void
+ido_timeline_set_widget (IdoTimeline *timeline,
+                         GtkWidget   *widget)
+{
+  IdoTimelinePrivate *priv;
+
+  g_return_if_fail (IDO_IS_TIMELINE (timeline));
+  g_return_if_fail (widget == NULL || GTK_IS_WIDGET (widget));
+
+  priv = ido_timeline_get_instance_private (timeline);
+
+  if (priv->widget == widget)
+    return;
+
+  if (priv->widget)
+    g_object_remove_weak_pointer (G_OBJECT (priv->widget), (gpointer *) &priv->widget);
+
+  priv->widget = widget;
+
+  if (priv->widget)
+    g_object_add_weak_pointer (G_OBJECT (priv->widget), (gpointer *) &priv->widget);
+
+  g_object_notify (G_OBJECT (timeline), "widget");
+}
+
+/**
+ * ido_timeline_get_widget:
+ * @timeline: A #IdoTimeline
+ *
+ * Get the widget whose frame clock drives the timeline.
+ *
+ * Return Value: (transfer none) (nullable): The #GtkWidget, or %NULL.
+ */
+GtkWidget *
+ido_timeline_get_widget (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv;
+
+  g_return_val_if_fail (IDO_IS_TIMELINE (timeline), NULL);
+
+  priv = ido_timeline_get_instance_private (timeline);
+
+  return priv->widget;
+}
+
+/**
+ * ido_timeline_set_clock:
+ * @timeline: A #IdoTimeline
+ * @clock: (nullable): A #IdoTimelineClock, or %NULL for the default one
+ *
+ * Sets the clock that advances @timeline. A timeline running on a clock
+ * moves to the new one right away and measures time from there on; one
+ * following a frame clock switches the next time it is started.
+ **/
+void
+ido_timeline_set_clock (IdoTimeline      *timeline,
+                        IdoTimelineClock *clock)
+{
+  IdoTimelinePrivate *priv;
+  gboolean scheduled;
+
+  g_return_if_fail (IDO_IS_TIMELINE (timeline));
+  g_return_if_fail (clock == NULL || IDO_IS_TIMELINE_CLOCK (clock));
+
+  priv = ido_timeline_get_instance_private (timeline);
+
+  if (clock == NULL)
+    clock = ido_timeline_clock_get_default ();
+
+  if (clock == priv->clock)
+    return;
+
+  scheduled = priv->scheduled;
+  if (scheduled)
+    ido_timeline_unschedule (timeline);
+
+  g_object_unref (priv->clock);
+  priv->clock = g_object_ref (clock);
+
+  if (scheduled)
+    ido_timeline_schedule (timeline);
+
+  g_object_notify (G_OBJECT (timeline), "clock");
+}
+
+/**
+ * ido_timeline_get_clock:
+ * @timeline: A #IdoTimeline
+ *
+ * Get the clock that advances the timeline.
+ *
+ * Return Value: (transfer none): The #IdoTimelineClock
+ */
+IdoTimelineClock *
+ido_timeline_get_clock (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv;
+
+  g_return_val_if_fail (IDO_IS_TIMELINE (timeline), NULL);
+
+  priv = ido_timeline_get_instance_private (timeline);
+
+  return priv->clock;
+}
+
 /**
  * ido_timeline_get_progress:
  * @timeline: A #IdoTimeline
@@ -767,18 +1457,56 @@ ido_timeline_set_progress (IdoTimeline *timeline, gdouble progress)
 
   priv = ido_timeline_get_instance_private (timeline);
 
-  if (priv->source_id)
-    {
-      g_timer_stop (priv->timer);
-      g_source_remove (priv->source_id);
-      priv->source_id = 0;
-    }
+  if (ido_timeline_is_active (priv))
+    ido_timeline_stop_source (timeline);
 
   priv->progress = priv->last_progress = progress;
 
   ido_timeline_start (timeline);
 }
 
+/**
+ * ido_timeline_get_stats:
+ * @timeline: A #IdoTimeline
+ * @stats: (out caller-allocates): where to store the statistics
+ *
+ * Gets the frame statistics @timeline collected since it was created
+ * or since ido_timeline_reset_stats() was last called. With
+ * G_MESSAGES_DEBUG set, they are also logged whenever the timeline
+ * finishes.
+ */
+void
+ido_timeline_get_stats (IdoTimeline      *timeline,
+                        IdoTimelineStats *stats)
+{
+  IdoTimelinePrivate *priv;
+
+  g_return_if_fail (IDO_IS_TIMELINE (timeline));
+  g_return_if_fail (stats != NULL);
+
+  priv = ido_timeline_get_instance_private (timeline);
+
+  *stats = priv->stats;
+}
+
+/**
+ * ido_timeline_reset_stats:
+ * @timeline: A #IdoTimeline
+ *
+ * Clears the frame statistics of @timeline.
+ */
+void
+ido_timeline_reset_stats (IdoTimeline *timeline)
+{
+  IdoTimelinePrivate *priv;
+
+  g_return_if_fail (IDO_IS_TIMELINE (timeline));
+
+  priv = ido_timeline_get_instance_private (timeline);
+
+  memset (&priv->stats, 0, sizeof (IdoTimelineStats));
+}
+
 /**
  * ido_timeline_calculate_progress:
  * @linear_progress: The progress from 0.0 (start) to 1.0 (end)
@@ -819,3 +1547,293 @@ ido_timeline_calculate_progress (gdouble                 linear_progress,
 
   return progress;
 }
+
+/*
+ * Easing curves are sampled once into a table of evenly spaced progress
+ * values and evaluated by linear interpolation between neighbouring
+ * samples, so the per-frame cost does not depend on the curve.
+ */
+#define EASING_CURVE_SAMPLES 257
+
+struct _IdoEasingCurve
+{
+  gint ref_count;
+  gfloat samples[EASING_CURVE_SAMPLES];
+};
+
+G_DEFINE_BOXED_TYPE (IdoEasingCurve, ido_easing_curve,
+                     ido_easing_curve_ref, ido_easing_curve_unref)
+
+static IdoEasingCurve *
+ido_easing_curve_alloc (void)
+{
+  IdoEasingCurve *curve;
+
+  curve = g_slice_new (IdoEasingCurve);
+  curve->ref_count = 1;
+
+  return curve;
+}
+
+/**
+ * ido_easing_curve_new_for_type:
+ * @progress_type: One of the built-in transforms
+ *
+ * Creates a curve that samples ido_timeline_calculate_progress() for
+ * @progress_type.
+ *
+ * Return Value: (transfer full): a new #IdoEasingCurve
+ **/
+IdoEasingCurve *
+ido_easing_curve_new_for_type (IdoTimelineProgressType progress_type)
+{
+  IdoEasingCurve *curve;
+  guint i;
+
+  curve = ido_easing_curve_alloc ();
+
+  for (i = 0; i < EASING_CURVE_SAMPLES; i++)
+    curve->samples[i] = ido_timeline_calculate_progress ((gdouble) i / (EASING_CURVE_SAMPLES - 1),
+                                                         progress_type);
+
+  return curve;
+}
+
+static gdouble
+cubic_bezier_coordinate (gdouble t,
+                         gdouble p1,
+                         gdouble p2)
+{
+  gdouble u = 1 - t;
+
+  return 3 * u * u * t * p1 + 3 * u * t * t * p2 + t * t * t;
+}
+
+static gdouble
+cubic_bezier_slope (gdouble t,
+                    gdouble p1,
+                    gdouble p2)
+{
+  gdouble u = 1 - t;
+
+  return 3 * u * u * p1 + 6 * u * t * (p2 - p1) + 3 * t * t * (1 - p2);
+}
+
+/**
+ * ido_easing_curve_new_cubic_bezier:
+ * @x1: x of the first control point, from 0.0 to 1.0
+ * @y1: y of the first control point
+ * @x2: x of the second control point, from 0.0 to 1.0
+ * @y2: y of the second control point
+ *
+ * Creates a curve following the cubic Bézier from (0, 0) to (1, 1)
+ * with the given control points, like CSS cubic-bezier(). The y values
+ * may lie outside of 0.0 to 1.0 to overshoot.
+ *
+ * Return Value: (transfer full): a new #IdoEasingCurve
+ **/
+IdoEasingCurve *
+ido_easing_curve_new_cubic_bezier (gdouble x1,
+                                   gdouble y1,
+                                   gdouble x2,
+                                   gdouble y2)
+{
+  IdoEasingCurve *curve;
+  guint i;
+
+  g_return_val_if_fail (x1 >= 0 && x1 <= 1, NULL);
+  g_return_val_if_fail (x2 >= 0 && x2 <= 1, NULL);
+
+  curve = ido_easing_curve_alloc ();
+
+  for (i = 0; i < EASING_CURVE_SAMPLES; i++)
+    {
+      gdouble x = (gdouble) i / (EASING_CURVE_SAMPLES - 1);
+      gdouble lower = 0, upper = 1;
+      gdouble t = x;
+      guint step;
+
+      /* x(t) is monotonic for x1, x2 in [0, 1]; refine t with Newton's
+       * method and keep a bracket to fall back to bisection */
+      for (step = 0; step < 32; step++)
+        {
+          gdouble error = cubic_bezier_coordinate (t, x1, x2) - x;
+          gdouble slope;
+
+          if (fabs (error) < 1e-7)
+            break;
+
+          if (error < 0)
+            lower = t;
+          else
+            upper = t;
+
+          slope = cubic_bezier_slope (t, x1, x2);
+          t -= error / slope;
+
+          if (slope == 0 || t <= lower || t >= upper)
+            t = (lower + upper) / 2;
+        }
+
+      curve->samples[i] = cubic_bezier_coordinate (t, y1, y2);
+    }
+
+  return curve;
+}
+
+/**
+ * ido_easing_curve_new_spring:
+ * @damping_ratio: how quickly oscillations die out; 1.0 is critically
+ *   damped, smaller values bounce past the end
+ *
+ * Creates a curve following a spring released from 0 towards 1. The
+ * timeline's duration is stretched over the time the spring takes to
+ * settle within 0.1% of the end, so its stiffness only depends on the
+ * duration.
+ *
+ * Return Value: (transfer full): a new #IdoEasingCurve
+ **/
+IdoEasingCurve *
+ido_easing_curve_new_spring (gdouble damping_ratio)
+{
+  IdoEasingCurve *curve;
+  gdouble settle;
+  guint i;
+
+  g_return_val_if_fail (damping_ratio > 0, NULL);
+
+  curve = ido_easing_curve_alloc ();
+
+  /* unit natural frequency; the slowest decaying term drops to 1e-3 */
+  if (damping_ratio < 1)
+    settle = log (1000) / damping_ratio;
+  else
+    settle = log (1000) / (damping_ratio - sqrt (damping_ratio * damping_ratio - 1));
+
+  for (i = 0; i < EASING_CURVE_SAMPLES; i++)
+    {
+      gdouble t = settle * i / (EASING_CURVE_SAMPLES - 1);
+      gdouble position;
+
+      if (damping_ratio < 1)
+        {
+          gdouble frequency = sqrt (1 - damping_ratio * damping_ratio);
+
+          position = 1 - exp (-damping_ratio * t) *
+                         (cos (frequency * t) + damping_ratio / frequency * sin (frequency * t));
+        }
+      else if (damping_ratio == 1)
+        position = 1 - exp (-t) * (1 + t);
+      else
+        {
+          gdouble root = sqrt (damping_ratio * damping_ratio - 1);
+          gdouble r1 = -damping_ratio + root;
+          gdouble r2 = -damping_ratio - root;
+
+          position = 1 - (r2 * exp (r1 * t) - r1 * exp (r2 * t)) / (r2 - r1);
+        }
+
+      curve->samples[i] = position;
+    }
+
+  /* land exactly on the end */
+  curve->samples[EASING_CURVE_SAMPLES - 1] = 1;
+
+  return curve;
+}
+
+/**
+ * ido_easing_curve_ref:
+ * @curve: A #IdoEasingCurve
+ *
+ * Return Value: (transfer full): @curve
+ **/
+IdoEasingCurve *
+ido_easing_curve_ref (IdoEasingCurve *curve)
+{
+  g_return_val_if_fail (curve != NULL, NULL);
+
+  g_atomic_int_inc (&curve->ref_count);
+
+  return curve;
+}
+
+/**
+ * ido_easing_curve_unref:
+ * @curve: A #IdoEasingCurve
+ **/
+void
+ido_easing_curve_unref (IdoEasingCurve *curve)
+{
+  g_return_if_fail (curve != NULL);
+
+  if (g_atomic_int_dec_and_test (&curve->ref_count))
+    g_slice_free (IdoEasingCurve, curve);
+}
+
+static inline gdouble
+ido_easing_curve_lookup (const IdoEasingCurve *curve,
+                         gdouble               progress)
+{
+  gdouble position;
+  guint index;
+
+  if (!(progress > 0))
+    return curve->samples[0];
+
+  if (progress >= 1)
+    return curve->samples[EASING_CURVE_SAMPLES - 1];
+
+  position = progress * (EASING_CURVE_SAMPLES - 1);
+  index = (guint) position;
+
+  return curve->samples[index] + (position - index) * (curve->samples[index + 1] - curve->samples[index]);
+}
+
+/**
+ * ido_easing_curve_evaluate:
+ * @curve: A #IdoEasingCurve
+ * @linear_progress: The progress from 0.0 (start) to 1.0 (end)
+ *
+ * Transform a linear progress position using @curve.
+ *
+ * Return Value: the eased progress position
+ **/
+gdouble
+ido_easing_curve_evaluate (IdoEasingCurve *curve,
+                           gdouble         linear_progress)
+{
+  g_return_val_if_fail (curve != NULL, linear_progress);
+
+  return ido_easing_curve_lookup (curve, linear_progress);
+}
+
+/**
+ * ido_easing_curve_evaluate_timelines:
+ * @curve: A #IdoEasingCurve
+ * @timelines: (array length=n_timelines): timelines to read the progress of
+ * @n_timelines: the number of timelines
+ * @eased_progress: (out caller-allocates) (array length=n_timelines):
+ *   where to store the eased progress of each timeline
+ *
+ * Evaluates @curve for the current progress of many timelines at once,
+ * for callers that animate several things from one ::frame handler.
+ **/
+void
+ido_easing_curve_evaluate_timelines (IdoEasingCurve  *curve,
+                                     IdoTimeline    **timelines,
+                                     guint            n_timelines,
+                                     gdouble         *eased_progress)
+{
+  guint i;
+
+  g_return_if_fail (curve != NULL);
+  g_return_if_fail (n_timelines == 0 || (timelines != NULL && eased_progress != NULL));
+
+  for (i = 0; i < n_timelines; i++)
+    {
+      IdoTimelinePrivate *priv = ido_timeline_get_instance_private (timelines[i]);
+
+      eased_progress[i] = ido_easing_curve_lookup (curve, priv->progress);
+    }
+}
@@ -33,9 +33,20 @@ G_BEGIN_DECLS
 #define IDO_IS_TIMELINE_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), IDO_TYPE_TIMELINE))
 #define IDO_TIMELINE_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), IDO_TYPE_TIMELINE, IdoTimelineClass))
 
+#define IDO_TYPE_TIMELINE_CLOCK         (ido_timeline_clock_get_type ())
+#define IDO_TIMELINE_CLOCK(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), IDO_TYPE_TIMELINE_CLOCK, IdoTimelineClock))
+#define IDO_IS_TIMELINE_CLOCK(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), IDO_TYPE_TIMELINE_CLOCK))
+
 typedef struct IdoTimeline      IdoTimeline;
 typedef struct IdoTimelineClass IdoTimelineClass;
 
+#define IDO_TYPE_EASING_CURVE           (ido_easing_curve_get_type ())
+
+typedef struct _IdoTimelineClock      IdoTimelineClock;
+typedef struct _IdoTimelineClockClass IdoTimelineClockClass;
+
+typedef struct _IdoEasingCurve        IdoEasingCurve;
+
 typedef enum {
   IDO_TIMELINE_DIRECTION_FORWARD,
   IDO_TIMELINE_DIRECTION_BACKWARD
@@ -48,6 +59,30 @@ typedef enum {
   IDO_TIMELINE_PROGRESS_EASE_IN_EASE_OUT
 } IdoTimelineProgressType;
 
+#define IDO_TIMELINE_STATS_N_BUCKETS 8
+
+/**
+ * IdoTimelineStats:
+ * @frames: frames emitted while animating
+ * @late_frames: frames that came more than half a frame interval
+ *   later than #IdoTimeline:fps asks for
+ * @skipped_frames: frames that were not drawn because animations were
+ *   disabled and the timeline jumped to its end
+ * @max_interval: the longest time between two frames, in milliseconds
+ * @histogram: time between frames, in buckets of half the frame
+ *   interval; the last bucket holds everything longer
+ *
+ * Frame timing statistics of an #IdoTimeline.
+ */
+typedef struct
+{
+  guint frames;
+  guint late_frames;
+  guint skipped_frames;
+  gdouble max_interval;
+  guint histogram[IDO_TIMELINE_STATS_N_BUCKETS];
+} IdoTimelineStats;
+
 struct IdoTimeline
 {
   GObject parent_instance;
@@ -76,6 +111,8 @@ GType                 ido_timeline_get_type            (void) G_GNUC_CONST;
 IdoTimeline           *ido_timeline_new                (guint                     duration);
 IdoTimeline           *ido_timeline_new_for_screen     (guint                     duration,
                                                         GdkScreen                *screen);
+IdoTimeline           *ido_timeline_new_for_widget     (guint                     duration,
+                                                        GtkWidget                *widget);
 
 void                  ido_timeline_start               (IdoTimeline              *timeline);
 void                  ido_timeline_pause               (IdoTimeline              *timeline);
@@ -99,6 +136,14 @@ GdkScreen            *ido_timeline_get_screen          (IdoTimeline
 void                  ido_timeline_set_screen          (IdoTimeline              *timeline,
                                                         GdkScreen                *screen);
 
+GtkWidget            *ido_timeline_get_widget          (IdoTimeline              *timeline);
+void                  ido_timeline_set_widget          (IdoTimeline              *timeline,
+                                                        GtkWidget                *widget);
+
+IdoTimelineClock     *ido_timeline_get_clock           (IdoTimeline              *timeline);
+void                  ido_timeline_set_clock           (IdoTimeline              *timeline,
+                                                        IdoTimelineClock         *clock);
+
 IdoTimelineDirection  ido_timeline_get_direction       (IdoTimeline              *timeline);
 void                  ido_timeline_set_direction       (IdoTimeline              *timeline,
                                                         IdoTimelineDirection      direction);
@@ -107,9 +152,45 @@ gdouble               ido_timeline_get_progress        (IdoTimeline
 void                  ido_timeline_set_progress        (IdoTimeline              *timeline,
                                                         gdouble                   progress);
 
+void                  ido_timeline_get_stats           (IdoTimeline              *timeline,
+                                                        IdoTimelineStats         *stats);
+void                  ido_timeline_reset_stats         (IdoTimeline              *timeline);
+
+gdouble               ido_timeline_get_wakeups_per_second (void);
+
+GType                 ido_timeline_clock_get_type      (void) G_GNUC_CONST;
+
+IdoTimelineClock     *ido_timeline_clock_get_default   (void);
+IdoTimelineClock     *ido_timeline_clock_new_manual    (void);
+
+gint64                ido_timeline_clock_get_time      (IdoTimelineClock         *clock);
+void                  ido_timeline_clock_advance       (IdoTimelineClock         *clock,
+                                                        gint64                    usecs);
+guint                 ido_timeline_clock_get_n_running (IdoTimelineClock         *clock);
+gdouble               ido_timeline_clock_get_wakeups_per_second (IdoTimelineClock *clock);
+
 gdouble               ido_timeline_calculate_progress  (gdouble                   linear_progress,
                                                         IdoTimelineProgressType   progress_type);
 
+GType                 ido_easing_curve_get_type        (void) G_GNUC_CONST;
+
+IdoEasingCurve       *ido_easing_curve_new_for_type    (IdoTimelineProgressType   progress_type);
+IdoEasingCurve       *ido_easing_curve_new_cubic_bezier (gdouble                  x1,
+                                                         gdouble                  y1,
+                                                         gdouble                  x2,
+                                                         gdouble                  y2);
+IdoEasingCurve       *ido_easing_curve_new_spring      (gdouble                   damping_ratio);
+
+IdoEasingCurve       *ido_easing_curve_ref             (IdoEasingCurve           *curve);
+void                  ido_easing_curve_unref           (IdoEasingCurve           *curve);
+
+gdouble               ido_easing_curve_evaluate        (IdoEasingCurve           *curve,
+                                                        gdouble                   linear_progress);
+void                  ido_easing_curve_evaluate_timelines (IdoEasingCurve        *curve,
+                                                           IdoTimeline          **timelines,
+                                                           guint                  n_timelines,
+                                                           gdouble               *eased_progress);
+
 G_END_DECLS
 
 #endif /* __IDO_TIMELINE_H__ */
@@ -205,6 +205,10 @@ ido_time_stamp_menu_item_set_date_time (IdoTimeStampMenuItem * self,
 
   priv = ido_time_stamp_menu_item_get_instance_private(self);
 
+  if (priv->date_time == date_time ||
+      (priv->date_time && date_time && g_date_time_equal (priv->date_time, date_time)))
+    return;
+
   g_clear_pointer (&priv->date_time, g_date_time_unref);
   if (date_time != NULL)
     priv->date_time = g_date_time_ref (date_time);
@@ -230,6 +234,9 @@ ido_time_stamp_menu_item_set_format (IdoTimeStampMenuItem * self,
 
   priv = ido_time_stamp_menu_item_get_instance_private(self);
 
+  if (!g_strcmp0 (priv->format, strftime_fmt))
+    return;
+
   g_free (priv->format);
   priv->format = g_strdup (strftime_fmt);
   update_timestamp_label (self);
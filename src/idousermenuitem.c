@@ -328,7 +328,7 @@ ido_user_menu_item_set_icon (IdoUserMenuItem * self, GIcon * icon)
 {
   IdoUserMenuItemPrivate * priv = ido_user_menu_item_get_instance_private(self);
 
-  if (priv->icon == icon)
+  if (g_icon_equal (priv->icon, icon))
     return;
 
   g_clear_object (&priv->icon);
@@ -384,7 +384,8 @@ ido_user_menu_item_set_label (IdoUserMenuItem * self, const char * label)
 {
   IdoUserMenuItemPrivate * priv = ido_user_menu_item_get_instance_private(self);
 
-  gtk_label_set_label (GTK_LABEL(priv->user_name), label);
+  if (g_strcmp0 (gtk_label_get_label (GTK_LABEL(priv->user_name)), label))
+    gtk_label_set_label (GTK_LABEL(priv->user_name), label);
 }
 
 GtkWidget*
@@ -402,76 +403,83 @@ ido_user_menu_item_new (void)
  * "org.ayatana.indicator.user-menu-item" and "org.ayatana.indicator.guest-menu-item",
  * since they only differ in how they use their action's state.
  */
-static GtkMenuItem *
-user_menu_item_new_from_model (GMenuItem    * menuitem,
-                               GActionGroup * actions,
-                               GCallback      state_changed_callback)
+static void
+user_menu_item_update_from_model (GtkMenuItem  * item,
+                                  GMenuItem    * menuitem,
+                                  GActionGroup * actions,
+                                  GCallback      state_changed_callback)
 {
-  guint i;
-  guint n;
   IdoUserMenuItem * ido_user;
-  gchar * str;
-  gchar * action;
+  IdoActionHelper * helper;
+  gchar * str = NULL;
+  gchar * action = NULL;
+  GVariant * target;
   GVariant * v;
-  const gchar * names [2];
-  GValue * values;
-  const guint n_max = 2;
-
-  /* create the ido_user */
+  GIcon * icon = NULL;
 
-  n = 0;
-  values = g_new0(GValue, n_max);
+  g_return_if_fail (IS_IDO_USER_MENU_ITEM (item));
 
-  if (g_menu_item_get_attribute (menuitem, G_MENU_ATTRIBUTE_LABEL, "s", &str))
+  if (menuitem == NULL)
     {
-      names[n] = "label";
-      g_value_init (&values[n], G_TYPE_STRING);
-      g_value_take_string (&values[n], str);
-      n++;
+      ido_action_helper_bind_widget (GTK_WIDGET (item), NULL, NULL, NULL);
+      ido_user_menu_item_set_label (IDO_USER_MENU_ITEM (item), NULL);
+      ido_user_menu_item_set_icon (IDO_USER_MENU_ITEM (item), NULL);
+      ido_user_menu_item_set_logged_in (IDO_USER_MENU_ITEM (item), FALSE);
+      ido_user_menu_item_set_current_user (IDO_USER_MENU_ITEM (item), FALSE);
+      return;
     }
 
+  ido_user = IDO_USER_MENU_ITEM (item);
+
+  g_menu_item_get_attribute (menuitem, G_MENU_ATTRIBUTE_LABEL, "s", &str);
+  ido_user_menu_item_set_label (ido_user, str);
+  g_free (str);
+
   if ((v = g_menu_item_get_attribute_value (menuitem, G_MENU_ATTRIBUTE_ICON, NULL)))
     {
-      names[n] = "icon";
-      GIcon * icon = g_icon_deserialize (v);
-      g_value_init (&values[n], G_TYPE_OBJECT);
-      g_value_take_object (&values[n], icon);
+      icon = g_icon_deserialize (v);
       g_variant_unref (v);
-      n++;
     }
 
-  g_assert (n <= G_N_ELEMENTS (names));
-  g_assert (n <= n_max);
-  ido_user = IDO_USER_MENU_ITEM(g_object_new_with_properties (IDO_USER_MENU_ITEM_TYPE, n, names, values));
-
-  for (i=0; i<n; i++)
-    g_value_unset (&values[i]);
+  ido_user_menu_item_set_icon (ido_user, icon);
+  g_clear_object (&icon);
 
-  g_free (values);
+  /* give it an ActionHelper */
 
-  /* gie it an ActionHelper */
+  g_menu_item_get_attribute (menuitem, G_MENU_ATTRIBUTE_ACTION, "s", &action);
+  target = g_menu_item_get_attribute_value (menuitem, G_MENU_ATTRIBUTE_TARGET, G_VARIANT_TYPE_ANY);
 
-  if (g_menu_item_get_attribute (menuitem, G_MENU_ATTRIBUTE_ACTION, "s", &action))
+  helper = ido_action_helper_bind_widget (GTK_WIDGET (ido_user), actions, action, target);
+  if (helper)
     {
-      IdoActionHelper *helper;
-      GVariant *target;
-
-      target = g_menu_item_get_attribute_value (menuitem, G_MENU_ATTRIBUTE_TARGET, G_VARIANT_TYPE_ANY);
-
-      helper = ido_action_helper_new (GTK_WIDGET (ido_user), actions, action, target);
       g_signal_connect (helper, "action-state-changed",
                         state_changed_callback, NULL);
 
       g_signal_connect_object (ido_user, "activate",
                                G_CALLBACK (ido_action_helper_activate),
                                helper, G_CONNECT_SWAPPED);
-      g_signal_connect_swapped (ido_user, "destroy", G_CALLBACK (g_object_unref), helper);
-
-      if (target)
-        g_variant_unref (target);
-      g_free (action);
     }
 
+  if (target)
+    g_variant_unref (target);
+  g_free (action);
+}
+
+/*
+ * This is a helper function for creating user menuitems for both
+ * "org.ayatana.indicator.user-menu-item" and "org.ayatana.indicator.guest-menu-item",
+ * since they only differ in how they use their action's state.
+ */
+static GtkMenuItem *
+user_menu_item_new_from_model (GMenuItem    * menuitem,
+                               GActionGroup * actions,
+                               GCallback      state_changed_callback)
+{
+  GtkWidget * ido_user;
+
+  ido_user = ido_user_menu_item_new ();
+  user_menu_item_update_from_model (GTK_MENU_ITEM (ido_user), menuitem, actions, state_changed_callback);
+
   return GTK_MENU_ITEM (ido_user);
 }
 
@@ -549,6 +557,27 @@ ido_user_menu_item_new_from_model (GMenuItem    *menuitem,
                                         G_CALLBACK(user_menu_item_state_changed));
 }
 
+/**
+ * ido_user_menu_item_update_from_model:
+ * @item: an #IdoUserMenuItem
+ * @menuitem: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menuitem's action
+ *
+ * Applies the attributes and action of @menuitem to an #IdoUserMenuItem
+ * built by ido_user_menu_item_new_from_model(). If @menuitem is %NULL,
+ * the item is left as blank as a new one, without an action binding.
+ */
+void
+ido_user_menu_item_update_from_model (GtkMenuItem  *item,
+                                      GMenuItem    *menuitem,
+                                      GActionGroup *actions)
+{
+  user_menu_item_update_from_model (item,
+                                    menuitem,
+                                    actions,
+                                    G_CALLBACK(user_menu_item_state_changed));
+}
+
 /***
 ****  org.ayatana.indicator.guest-menu-item handler
 ***/
@@ -585,3 +614,24 @@ ido_guest_menu_item_new_from_model (GMenuItem    *menuitem,
                                         G_CALLBACK(guest_menu_item_state_changed));
 }
 
+/**
+ * ido_guest_menu_item_update_from_model:
+ * @item: an #IdoUserMenuItem
+ * @menuitem: (nullable): the #GMenuItem to apply
+ * @actions: (nullable): the #GActionGroup of @menuitem's action
+ *
+ * Applies the attributes and action of @menuitem to an #IdoUserMenuItem
+ * built by ido_guest_menu_item_new_from_model(). If @menuitem is %NULL,
+ * the item is left as blank as a new one, without an action binding.
+ */
+void
+ido_guest_menu_item_update_from_model (GtkMenuItem  *item,
+                                       GMenuItem    *menuitem,
+                                       GActionGroup *actions)
+{
+  user_menu_item_update_from_model (item,
+                                    menuitem,
+                                    actions,
+                                    G_CALLBACK(guest_menu_item_state_changed));
+}
+
@@ -66,6 +66,14 @@ GtkMenuItem * ido_user_menu_item_new_from_model (GMenuItem    *menuitem,
 GtkMenuItem * ido_guest_menu_item_new_from_model (GMenuItem    *menuitem,
                                                   GActionGroup *actions);
 
+void ido_user_menu_item_update_from_model (GtkMenuItem  *item,
+                                           GMenuItem    *menuitem,
+                                           GActionGroup *actions);
+
+void ido_guest_menu_item_update_from_model (GtkMenuItem  *item,
+                                            GMenuItem    *menuitem,
+                                            GActionGroup *actions);
+
 G_END_DECLS
 
 #endif
@@ -29,6 +29,7 @@
 #include "idocalendarmenuitem.h"
 #include "idoscalemenuitem.h"
 #include "idoentrymenuitem.h"
+#include "idomenuitemfactory.h"
 
 void ido_init (void);
 
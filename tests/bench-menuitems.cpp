@@ -0,0 +1,373 @@
+#include <gtk/gtk.h>
+#include <gtest/gtest.h>
+#include "libayatana-ido.h"
+#include "ayatanamenuitemfactory.h"
+#include "idoactionhelper.h"
+#include "idotimeline.h"
+#include "idoblur.h"
+#include "idoplaybackmenuitem.h"
+#include "idoshadowcache.h"
+
+/* Microbenchmarks for hot paths in ido. They only report timings and
+ * are not part of the test suite; run bench-menuitems by hand. */
+
+#define BENCH_ITERATIONS 1000000
+#define BENCH_HELPERS 1000
+#define BENCH_EMISSIONS 100000
+#define BENCH_TIMELINES 10000
+#define BENCH_FRAME_USECS 16667
+#define BENCH_BLUR_PIXELS (1 << 22)
+#define BENCH_FRAMES 2000
+
+static const gchar *lTypes[] =
+{
+	"org.ayatana.indicator.user-menu-item",
+	"org.ayatana.indicator.guest-menu-item",
+	"org.ayatana.indicator.calendar",
+	"org.ayatana.indicator.location",
+	"org.ayatana.indicator.appointment",
+	"org.ayatana.indicator.alarm",
+	"org.ayatana.indicator.basic",
+	"org.ayatana.indicator.progress",
+	"org.ayatana.indicator.slider",
+	"org.ayatana.indicator.media-player",
+	"org.ayatana.indicator.playback-item",
+	"org.ayatana.indicator.application",
+	"org.ayatana.indicator.messages.source",
+	"org.ayatana.indicator.switch",
+	"org.ayatana.indicator.removable",
+	"org.ayatana.indicator.level",
+	"org.ayatana.indicator.bench"
+};
+
+static guint nConstructed = 0;
+
+static GtkMenuItem *
+bench_constructor(GMenuItem *menuitem, GActionGroup *actions)
+{
+	nConstructed++;
+	return NULL;
+}
+
+/* the string comparison ladder the factory used before the registry */
+static IdoMenuItemConstructor
+chain_lookup(const gchar *type)
+{
+	for (guint i = 0; i < G_N_ELEMENTS(lTypes) - 1; i++)
+	{
+		if (g_str_equal(type, lTypes[i]))
+			return bench_constructor;
+	}
+
+	if (g_str_equal(type, "org.ayatana.indicator.bench"))
+		return bench_constructor;
+
+	return NULL;
+}
+
+static void
+report(const gchar *sName, gint64 nStart, guint nIterations)
+{
+	gdouble fNs = (gdouble)(g_get_monotonic_time() - nStart) * 1000.0 / nIterations;
+
+	g_print("%-40s %8.1f ns/op\n", sName, fNs);
+}
+
+class BenchMenuitems : public ::testing::Test
+{
+public:
+	BenchMenuitems()
+	{
+		gint argc = 0;
+		gchar * argv[] = {NULL};
+		gtk_init(&argc, (gchar ***)&argv);
+		ido_init();
+		return;
+	}
+};
+
+TEST_F(BenchMenuitems, FactoryDispatch) {
+	GList *pFactories = ayatana_menu_item_factory_get_all();
+	AyatanaMenuItemFactory *pFactory = NULL;
+	GMenuItem *pMenuItem = g_menu_item_new("Bench", NULL);
+	GSimpleActionGroup *pActions = g_simple_action_group_new();
+
+	ASSERT_TRUE(pFactories != NULL);
+	pFactory = AYATANA_MENU_ITEM_FACTORY(pFactories->data);
+
+	ido_menu_item_factory_register_type("org.ayatana.indicator.bench", bench_constructor);
+
+	/* the last type is the worst case for the comparison ladder */
+	const gchar *sType = lTypes[G_N_ELEMENTS(lTypes) - 1];
+	gint64 nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_ITERATIONS; i++)
+		chain_lookup(sType)(pMenuItem, G_ACTION_GROUP(pActions));
+	report("string chain (worst case)", nStart, BENCH_ITERATIONS);
+
+	nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_ITERATIONS; i++)
+		ayatana_menu_item_factory_create_menu_item(pFactory, sType, pMenuItem, G_ACTION_GROUP(pActions));
+	report("quark registry", nStart, BENCH_ITERATIONS);
+
+	nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_ITERATIONS; i++)
+		ayatana_menu_item_factory_create_menu_item(pFactory, "org.ayatana.indicator.unknown", pMenuItem, G_ACTION_GROUP(pActions));
+	report("quark registry (unknown type)", nStart, BENCH_ITERATIONS);
+
+	EXPECT_EQ(nConstructed, 2u * BENCH_ITERATIONS);
+
+	ido_menu_item_factory_register_type("org.ayatana.indicator.bench", NULL);
+	EXPECT_TRUE(ido_menu_item_factory_lookup_type("org.ayatana.indicator.bench") == NULL);
+
+	g_object_unref(pActions);
+	g_object_unref(pMenuItem);
+	return;
+}
+
+static guint nStateChanges = 0;
+
+static void
+on_state_changed(IdoActionHelper *pHelper, GVariant *pState, gpointer pData)
+{
+	nStateChanges++;
+}
+
+/* time one action's state change with nHelpers helpers on the group,
+ * each watching a different action */
+static void
+bench_dispatch(const gchar *sName, guint nHelpers)
+{
+	GSimpleActionGroup *pActions = g_simple_action_group_new();
+	GPtrArray *lHelpers = g_ptr_array_new_with_free_func(g_object_unref);
+	GVariant *pState = g_variant_ref_sink(g_variant_new_boolean(TRUE));
+
+	for (guint i = 0; i < nHelpers; i++)
+	{
+		gchar *sAction = g_strdup_printf("action%u", i);
+		GtkWidget *pItem = gtk_menu_item_new();
+		IdoActionHelper *pHelper = ido_action_helper_new(pItem, G_ACTION_GROUP(pActions), sAction, NULL);
+
+		g_signal_connect(pHelper, "action-state-changed", G_CALLBACK(on_state_changed), NULL);
+		g_ptr_array_add(lHelpers, pHelper);
+		g_object_ref_sink(pItem);
+		g_object_unref(pItem);
+		g_free(sAction);
+	}
+
+	nStateChanges = 0;
+	gint64 nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_EMISSIONS; i++)
+		g_action_group_action_state_changed(G_ACTION_GROUP(pActions), "action0", pState);
+	report(sName, nStart, BENCH_EMISSIONS);
+
+	EXPECT_EQ(nStateChanges, (guint)BENCH_EMISSIONS);
+
+	g_variant_unref(pState);
+	g_ptr_array_unref(lHelpers);
+	g_object_unref(pActions);
+}
+
+TEST_F(BenchMenuitems, ActionHelperDispatch) {
+	bench_dispatch("state change, 1 helper", 1);
+	bench_dispatch("state change, 1000 helpers", BENCH_HELPERS);
+	return;
+}
+
+static void
+on_timeline_frame(IdoTimeline *pTimeline, gdouble fProgress, gpointer pData)
+{
+	((guint *)pData)[0]++;
+}
+
+static void
+on_timeline_finished(IdoTimeline *pTimeline, gpointer pData)
+{
+	((guint *)pData)[1]++;
+}
+
+/* step many timelines of different lengths through complete runs on a
+ * manual clock; every run is the same, frame for frame */
+TEST_F(BenchMenuitems, TimelineFrames) {
+	IdoTimelineClock *pClock = ido_timeline_clock_new_manual();
+	IdoTimeline **lTimelines = g_new(IdoTimeline *, BENCH_TIMELINES);
+	guint *lCounts = g_new0(guint, 2 * BENCH_TIMELINES);
+	guint nFrames = 0;
+	guint nTimelineFrames = 0;
+
+	for (guint i = 0; i < BENCH_TIMELINES; i++)
+	{
+		lTimelines[i] = ido_timeline_new(100 + i % 400);
+		ido_timeline_set_clock(lTimelines[i], pClock);
+		g_signal_connect(lTimelines[i], "frame", G_CALLBACK(on_timeline_frame), &lCounts[2 * i]);
+		g_signal_connect(lTimelines[i], "finished", G_CALLBACK(on_timeline_finished), &lCounts[2 * i]);
+		ido_timeline_start(lTimelines[i]);
+	}
+
+	gint64 nStart = g_get_monotonic_time();
+	while (ido_timeline_clock_get_n_running(pClock) > 0)
+	{
+		nTimelineFrames += ido_timeline_clock_get_n_running(pClock);
+		ido_timeline_clock_advance(pClock, BENCH_FRAME_USECS);
+		nFrames++;
+	}
+	report("timeline frame, 10000 running", nStart, nTimelineFrames);
+
+	/* a timeline of d ms needs ceil(d / frame) frames, and finishes once */
+	for (guint i = 0; i < BENCH_TIMELINES; i++)
+	{
+		guint nExpected = ((100 + i % 400) * 1000 + BENCH_FRAME_USECS - 1) / BENCH_FRAME_USECS;
+
+		EXPECT_EQ(nExpected, lCounts[2 * i]);
+		EXPECT_EQ(1u, lCounts[2 * i + 1]);
+		g_object_unref(lTimelines[i]);
+	}
+
+	EXPECT_EQ(((100 + 399) * 1000 + BENCH_FRAME_USECS - 1) / BENCH_FRAME_USECS, nFrames);
+
+	g_free(lCounts);
+	g_free(lTimelines);
+	g_object_unref(pClock);
+	return;
+}
+
+TEST_F(BenchMenuitems, TimelineEasing) {
+	IdoEasingCurve *pCurve = ido_easing_curve_new_for_type(IDO_TIMELINE_PROGRESS_EASE_IN_EASE_OUT);
+	gdouble fSum = 0.0;
+
+	gint64 nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_ITERATIONS; i++)
+		fSum += ido_timeline_calculate_progress((gdouble)i / BENCH_ITERATIONS, IDO_TIMELINE_PROGRESS_EASE_IN_EASE_OUT);
+	report("ease-in-ease-out, computed", nStart, BENCH_ITERATIONS);
+
+	nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_ITERATIONS; i++)
+		fSum -= ido_easing_curve_evaluate(pCurve, (gdouble)i / BENCH_ITERATIONS);
+	report("ease-in-ease-out, lookup table", nStart, BENCH_ITERATIONS);
+
+	/* keeps both loops from being optimised away */
+	EXPECT_NEAR(0.0, fSum / BENCH_ITERATIONS, 1e-4);
+
+	ido_easing_curve_unref(pCurve);
+	return;
+}
+
+/* blur the same total number of pixels for every size */
+TEST_F(BenchMenuitems, Blur) {
+	const gint lSizes[] = { 31, 64, 256, 1024 };
+	const gint lRadii[] = { 1, 3, 8 };
+	const struct { IdoBlurImpl nImpl; const gchar *sName; } lImpls[] =
+	{
+		{ IDO_BLUR_IMPL_SCALAR, "scalar" },
+		{ IDO_BLUR_IMPL_SSE2, "sse2" },
+		{ IDO_BLUR_IMPL_AVX2, "avx2" }
+	};
+
+	for (guint s = 0; s < G_N_ELEMENTS(lSizes); s++)
+	{
+		gint nSize = lSizes[s];
+		guint nIterations = MAX(BENCH_BLUR_PIXELS / (nSize * nSize), 1);
+		guchar *pPixels = (guchar *)g_malloc0(nSize * nSize * 4);
+
+		for (guint r = 0; r < G_N_ELEMENTS(lRadii); r++)
+		{
+			for (guint i = 0; i < G_N_ELEMENTS(lImpls); i++)
+			{
+				if (!ido_blur_impl_supported(lImpls[i].nImpl))
+					continue;
+
+				gchar *sName = g_strdup_printf("blur %dx%d r%d, %s", nSize, nSize, lRadii[r], lImpls[i].sName);
+				gint64 nStart = g_get_monotonic_time();
+				for (guint n = 0; n < nIterations; n++)
+					ido_blur_exponential_with_impl(lImpls[i].nImpl, pPixels, nSize, nSize, 4, lRadii[r], 16, 7);
+				report(sName, nStart, nIterations);
+				g_free(sName);
+			}
+		}
+
+		g_free(pPixels);
+	}
+
+	return;
+}
+
+/* one HiDPI-sized shadow, on the calling thread and split across the
+ * blur workers */
+TEST_F(BenchMenuitems, BlurParallel) {
+	const gint lSizes[] = { 128, 256, 512, 1024 };
+
+	for (guint s = 0; s < G_N_ELEMENTS(lSizes); s++)
+	{
+		gint nSize = lSizes[s];
+		guint nIterations = MAX(BENCH_BLUR_PIXELS / (nSize * nSize), 1);
+		guchar *pPixels = (guchar *)g_malloc0(nSize * nSize * 4);
+
+		for (guint nParallel = 0; nParallel < 2; nParallel++)
+		{
+			ido_blur_set_parallel_threshold(nParallel ? 1 : G_MAXUINT);
+
+			gchar *sName = g_strdup_printf("blur %dx%d r3, %s", nSize, nSize, nParallel ? "parallel" : "serial");
+			gint64 nStart = g_get_monotonic_time();
+			for (guint n = 0; n < nIterations; n++)
+				ido_blur_exponential(pPixels, nSize, nSize, 4, 3, 16, 7);
+			report(sName, nStart, nIterations);
+			g_free(sName);
+		}
+
+		g_free(pPixels);
+	}
+
+	ido_blur_set_parallel_threshold(IDO_BLUR_PARALLEL_THRESHOLD_DEFAULT);
+	return;
+}
+
+/* draw a playback item the way a menu would, once with its artwork
+ * cached and once re-rendering everything for every frame. The bench
+ * didn't exist before the artwork cache, so there is no earlier build
+ * to compare with: the "artwork re-rendered" and "shadows re-blurred"
+ * rows stand in for "before", as every frame used to render the
+ * buttons, and before the shadow cache also blur their shadows. */
+TEST_F(BenchMenuitems, PlaybackDraw) {
+	GMenuItem *pMenuItem = g_menu_item_new("Playback", NULL);
+	GSimpleActionGroup *pActions = g_simple_action_group_new();
+	GtkWidget *pWindow = gtk_offscreen_window_new();
+
+	g_menu_item_set_attribute(pMenuItem, "x-ayatana-play-action", "s", "play");
+	GtkWidget *pItem = GTK_WIDGET(ido_playback_menu_item_new_from_model(pMenuItem, G_ACTION_GROUP(pActions)));
+	gtk_container_add(GTK_CONTAINER(pWindow), pItem);
+	gtk_widget_show_all(pWindow);
+
+	cairo_surface_t *pSurface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 200, 50);
+	cairo_t *pCairo = cairo_create(pSurface);
+
+	gint64 nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_FRAMES; i++)
+		gtk_widget_draw(pItem, pCairo);
+	report("playback draw, cached artwork", nStart, BENCH_FRAMES);
+
+	/* a style change drops the palette and the rendered artwork */
+	nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_FRAMES; i++)
+	{
+		g_signal_emit_by_name(pItem, "style-updated");
+		gtk_widget_draw(pItem, pCairo);
+	}
+	report("playback draw, artwork re-rendered", nStart, BENCH_FRAMES);
+
+	nStart = g_get_monotonic_time();
+	for (guint i = 0; i < BENCH_FRAMES; i++)
+	{
+		g_signal_emit_by_name(pItem, "style-updated");
+		ido_shadow_cache_clear();
+		gtk_widget_draw(pItem, pCairo);
+	}
+	report("playback draw, shadows re-blurred", nStart, BENCH_FRAMES);
+
+	EXPECT_EQ(CAIRO_STATUS_SUCCESS, cairo_status(pCairo));
+
+	cairo_destroy(pCairo);
+	cairo_surface_destroy(pSurface);
+	gtk_widget_destroy(pWindow);
+	g_object_unref(pActions);
+	g_object_unref(pMenuItem);
+	return;
+}
@@ -1,9 +1,25 @@
 
 #include <gtk/gtk.h>
+#include <glib/gstdio.h>
 #include <gtest/gtest.h>
 #include "idocalendarmenuitem.h"
 #include "idoentrymenuitem.h"
 #include "idoscalemenuitem.h"
+#include "idomenuitemfactory.h"
+#include "idobasicmenuitem.h"
+#include "idoswitchmenuitem.h"
+#include "idoalarmmenuitem.h"
+#include "idolocationmenuitem.h"
+#include "idotimestampmenuitem.h"
+#include "idoactionhelper.h"
+#include "idotimeline.h"
+#include "idoblur.h"
+#include "idoshadowcache.h"
+#include "idoalbumart.h"
+#include "idomediaplayermenuitem.h"
+#include "idoplaybackmenuitem.h"
+#include "ayatanamenuitemfactory.h"
+#include "libayatana-ido.h"
 
 class TestMenuitems : public ::testing::Test
 {
@@ -100,3 +116,1549 @@ TEST_F(TestMenuitems, BuildScaleSmall) {
 	g_object_unref(menu);
 	return;
 }
+
+static GtkMenuItem *
+custom_constructor(GMenuItem *menuitem, GActionGroup *actions)
+{
+	return GTK_MENU_ITEM(gtk_menu_item_new());
+}
+
+TEST_F(TestMenuitems, FactoryRegisterType) {
+	EXPECT_TRUE(ido_menu_item_factory_lookup_type("org.ayatana.indicator.basic") != NULL);
+	EXPECT_TRUE(ido_menu_item_factory_lookup_type("org.ayatana.indicator.test") == NULL);
+
+	ido_menu_item_factory_register_type("org.ayatana.indicator.test", custom_constructor);
+	EXPECT_TRUE(ido_menu_item_factory_lookup_type("org.ayatana.indicator.test") == custom_constructor);
+
+	ido_menu_item_factory_register_type("org.ayatana.indicator.test", NULL);
+	EXPECT_TRUE(ido_menu_item_factory_lookup_type("org.ayatana.indicator.test") == NULL);
+	return;
+}
+
+TEST_F(TestMenuitems, FactoryRecycleBasic) {
+	ido_init();
+
+	GList *factories = ayatana_menu_item_factory_get_all();
+	ASSERT_TRUE(factories != NULL);
+	AyatanaMenuItemFactory *factory = AYATANA_MENU_ITEM_FACTORY(factories->data);
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GMenuItem *first = g_menu_item_new("First", "basic.first");
+	GMenuItem *second = g_menu_item_new("Second", NULL);
+
+	GtkMenuItem *item = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.basic", first, G_ACTION_GROUP(actions));
+	ASSERT_TRUE(IDO_IS_BASIC_MENU_ITEM(item));
+
+	GtkWidget * menu = gtk_menu_new();
+	gtk_menu_shell_append(GTK_MENU_SHELL(menu), GTK_WIDGET(item));
+
+	ido_menu_item_factory_release_menu_item(item);
+	EXPECT_TRUE(gtk_widget_get_parent(GTK_WIDGET(item)) == NULL);
+
+	GtkMenuItem *recycled = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.basic", second, G_ACTION_GROUP(actions));
+	EXPECT_TRUE(recycled == item);
+	EXPECT_TRUE(g_object_is_floating(recycled));
+
+	gchar *text = NULL;
+	g_object_get(recycled, "text", &text, NULL);
+	EXPECT_STREQ("Second", text);
+	g_free(text);
+
+	gtk_menu_shell_append(GTK_MENU_SHELL(menu), GTK_WIDGET(recycled));
+	g_object_ref_sink(menu);
+	g_object_unref(menu);
+	g_object_unref(second);
+	g_object_unref(first);
+	g_object_unref(actions);
+	return;
+}
+
+TEST_F(TestMenuitems, FactoryRecycleReset) {
+	ido_init();
+
+	GList *factories = ayatana_menu_item_factory_get_all();
+	ASSERT_TRUE(factories != NULL);
+	AyatanaMenuItemFactory *factory = AYATANA_MENU_ITEM_FACTORY(factories->data);
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GMenuItem *first = g_menu_item_new("First", "basic.first");
+	GMenuItem *second = g_menu_item_new("Second", NULL);
+	GIcon *icon = g_themed_icon_new("folder");
+
+	g_menu_item_set_icon(first, icon);
+	g_menu_item_set_attribute(first, "x-ayatana-secondary-text", "s", "Details");
+
+	GtkMenuItem *item = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.basic", first, G_ACTION_GROUP(actions));
+	ASSERT_TRUE(IDO_IS_BASIC_MENU_ITEM(item));
+	EXPECT_TRUE(ido_action_helper_get_for_widget(GTK_WIDGET(item)) != NULL);
+
+	GtkWidget * menu = gtk_menu_new();
+	gtk_menu_shell_append(GTK_MENU_SHELL(menu), GTK_WIDGET(item));
+
+	/* the pooled item keeps nothing of its last menu model entry */
+	ido_menu_item_factory_release_menu_item(item);
+
+	gchar *text = NULL;
+	gchar *secondary_text = NULL;
+	GIcon *item_icon = NULL;
+	g_object_get(item, "text", &text, "secondary-text", &secondary_text, "icon", &item_icon, NULL);
+	EXPECT_TRUE(text == NULL);
+	EXPECT_TRUE(secondary_text == NULL);
+	EXPECT_TRUE(item_icon == NULL);
+	EXPECT_TRUE(ido_action_helper_get_for_widget(GTK_WIDGET(item)) == NULL);
+
+	/* nor does it once it is handed out for an entry without icon */
+	GtkMenuItem *recycled = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.basic", second, G_ACTION_GROUP(actions));
+	EXPECT_TRUE(recycled == item);
+
+	g_object_get(recycled, "text", &text, "secondary-text", &secondary_text, "icon", &item_icon, NULL);
+	EXPECT_STREQ("Second", text);
+	EXPECT_TRUE(secondary_text == NULL);
+	EXPECT_TRUE(item_icon == NULL);
+	g_free(text);
+
+	gtk_menu_shell_append(GTK_MENU_SHELL(menu), GTK_WIDGET(recycled));
+	g_object_ref_sink(menu);
+	g_object_unref(menu);
+	g_object_unref(icon);
+	g_object_unref(second);
+	g_object_unref(first);
+	g_object_unref(actions);
+	return;
+}
+
+static guint custom_updates = 0;
+
+static void
+custom_updater(GtkMenuItem *item, GMenuItem *menuitem, GActionGroup *actions)
+{
+	custom_updates++;
+}
+
+TEST_F(TestMenuitems, FactoryReregisterType) {
+	ido_init();
+
+	GList *factories = ayatana_menu_item_factory_get_all();
+	ASSERT_TRUE(factories != NULL);
+	AyatanaMenuItemFactory *factory = AYATANA_MENU_ITEM_FACTORY(factories->data);
+	GMenuItem *menuitem = g_menu_item_new("Test", NULL);
+
+	ido_menu_item_factory_register_type_full("org.ayatana.indicator.test", custom_constructor, custom_updater);
+
+	GtkMenuItem *item = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.test", menuitem, NULL);
+	ASSERT_TRUE(item != NULL);
+	g_object_ref_sink(item);
+
+	EXPECT_TRUE(ido_menu_item_factory_update_menu_item(item, menuitem, NULL));
+	EXPECT_EQ(1u, custom_updates);
+
+	/* the new updater never sees items of the old registration */
+	ido_menu_item_factory_register_type_full("org.ayatana.indicator.test", custom_constructor, custom_updater);
+	custom_updates = 0;
+
+	EXPECT_FALSE(ido_menu_item_factory_update_menu_item(item, menuitem, NULL));
+	EXPECT_EQ(0u, custom_updates);
+
+	/* nor are they pooled */
+	ido_menu_item_factory_release_menu_item(item);
+	EXPECT_EQ(0u, custom_updates);
+
+	GtkMenuItem *rebuilt = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.test", menuitem, NULL);
+	EXPECT_TRUE(rebuilt != item);
+	g_object_ref_sink(rebuilt);
+
+	/* items of the current registration are */
+	ido_menu_item_factory_release_menu_item(rebuilt);
+	EXPECT_EQ(1u, custom_updates);
+	GtkMenuItem *recycled = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.test", menuitem, NULL);
+	EXPECT_TRUE(recycled == rebuilt);
+	EXPECT_EQ(2u, custom_updates);
+	g_object_ref_sink(recycled);
+	g_object_unref(recycled);
+
+	ido_menu_item_factory_register_type("org.ayatana.indicator.test", NULL);
+
+	g_object_unref(rebuilt);
+	g_object_unref(item);
+	g_object_unref(menuitem);
+	return;
+}
+
+TEST_F(TestMenuitems, FactoryUpdateInPlace) {
+	ido_init();
+
+	GList *factories = ayatana_menu_item_factory_get_all();
+	ASSERT_TRUE(factories != NULL);
+	AyatanaMenuItemFactory *factory = AYATANA_MENU_ITEM_FACTORY(factories->data);
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GMenuItem *first = g_menu_item_new("First", "switch.toggle");
+	GMenuItem *second = g_menu_item_new("Second", "switch.toggle");
+	GMenuItem *third = g_menu_item_new("Third", "switch.other");
+
+	GtkMenuItem *item = ayatana_menu_item_factory_create_menu_item(factory, "org.ayatana.indicator.switch", first, G_ACTION_GROUP(actions));
+	ASSERT_TRUE(IDO_IS_SWITCH_MENU_ITEM(item));
+	g_object_ref_sink(item);
+
+	IdoActionHelper *helper = ido_action_helper_get_for_widget(GTK_WIDGET(item));
+	ASSERT_TRUE(helper != NULL);
+	g_object_ref(helper);
+
+	/* same action: the binding is kept */
+	EXPECT_TRUE(ido_menu_item_factory_update_menu_item(item, second, G_ACTION_GROUP(actions)));
+	EXPECT_TRUE(ido_action_helper_get_for_widget(GTK_WIDGET(item)) == helper);
+
+	/* different action: the item is rebound */
+	EXPECT_TRUE(ido_menu_item_factory_update_menu_item(item, third, G_ACTION_GROUP(actions)));
+	EXPECT_TRUE(ido_action_helper_get_for_widget(GTK_WIDGET(item)) != helper);
+	EXPECT_TRUE(ido_action_helper_get_for_widget(GTK_WIDGET(item)) != NULL);
+
+	gtk_widget_destroy(GTK_WIDGET(item));
+	EXPECT_TRUE(ido_action_helper_get_for_widget(GTK_WIDGET(item)) == NULL);
+
+	g_object_unref(helper);
+	g_object_unref(item);
+	g_object_unref(third);
+	g_object_unref(second);
+	g_object_unref(first);
+	g_object_unref(actions);
+	return;
+}
+
+static void
+count_state_changes(IdoActionHelper *helper, GVariant *state, gpointer user_data)
+{
+	(*(guint *)user_data)++;
+}
+
+TEST_F(TestMenuitems, ActionHelperDispatch) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GtkWidget *first_item = gtk_menu_item_new();
+	GtkWidget *second_item = gtk_menu_item_new();
+	guint first_changes = 0;
+	guint second_changes = 0;
+
+	g_object_ref_sink(first_item);
+	g_object_ref_sink(second_item);
+
+	IdoActionHelper *first = ido_action_helper_new(first_item, G_ACTION_GROUP(actions), "first", NULL);
+	IdoActionHelper *second = ido_action_helper_new(second_item, G_ACTION_GROUP(actions), "second", NULL);
+	g_signal_connect(first, "action-state-changed", G_CALLBACK(count_state_changes), &first_changes);
+	g_signal_connect(second, "action-state-changed", G_CALLBACK(count_state_changes), &second_changes);
+
+	g_action_group_action_state_changed(G_ACTION_GROUP(actions), "first", g_variant_new_boolean(TRUE));
+	EXPECT_EQ(1u, first_changes);
+	EXPECT_EQ(0u, second_changes);
+
+	g_action_group_action_enabled_changed(G_ACTION_GROUP(actions), "second", FALSE);
+	EXPECT_TRUE(gtk_widget_get_sensitive(first_item));
+	EXPECT_FALSE(gtk_widget_get_sensitive(second_item));
+
+	/* helpers that are gone don't receive anything */
+	g_object_unref(first);
+	g_action_group_action_state_changed(G_ACTION_GROUP(actions), "first", g_variant_new_boolean(FALSE));
+	EXPECT_EQ(1u, first_changes);
+
+	g_object_unref(second);
+	g_object_unref(second_item);
+	g_object_unref(first_item);
+	g_object_unref(actions);
+	return;
+}
+
+TEST_F(TestMenuitems, ActionHelperCoalesceStates) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GtkWidget *window = gtk_offscreen_window_new();
+	GtkWidget *item = gtk_button_new();
+	guint changes = 0;
+
+	gtk_container_add(GTK_CONTAINER(window), item);
+	gtk_widget_show_all(window);
+
+	IdoActionHelper *helper = ido_action_helper_new(item, G_ACTION_GROUP(actions), "volume", NULL);
+	g_signal_connect(helper, "action-state-changed", G_CALLBACK(count_state_changes), &changes);
+	ido_action_helper_set_coalesce_states(helper, TRUE);
+
+	for (gint i = 0; i < 10; i++)
+		g_action_group_action_state_changed(G_ACTION_GROUP(actions), "volume", g_variant_new_double(i));
+
+	/* nothing is delivered before the next frame */
+	EXPECT_EQ(0u, changes);
+	EXPECT_EQ(9u, ido_action_helper_get_dropped_states(helper));
+
+	/* turning coalescing off delivers the pending state */
+	ido_action_helper_set_coalesce_states(helper, FALSE);
+	EXPECT_EQ(1u, changes);
+
+	g_object_unref(helper);
+	gtk_widget_destroy(window);
+	g_object_unref(actions);
+	return;
+}
+
+static void
+count_notifies(GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	(*(guint *)user_data)++;
+}
+
+static gdouble
+get_double_state(GSimpleAction *action)
+{
+	GVariant *state = g_action_get_state(G_ACTION(action));
+	gdouble value = g_variant_get_double(state);
+
+	g_variant_unref(state);
+	return value;
+}
+
+TEST_F(TestMenuitems, ScaleChangeRate) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GSimpleAction *action = g_simple_action_new_stateful("volume", NULL, g_variant_new_double(0.0));
+	GMenuItem *menuitem = g_menu_item_new("Volume", "volume");
+	guint changes = 0;
+
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(action));
+	g_signal_connect(action, "notify::state", G_CALLBACK(count_notifies), &changes);
+	g_menu_item_set_attribute(menuitem, "change-rate", "i", 10);
+
+	GtkMenuItem *item = ido_scale_menu_item_new_from_model(menuitem, G_ACTION_GROUP(actions));
+	g_object_ref_sink(item);
+	EXPECT_EQ(10, ido_scale_menu_item_get_change_rate(IDO_SCALE_MENU_ITEM(item)));
+
+	/* the first value goes out right away, the following ones are held */
+	for (gint i = 1; i <= 5; i++)
+		g_signal_emit_by_name(item, "value-changed", (gdouble) i);
+
+	EXPECT_EQ(1u, changes);
+	EXPECT_EQ(1.0, get_double_state(action));
+
+	/* the last value is never lost */
+	ido_scale_menu_item_set_change_rate(IDO_SCALE_MENU_ITEM(item), 0);
+	EXPECT_EQ(2u, changes);
+	EXPECT_EQ(5.0, get_double_state(action));
+
+	/* a model without a rate of its own keeps the one set in code */
+	GMenuItem *plain = g_menu_item_new("Volume", "volume");
+	ido_scale_menu_item_update_from_model(item, plain, G_ACTION_GROUP(actions));
+	EXPECT_EQ(0, ido_scale_menu_item_get_change_rate(IDO_SCALE_MENU_ITEM(item)));
+	g_object_unref(plain);
+
+	gtk_widget_destroy(GTK_WIDGET(item));
+	g_object_unref(item);
+	g_object_unref(menuitem);
+	g_object_unref(action);
+	g_object_unref(actions);
+	return;
+}
+
+TEST_F(TestMenuitems, ScaleUpdateDigits) {
+	GMenuItem *menuitem = g_menu_item_new("Volume", NULL);
+	GMenuItem *plain = g_menu_item_new("Volume", NULL);
+
+	g_menu_item_set_attribute(menuitem, "digits", "y", 3);
+
+	GtkMenuItem *item = ido_scale_menu_item_new_from_model(menuitem, NULL);
+	g_object_ref_sink(item);
+	GtkWidget *scale = ido_scale_menu_item_get_scale(IDO_SCALE_MENU_ITEM(item));
+	EXPECT_EQ(3, gtk_scale_get_digits(GTK_SCALE(scale)));
+	EXPECT_EQ(3, gtk_range_get_round_digits(GTK_RANGE(scale)));
+
+	/* an entry without digits looks like a new item built from it */
+	GtkMenuItem *rebuilt = ido_scale_menu_item_new_from_model(plain, NULL);
+	g_object_ref_sink(rebuilt);
+	GtkWidget *rebuilt_scale = ido_scale_menu_item_get_scale(IDO_SCALE_MENU_ITEM(rebuilt));
+
+	ido_scale_menu_item_update_from_model(item, plain, NULL);
+	EXPECT_EQ(gtk_scale_get_digits(GTK_SCALE(rebuilt_scale)), gtk_scale_get_digits(GTK_SCALE(scale)));
+	EXPECT_EQ(gtk_range_get_round_digits(GTK_RANGE(rebuilt_scale)), gtk_range_get_round_digits(GTK_RANGE(scale)));
+	EXPECT_EQ(1, gtk_scale_get_digits(GTK_SCALE(scale)));
+
+	gtk_widget_destroy(GTK_WIDGET(rebuilt));
+	g_object_unref(rebuilt);
+	gtk_widget_destroy(GTK_WIDGET(item));
+	g_object_unref(item);
+	g_object_unref(plain);
+	g_object_unref(menuitem);
+	return;
+}
+
+static gchar *
+get_secondary_text(GtkMenuItem *item)
+{
+	gchar *text = NULL;
+
+	g_object_get(item, "secondary-text", &text, NULL);
+	return text;
+}
+
+TEST_F(TestMenuitems, TimeStampUpdateMissingAttributes) {
+	GMenuItem *timed = g_menu_item_new("Alarm", NULL);
+	GMenuItem *unformatted = g_menu_item_new("Alarm", NULL);
+	GMenuItem *untimed = g_menu_item_new("Alarm", NULL);
+
+	g_menu_item_set_attribute(timed, "x-ayatana-time-format", "s", "%H:%M");
+	g_menu_item_set_attribute(timed, "x-ayatana-time", "x", (gint64) 1700000000);
+	g_menu_item_set_attribute(unformatted, "x-ayatana-time", "x", (gint64) 1700000000);
+	g_menu_item_set_attribute(untimed, "x-ayatana-time-format", "s", "%H:%M");
+
+	GtkMenuItem *alarm = ido_alarm_menu_item_new_from_model(timed, NULL);
+	g_object_ref_sink(alarm);
+	gchar *text = get_secondary_text(alarm);
+	EXPECT_TRUE(text != NULL);
+	g_free(text);
+
+	/* a dropped format isn't kept from the previous entry */
+	ido_alarm_menu_item_update_from_model(alarm, unformatted, NULL);
+	EXPECT_TRUE(ido_time_stamp_menu_item_get_format(IDO_TIME_STAMP_MENU_ITEM(alarm)) == NULL);
+	text = get_secondary_text(alarm);
+	EXPECT_TRUE(text == NULL);
+	g_free(text);
+
+	/* nor is a dropped time */
+	ido_alarm_menu_item_update_from_model(alarm, timed, NULL);
+	ido_alarm_menu_item_update_from_model(alarm, untimed, NULL);
+	EXPECT_STREQ("%H:%M", ido_time_stamp_menu_item_get_format(IDO_TIME_STAMP_MENU_ITEM(alarm)));
+	text = get_secondary_text(alarm);
+	EXPECT_TRUE(text == NULL);
+	g_free(text);
+
+	/* a location without a timezone goes back to local time */
+	GMenuItem *zoned = g_menu_item_new("Location", NULL);
+	GMenuItem *local = g_menu_item_new("Location", NULL);
+
+	g_menu_item_set_attribute(zoned, "x-ayatana-timezone", "s", "UTC");
+	g_menu_item_set_attribute(zoned, "x-ayatana-time-format", "s", "%H:%M");
+
+	GtkMenuItem *location = ido_location_menu_item_new_from_model(zoned, NULL);
+	g_object_ref_sink(location);
+
+	ido_location_menu_item_update_from_model(location, local, NULL);
+	gchar *timezone = NULL;
+	g_object_get(location, "timezone", &timezone, NULL);
+	EXPECT_TRUE(timezone == NULL);
+	EXPECT_TRUE(ido_time_stamp_menu_item_get_format(IDO_TIME_STAMP_MENU_ITEM(location)) == NULL);
+	g_free(timezone);
+
+	gtk_widget_destroy(GTK_WIDGET(location));
+	g_object_unref(location);
+	g_object_unref(local);
+	g_object_unref(zoned);
+	gtk_widget_destroy(GTK_WIDGET(alarm));
+	g_object_unref(alarm);
+	g_object_unref(untimed);
+	g_object_unref(unformatted);
+	g_object_unref(timed);
+	return;
+}
+
+TEST_F(TestMenuitems, ActionHelperFlushPending) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GSimpleAction *action = g_simple_action_new_stateful("toggle", NULL, g_variant_new_boolean(TRUE));
+	GPtrArray *helpers = g_ptr_array_new_with_free_func(g_object_unref);
+	guint changes = 0;
+
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(action));
+
+	for (gint i = 0; i < 3; i++)
+	{
+		GtkWidget *item = gtk_menu_item_new();
+		IdoActionHelper *helper = ido_action_helper_new(item, G_ACTION_GROUP(actions), "toggle", NULL);
+
+		g_signal_connect(helper, "action-state-changed", G_CALLBACK(count_state_changes), &changes);
+		g_ptr_array_add(helpers, helper);
+	}
+
+	/* the initial state is replayed later, in one pass */
+	EXPECT_EQ(0u, changes);
+	ido_action_helper_flush_pending();
+	EXPECT_EQ(3u, changes);
+
+	/* and only once */
+	while (g_main_context_iteration(NULL, FALSE));
+	EXPECT_EQ(3u, changes);
+
+	g_ptr_array_unref(helpers);
+	g_object_unref(action);
+	g_object_unref(actions);
+	return;
+}
+
+TEST_F(TestMenuitems, ActionHelperSuppressStates) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GtkWidget *item = gtk_menu_item_new();
+	guint changes = 0;
+
+	g_object_ref_sink(item);
+
+	IdoActionHelper *helper = ido_action_helper_new(item, G_ACTION_GROUP(actions), "player", NULL);
+	g_signal_connect(helper, "action-state-changed", G_CALLBACK(count_state_changes), &changes);
+
+	g_action_group_action_state_changed(G_ACTION_GROUP(actions), "player", g_variant_new_parsed("{'title': <'One'>}"));
+	g_action_group_action_state_changed(G_ACTION_GROUP(actions), "player", g_variant_new_parsed("{'title': <'One'>}"));
+	g_action_group_action_state_changed(G_ACTION_GROUP(actions), "player", g_variant_new_parsed("{'title': <'Two'>}"));
+
+	EXPECT_EQ(2u, changes);
+	EXPECT_EQ(1u, ido_action_helper_get_suppressed_states(helper));
+
+	g_object_unref(helper);
+	g_object_unref(item);
+	g_object_unref(actions);
+	return;
+}
+
+static void
+reject_state_change(GSimpleAction *action, GVariant *value, gpointer user_data)
+{
+	/* the service keeps its state and sends it again */
+	GVariant *state = g_action_get_state(G_ACTION(action));
+
+	g_action_group_action_state_changed(G_ACTION_GROUP(user_data), "toggle", state);
+	g_variant_unref(state);
+}
+
+TEST_F(TestMenuitems, ActionHelperRejectedState) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GSimpleAction *action = g_simple_action_new_stateful("toggle", NULL, g_variant_new_boolean(TRUE));
+	GtkWidget *item = gtk_menu_item_new();
+	guint changes = 0;
+
+	g_object_ref_sink(item);
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(action));
+	g_signal_connect(action, "change-state", G_CALLBACK(reject_state_change), actions);
+
+	IdoActionHelper *helper = ido_action_helper_new(item, G_ACTION_GROUP(actions), "toggle", NULL);
+	g_signal_connect(helper, "action-state-changed", G_CALLBACK(count_state_changes), &changes);
+	ido_action_helper_flush_pending();
+	EXPECT_EQ(1u, changes);
+
+	/* the same state again is left out */
+	g_action_group_action_state_changed(G_ACTION_GROUP(actions), "toggle", g_variant_new_boolean(TRUE));
+	EXPECT_EQ(1u, changes);
+
+	/* but not after the user changed the widget and the service said no */
+	ido_action_helper_change_action_state(helper, g_variant_new_boolean(FALSE));
+	EXPECT_EQ(2u, changes);
+
+	g_object_unref(helper);
+	g_object_unref(item);
+	g_object_unref(action);
+	g_object_unref(actions);
+	return;
+}
+
+static void
+count_finished(IdoTimeline *timeline, gpointer data)
+{
+	(*(guint *)data)++;
+}
+
+TEST_F(TestMenuitems, TimelineScheduler) {
+	IdoTimeline *timelines[3];
+	guint finished = 0;
+
+	for (guint i = 0; i < G_N_ELEMENTS(timelines); i++)
+	{
+		timelines[i] = ido_timeline_new(20 * (i + 1));
+		g_signal_connect(timelines[i], "finished", G_CALLBACK(count_finished), &finished);
+		ido_timeline_start(timelines[i]);
+	}
+
+	while (finished < G_N_ELEMENTS(timelines))
+		g_main_context_iteration(NULL, TRUE);
+
+	for (guint i = 0; i < G_N_ELEMENTS(timelines); i++)
+	{
+		EXPECT_FALSE(ido_timeline_is_running(timelines[i]));
+		EXPECT_EQ(1.0, ido_timeline_get_progress(timelines[i]));
+		g_object_unref(timelines[i]);
+	}
+
+	/* nothing left to tick, so the scheduler is asleep */
+	EXPECT_EQ(0.0, ido_timeline_get_wakeups_per_second());
+	return;
+}
+
+static gboolean
+set_timed_out(gpointer data)
+{
+	*(gboolean *)data = TRUE;
+	return G_SOURCE_REMOVE;
+}
+
+TEST_F(TestMenuitems, TimelineFrameClock) {
+	IdoTimelineClock *shared = ido_timeline_clock_get_default();
+	GtkWidget *window = gtk_offscreen_window_new();
+	gboolean timed_out = FALSE;
+	guint finished = 0;
+
+	gtk_widget_show(window);
+	ASSERT_TRUE(gtk_widget_get_frame_clock(window) != NULL);
+
+	IdoTimeline *timeline = ido_timeline_new_for_widget(50, window);
+	g_signal_connect(timeline, "finished", G_CALLBACK(count_finished), &finished);
+
+	/* a realized widget drives the timeline, the shared clock stays idle */
+	ido_timeline_start(timeline);
+	EXPECT_EQ(0u, ido_timeline_clock_get_n_running(shared));
+
+	guint timeout = g_timeout_add(5000, set_timed_out, &timed_out);
+	while (finished == 0 && !timed_out)
+		g_main_context_iteration(NULL, TRUE);
+	EXPECT_EQ(1u, finished);
+	EXPECT_FALSE(ido_timeline_is_running(timeline));
+
+	/* unrealizing the widget mid-run hands the timeline to the shared
+	 * clock, which still finishes it */
+	ido_timeline_rewind(timeline);
+	ido_timeline_start(timeline);
+	gtk_widget_hide(window);
+	gtk_widget_unrealize(window);
+	EXPECT_TRUE(ido_timeline_is_running(timeline));
+	EXPECT_EQ(1u, ido_timeline_clock_get_n_running(shared));
+
+	while (finished == 1 && !timed_out)
+		g_main_context_iteration(NULL, TRUE);
+	EXPECT_EQ(2u, finished);
+	EXPECT_FALSE(ido_timeline_is_running(timeline));
+	EXPECT_EQ(0u, ido_timeline_clock_get_n_running(shared));
+
+	if (!timed_out)
+		g_source_remove(timeout);
+	g_object_unref(timeline);
+	gtk_widget_destroy(window);
+	return;
+}
+
+TEST_F(TestMenuitems, TimelineManualClock) {
+	IdoTimelineClock *clock = ido_timeline_clock_new_manual();
+	IdoTimeline *timeline = ido_timeline_new(100);
+	guint finished = 0;
+
+	ido_timeline_set_clock(timeline, clock);
+	g_signal_connect(timeline, "finished", G_CALLBACK(count_finished), &finished);
+	ido_timeline_start(timeline);
+	EXPECT_EQ(1u, ido_timeline_clock_get_n_running(clock));
+
+	/* time only moves when the clock is advanced */
+	while (g_main_context_iteration(NULL, FALSE));
+	EXPECT_EQ(0.0, ido_timeline_get_progress(timeline));
+
+	ido_timeline_clock_advance(clock, 25000);
+	EXPECT_DOUBLE_EQ(0.25, ido_timeline_get_progress(timeline));
+
+	ido_timeline_clock_advance(clock, 50000);
+	EXPECT_DOUBLE_EQ(0.75, ido_timeline_get_progress(timeline));
+	EXPECT_EQ(0u, finished);
+
+	ido_timeline_clock_advance(clock, 50000);
+	EXPECT_EQ(1.0, ido_timeline_get_progress(timeline));
+	EXPECT_EQ(1u, finished);
+	EXPECT_EQ(0u, ido_timeline_clock_get_n_running(clock));
+
+	ido_timeline_clock_advance(clock, 50000);
+	EXPECT_EQ(1u, finished);
+
+	/* without a length, even an empty frame jumps straight to the end */
+	IdoTimeline *instant = ido_timeline_new(0);
+	ido_timeline_set_clock(instant, clock);
+	g_signal_connect(instant, "finished", G_CALLBACK(count_finished), &finished);
+
+	ido_timeline_start(instant);
+	ido_timeline_clock_advance(clock, 0);
+	EXPECT_EQ(1.0, ido_timeline_get_progress(instant));
+	EXPECT_EQ(2u, finished);
+	EXPECT_EQ(0u, ido_timeline_clock_get_n_running(clock));
+
+	ido_timeline_set_direction(instant, IDO_TIMELINE_DIRECTION_BACKWARD);
+	ido_timeline_rewind(instant);
+	ido_timeline_start(instant);
+	ido_timeline_clock_advance(clock, 0);
+	EXPECT_EQ(0.0, ido_timeline_get_progress(instant));
+	EXPECT_EQ(3u, finished);
+	EXPECT_EQ(0u, ido_timeline_clock_get_n_running(clock));
+
+	g_object_unref(instant);
+	g_object_unref(timeline);
+	g_object_unref(clock);
+	return;
+}
+
+TEST_F(TestMenuitems, TimelineEasingCurves) {
+	IdoEasingCurve *ease = ido_easing_curve_new_for_type(IDO_TIMELINE_PROGRESS_EASE_IN_EASE_OUT);
+	IdoEasingCurve *linear = ido_easing_curve_new_cubic_bezier(0.0, 0.0, 1.0, 1.0);
+	IdoEasingCurve *spring = ido_easing_curve_new_spring(0.3);
+	gdouble peak = 0.0;
+
+	for (guint i = 0; i <= 1000; i++)
+	{
+		gdouble progress = i / 1000.0;
+
+		EXPECT_NEAR(ido_timeline_calculate_progress(progress, IDO_TIMELINE_PROGRESS_EASE_IN_EASE_OUT),
+		            ido_easing_curve_evaluate(ease, progress), 1e-4);
+		EXPECT_NEAR(progress, ido_easing_curve_evaluate(linear, progress), 1e-6);
+		peak = MAX(peak, ido_easing_curve_evaluate(spring, progress));
+	}
+
+	/* an underdamped spring overshoots, then comes to rest on the end */
+	EXPECT_EQ(0.0, ido_easing_curve_evaluate(spring, 0.0));
+	EXPECT_GT(peak, 1.1);
+	EXPECT_EQ(1.0, ido_easing_curve_evaluate(spring, 1.0));
+
+	IdoTimelineClock *clock = ido_timeline_clock_new_manual();
+	IdoTimeline *timelines[2] = { ido_timeline_new(100), ido_timeline_new(200) };
+	gdouble eased[2];
+
+	for (guint i = 0; i < G_N_ELEMENTS(timelines); i++)
+	{
+		ido_timeline_set_clock(timelines[i], clock);
+		ido_timeline_start(timelines[i]);
+	}
+
+	ido_timeline_clock_advance(clock, 50000);
+	ido_easing_curve_evaluate_timelines(ease, timelines, G_N_ELEMENTS(timelines), eased);
+	EXPECT_DOUBLE_EQ(ido_easing_curve_evaluate(ease, 0.5), eased[0]);
+	EXPECT_DOUBLE_EQ(ido_easing_curve_evaluate(ease, 0.25), eased[1]);
+
+	for (guint i = 0; i < G_N_ELEMENTS(timelines); i++)
+		g_object_unref(timelines[i]);
+
+	g_object_unref(clock);
+	ido_easing_curve_unref(spring);
+	ido_easing_curve_unref(linear);
+	ido_easing_curve_unref(ease);
+	return;
+}
+
+TEST_F(TestMenuitems, TimelineStats) {
+	IdoTimelineClock *clock = ido_timeline_clock_new_manual();
+	IdoTimeline *timeline = ido_timeline_new(100);
+	IdoTimelineStats stats;
+
+	ido_timeline_set_fps(timeline, 30);
+	ido_timeline_set_clock(timeline, clock);
+	ido_timeline_start(timeline);
+
+	ido_timeline_clock_advance(clock, 20000);
+	ido_timeline_clock_advance(clock, 20000);
+	ido_timeline_clock_advance(clock, 80000);
+	EXPECT_FALSE(ido_timeline_is_running(timeline));
+
+	ido_timeline_get_stats(timeline, &stats);
+	EXPECT_EQ(3u, stats.frames);
+	EXPECT_EQ(1u, stats.late_frames);
+	EXPECT_EQ(0u, stats.skipped_frames);
+	EXPECT_EQ(80.0, stats.max_interval);
+	EXPECT_EQ(2u, stats.histogram[1]);
+	EXPECT_EQ(1u, stats.histogram[4]);
+
+	ido_timeline_reset_stats(timeline);
+	ido_timeline_get_stats(timeline, &stats);
+	EXPECT_EQ(0u, stats.frames);
+
+	g_object_unref(timeline);
+	g_object_unref(clock);
+	return;
+}
+
+TEST_F(TestMenuitems, TimelineAnimationsDisabled) {
+	GtkSettings *settings = gtk_settings_get_default();
+	IdoTimelineClock *clock = ido_timeline_clock_new_manual();
+	IdoTimeline *timeline = ido_timeline_new(100);
+	IdoTimelineStats stats;
+	guint finished = 0;
+
+	ido_timeline_set_clock(timeline, clock);
+	g_signal_connect(timeline, "finished", G_CALLBACK(count_finished), &finished);
+
+	/* finishes from within start, with nothing left to dispatch */
+	g_object_set(settings, "gtk-enable-animations", FALSE, NULL);
+	ido_timeline_set_loop(timeline, TRUE);
+	ido_timeline_start(timeline);
+	EXPECT_EQ(1u, finished);
+	EXPECT_EQ(1.0, ido_timeline_get_progress(timeline));
+	EXPECT_FALSE(ido_timeline_is_running(timeline));
+	EXPECT_EQ(0u, ido_timeline_clock_get_n_running(clock));
+
+	/* turning animations off ends a running timeline */
+	g_object_set(settings, "gtk-enable-animations", TRUE, NULL);
+	ido_timeline_set_loop(timeline, FALSE);
+	ido_timeline_rewind(timeline);
+	ido_timeline_reset_stats(timeline);
+	ido_timeline_start(timeline);
+	ido_timeline_clock_advance(clock, 50000);
+	EXPECT_TRUE(ido_timeline_is_running(timeline));
+
+	g_object_set(settings, "gtk-enable-animations", FALSE, NULL);
+	EXPECT_EQ(2u, finished);
+	EXPECT_EQ(1.0, ido_timeline_get_progress(timeline));
+	EXPECT_FALSE(ido_timeline_is_running(timeline));
+
+	ido_timeline_get_stats(timeline, &stats);
+	EXPECT_EQ(1u, stats.frames);
+	EXPECT_EQ(2u, stats.skipped_frames);
+
+	g_object_set(settings, "gtk-enable-animations", TRUE, NULL);
+	g_object_unref(timeline);
+	g_object_unref(clock);
+	return;
+}
+
+static guchar *
+new_noise(gint width, gint height)
+{
+	guchar *pixels = (guchar *)g_malloc(width * height * 4);
+	guint32 seed = 1;
+
+	for (gint i = 0; i < width * height * 4; i++)
+	{
+		seed = seed * 1103515245u + 12345u;
+		pixels[i] = (seed >> 16) & 0xff;
+	}
+
+	return pixels;
+}
+
+TEST_F(TestMenuitems, BlurGolden) {
+	const IdoBlurImpl impls[] = { IDO_BLUR_IMPL_AUTO, IDO_BLUR_IMPL_SSE2, IDO_BLUR_IMPL_AVX2 };
+	const gint sizes[][2] = { {1, 1}, {1, 5}, {5, 1}, {3, 7}, {9, 9}, {17, 5}, {31, 33}, {130, 33} };
+	const gint radii[] = { 1, 3, 8, 20 };
+
+	/* the scalar blur of a fixed noise image, as it has always been */
+	guchar *golden = new_noise(37, 23);
+	ido_blur_exponential_with_impl(IDO_BLUR_IMPL_SCALAR, golden, 37, 23, 4, 3, 16, 7);
+
+	guint32 hash = 2166136261u;
+	for (gint i = 0; i < 37 * 23 * 4; i++)
+		hash = (hash ^ golden[i]) * 16777619u;
+	EXPECT_EQ(0x9ee39e6fu, hash);
+	g_free(golden);
+
+	/* every vector kernel matches it bit for bit */
+	for (guint s = 0; s < G_N_ELEMENTS(sizes); s++)
+	{
+		for (guint r = 0; r < G_N_ELEMENTS(radii); r++)
+		{
+			gint width = sizes[s][0];
+			gint height = sizes[s][1];
+			guchar *expected = new_noise(width, height);
+
+			ido_blur_exponential_with_impl(IDO_BLUR_IMPL_SCALAR, expected, width, height, 4, radii[r], 16, 7);
+
+			for (guint i = 0; i < G_N_ELEMENTS(impls); i++)
+			{
+				if (!ido_blur_impl_supported(impls[i]))
+					continue;
+
+				guchar *pixels = new_noise(width, height);
+				ido_blur_exponential_with_impl(impls[i], pixels, width, height, 4, radii[r], 16, 7);
+				EXPECT_EQ(0, memcmp(expected, pixels, width * height * 4))
+					<< "impl " << impls[i] << ", " << width << "x" << height << ", radius " << radii[r];
+				g_free(pixels);
+			}
+
+			g_free(expected);
+		}
+	}
+
+	return;
+}
+
+TEST_F(TestMenuitems, BlurParallel) {
+	const IdoBlurImpl impls[] = { IDO_BLUR_IMPL_SCALAR, IDO_BLUR_IMPL_SSE2, IDO_BLUR_IMPL_AVX2 };
+	const gint sizes[][2] = { {1, 1}, {5, 1}, {1, 5}, {9, 9}, {31, 33}, {130, 33}, {257, 3}, {3, 257} };
+
+	/* splitting the passes into bands across threads changes nothing */
+	for (guint s = 0; s < G_N_ELEMENTS(sizes); s++)
+	{
+		for (guint i = 0; i < G_N_ELEMENTS(impls); i++)
+		{
+			if (!ido_blur_impl_supported(impls[i]))
+				continue;
+
+			gint width = sizes[s][0];
+			gint height = sizes[s][1];
+			guchar *expected = new_noise(width, height);
+			guchar *pixels = new_noise(width, height);
+
+			ido_blur_set_parallel_threshold(G_MAXUINT);
+			ido_blur_exponential_with_impl(impls[i], expected, width, height, 4, 3, 16, 7);
+			ido_blur_set_parallel_threshold(1);
+			ido_blur_exponential_with_impl(impls[i], pixels, width, height, 4, 3, 16, 7);
+			EXPECT_EQ(0, memcmp(expected, pixels, width * height * 4))
+				<< "impl " << impls[i] << ", " << width << "x" << height;
+
+			g_free(pixels);
+			g_free(expected);
+		}
+	}
+
+	ido_blur_set_parallel_threshold(IDO_BLUR_PARALLEL_THRESHOLD_DEFAULT);
+	return;
+}
+
+static void
+draw_shadow_shape(cairo_t *cr, gpointer data)
+{
+	(*(guint *)data)++;
+	cairo_rectangle(cr, 2, 2, 6, 6);
+	cairo_fill(cr);
+}
+
+TEST_F(TestMenuitems, ShadowCache) {
+	const gdouble black[4] = { 0.0, 0.0, 0.0, 0.5 };
+	const gdouble white[4] = { 1.0, 1.0, 1.0, 0.5 };
+	guint draws = 0;
+
+	ido_shadow_cache_clear();
+	EXPECT_EQ(0u, ido_shadow_cache_get_n_entries());
+	EXPECT_EQ(0u, ido_shadow_cache_get_n_bytes());
+
+	/* the same shadow is only drawn and blurred once */
+	cairo_surface_t *first = ido_shadow_cache_get(0, 10, 10, 3, black, 1, draw_shadow_shape, &draws);
+	cairo_surface_t *second = ido_shadow_cache_get(0, 10, 10, 3, black, 1, draw_shadow_shape, &draws);
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(1u, draws);
+	EXPECT_EQ(10 * 4 * 10u, ido_shadow_cache_get_n_bytes());
+	cairo_surface_destroy(second);
+
+	/* every part of the key makes a different shadow */
+	cairo_surface_destroy(ido_shadow_cache_get(1, 10, 10, 3, black, 1, draw_shadow_shape, &draws));
+	cairo_surface_destroy(ido_shadow_cache_get(0, 12, 10, 3, black, 1, draw_shadow_shape, &draws));
+	cairo_surface_destroy(ido_shadow_cache_get(0, 10, 12, 3, black, 1, draw_shadow_shape, &draws));
+	cairo_surface_destroy(ido_shadow_cache_get(0, 10, 10, 1, black, 1, draw_shadow_shape, &draws));
+	cairo_surface_destroy(ido_shadow_cache_get(0, 10, 10, 3, white, 1, draw_shadow_shape, &draws));
+	EXPECT_EQ(6u, draws);
+	EXPECT_EQ(6u, ido_shadow_cache_get_n_entries());
+
+	/* at scale 2 the pixels double both ways, the size in user space doesn't */
+	cairo_surface_t *hidpi = ido_shadow_cache_get(0, 10, 10, 3, black, 2, draw_shadow_shape, &draws);
+	gdouble scale_x, scale_y;
+	cairo_surface_get_device_scale(hidpi, &scale_x, &scale_y);
+	EXPECT_EQ(20, cairo_image_surface_get_width(hidpi));
+	EXPECT_EQ(20, cairo_image_surface_get_height(hidpi));
+	EXPECT_EQ(2.0, scale_x);
+	EXPECT_EQ(2.0, scale_y);
+	EXPECT_EQ(7u, draws);
+	cairo_surface_destroy(hidpi);
+
+	/* shrinking the budget drops the least recently used shadows; the
+	 * first one was just used again and stays */
+	cairo_surface_destroy(ido_shadow_cache_get(0, 10, 10, 3, black, 1, draw_shadow_shape, &draws));
+	ido_shadow_cache_set_max_bytes(10 * 4 * 10);
+	EXPECT_EQ(1u, ido_shadow_cache_get_n_entries());
+	EXPECT_LE(ido_shadow_cache_get_n_bytes(), ido_shadow_cache_get_max_bytes());
+	cairo_surface_destroy(ido_shadow_cache_get(0, 10, 10, 3, black, 1, draw_shadow_shape, &draws));
+	EXPECT_EQ(7u, draws);
+
+	/* a shadow over budget is still returned, just not kept */
+	ido_shadow_cache_set_max_bytes(0);
+	EXPECT_EQ(0u, ido_shadow_cache_get_n_entries());
+	cairo_surface_t *uncached = ido_shadow_cache_get(0, 10, 10, 3, black, 1, draw_shadow_shape, &draws);
+	EXPECT_TRUE(uncached != NULL);
+	EXPECT_EQ(10, cairo_image_surface_get_width(uncached));
+	EXPECT_EQ(0u, ido_shadow_cache_get_n_entries());
+	cairo_surface_destroy(uncached);
+
+	/* the first surface outlives its cache entry */
+	EXPECT_EQ(CAIRO_STATUS_SUCCESS, cairo_surface_status(first));
+	cairo_surface_destroy(first);
+
+	ido_shadow_cache_set_max_bytes(IDO_SHADOW_CACHE_DEFAULT_MAX_BYTES);
+	return;
+}
+
+TEST_F(TestMenuitems, AlbumArtCache) {
+	cairo_surface_t *art = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 60, 60);
+	gsize size = 60 * 4 * 60;
+
+	ido_album_art_cache_clear();
+	EXPECT_TRUE(ido_album_art_cache_lookup("file:///a.png", 1) == NULL);
+
+	/* a hit hands back the same surface, for the same scale only */
+	ido_album_art_cache_insert("file:///a.png", 1, art);
+	cairo_surface_t *hit = ido_album_art_cache_lookup("file:///a.png", 1);
+	EXPECT_EQ(art, hit);
+	cairo_surface_destroy(hit);
+	EXPECT_TRUE(ido_album_art_cache_lookup("file:///a.png", 2) == NULL);
+	EXPECT_EQ(size, ido_album_art_cache_get_n_bytes());
+
+	/* inserting the same key again replaces the entry */
+	ido_album_art_cache_insert("file:///a.png", 1, art);
+	EXPECT_EQ(1u, ido_album_art_cache_get_n_entries());
+	EXPECT_EQ(size, ido_album_art_cache_get_n_bytes());
+
+	/* with room for two, the least recently used one goes */
+	ido_album_art_cache_set_max_bytes(2 * size);
+	ido_album_art_cache_insert("file:///b.png", 1, art);
+	hit = ido_album_art_cache_lookup("file:///a.png", 1);
+	cairo_surface_destroy(hit);
+	ido_album_art_cache_insert("file:///c.png", 1, art);
+	EXPECT_EQ(2u, ido_album_art_cache_get_n_entries());
+	EXPECT_TRUE(ido_album_art_cache_lookup("file:///b.png", 1) == NULL);
+	hit = ido_album_art_cache_lookup("file:///a.png", 1);
+	EXPECT_TRUE(hit != NULL);
+	cairo_surface_destroy(hit);
+
+	/* art bigger than the budget isn't kept */
+	ido_album_art_cache_set_max_bytes(size - 1);
+	EXPECT_EQ(0u, ido_album_art_cache_get_n_entries());
+	ido_album_art_cache_insert("file:///a.png", 1, art);
+	EXPECT_EQ(0u, ido_album_art_cache_get_n_entries());
+	EXPECT_EQ(0u, ido_album_art_cache_get_n_bytes());
+
+	ido_album_art_cache_set_max_bytes(IDO_ALBUM_ART_CACHE_DEFAULT_MAX_BYTES);
+	cairo_surface_destroy(art);
+	return;
+}
+
+typedef struct
+{
+	guint completed;
+	guint cancelled;
+	cairo_surface_t *surface;
+} AlbumArtResult;
+
+static void
+on_album_art_loaded(GObject *object, GAsyncResult *result, gpointer data)
+{
+	AlbumArtResult *res = (AlbumArtResult *)data;
+	GError *error = NULL;
+	cairo_surface_t *surface = ido_album_art_load_finish(result, &error);
+
+	res->completed++;
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		res->cancelled++;
+	if (surface)
+		res->surface = surface;
+	g_clear_error(&error);
+}
+
+TEST_F(TestMenuitems, AlbumArtLoadCoalescing) {
+	GdkPixbuf *art = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 120, 90);
+	gchar *path = g_build_filename(g_get_tmp_dir(), "ido-album-art-test.png", NULL);
+	gchar *url = g_filename_to_uri(path, NULL, NULL);
+	AlbumArtResult first = { 0, 0, NULL };
+	AlbumArtResult second = { 0, 0, NULL };
+	AlbumArtResult cancelled = { 0, 0, NULL };
+	GCancellable *cancellable = g_cancellable_new();
+
+	gdk_pixbuf_fill(art, 0x336699ff);
+	ASSERT_TRUE(gdk_pixbuf_save(art, path, "png", NULL, NULL));
+	ido_album_art_cache_clear();
+
+	/* three requests for the same art share one load */
+	ido_album_art_load_async(url, 1, NULL, on_album_art_loaded, &first);
+	ido_album_art_load_async(url, 1, cancellable, on_album_art_loaded, &cancelled);
+	ido_album_art_load_async(url, 1, NULL, on_album_art_loaded, &second);
+	EXPECT_EQ(1u, ido_album_art_get_n_loading());
+
+	/* cancelling one of them completes it, and leaves the others be */
+	g_cancellable_cancel(cancellable);
+	while (cancelled.completed == 0)
+		g_main_context_iteration(NULL, TRUE);
+	EXPECT_EQ(1u, cancelled.cancelled);
+	EXPECT_TRUE(cancelled.surface == NULL);
+
+	while (first.completed == 0 || second.completed == 0)
+		g_main_context_iteration(NULL, TRUE);
+
+	EXPECT_EQ(0u, ido_album_art_get_n_loading());
+	ASSERT_TRUE(first.surface != NULL);
+	EXPECT_EQ(first.surface, second.surface);
+	EXPECT_EQ(IDO_ALBUM_ART_SIZE, cairo_image_surface_get_width(first.surface));
+	EXPECT_EQ(IDO_ALBUM_ART_SIZE * 3 / 4, cairo_image_surface_get_height(first.surface));
+	EXPECT_EQ(1u, cancelled.completed);
+
+	/* and the art is cached for whoever asks next */
+	cairo_surface_t *hit = ido_album_art_cache_lookup(url, 1);
+	EXPECT_EQ(first.surface, hit);
+	cairo_surface_destroy(hit);
+
+	/* at scale 2 the art is decoded at twice the pixels */
+	AlbumArtResult hidpi = { 0, 0, NULL };
+	ido_album_art_load_async(url, 2, NULL, on_album_art_loaded, &hidpi);
+	while (hidpi.completed == 0)
+		g_main_context_iteration(NULL, TRUE);
+	ASSERT_TRUE(hidpi.surface != NULL);
+	gdouble scale_x, scale_y;
+	cairo_surface_get_device_scale(hidpi.surface, &scale_x, &scale_y);
+	EXPECT_EQ(2 * IDO_ALBUM_ART_SIZE, cairo_image_surface_get_width(hidpi.surface));
+	EXPECT_EQ(2.0, scale_x);
+	EXPECT_EQ(2.0, scale_y);
+
+	cairo_surface_destroy(hidpi.surface);
+	cairo_surface_destroy(first.surface);
+	cairo_surface_destroy(second.surface);
+	g_object_unref(cancellable);
+	g_unlink(path);
+	g_free(url);
+	g_free(path);
+	g_object_unref(art);
+	return;
+}
+
+TEST_F(TestMenuitems, AlbumArtFromBytes) {
+	/* raw pixels are premultiplied into the surface as they are */
+	const guchar pixels[] = { 0xff, 0x00, 0x00, 0x80,   0x00, 0xff, 0x00, 0xff };
+	GBytes *raw = g_bytes_new_static(pixels, sizeof(pixels));
+	GError *error = NULL;
+
+	cairo_surface_t *surface = ido_album_art_new_from_bytes(raw, 2, 1, 2, &error);
+	ASSERT_TRUE(surface != NULL);
+	guint32 *data = (guint32 *)cairo_image_surface_get_data(surface);
+	EXPECT_EQ(0x80800000u, data[0]);
+	EXPECT_EQ(0xff00ff00u, data[1]);
+	gdouble scale_x, scale_y;
+	cairo_surface_get_device_scale(surface, &scale_x, &scale_y);
+	EXPECT_EQ(1.0, scale_x);
+	cairo_surface_destroy(surface);
+
+	/* pixels that don't match the given size are refused */
+	EXPECT_TRUE(ido_album_art_new_from_bytes(raw, 3, 1, 1, &error) == NULL);
+	EXPECT_TRUE(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA));
+	g_clear_error(&error);
+	g_bytes_unref(raw);
+
+	/* a thumbnail at twice the art size is shown at scale 2 */
+	gsize n_pixels = 4 * IDO_ALBUM_ART_SIZE * IDO_ALBUM_ART_SIZE;
+	raw = g_bytes_new_take(g_malloc0(n_pixels * 4), n_pixels * 4);
+	surface = ido_album_art_new_from_bytes(raw, 2 * IDO_ALBUM_ART_SIZE, 2 * IDO_ALBUM_ART_SIZE, 1, &error);
+	ASSERT_TRUE(surface != NULL);
+	cairo_surface_get_device_scale(surface, &scale_x, &scale_y);
+	EXPECT_EQ(2.0, scale_x);
+	EXPECT_EQ(2.0, scale_y);
+	cairo_surface_destroy(surface);
+	g_bytes_unref(raw);
+
+	/* encoded images are decoded to fit the art at the given scale */
+	GdkPixbuf *art = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 200, 100);
+	gchar *buffer;
+	gsize size;
+	gdk_pixbuf_fill(art, 0x336699ff);
+	ASSERT_TRUE(gdk_pixbuf_save_to_buffer(art, &buffer, &size, "png", NULL, NULL));
+	GBytes *encoded = g_bytes_new_take(buffer, size);
+	surface = ido_album_art_new_from_bytes(encoded, 0, 0, 2, &error);
+	ASSERT_TRUE(surface != NULL);
+	EXPECT_EQ(2 * IDO_ALBUM_ART_SIZE, cairo_image_surface_get_width(surface));
+	EXPECT_EQ(IDO_ALBUM_ART_SIZE, cairo_image_surface_get_height(surface));
+	cairo_surface_destroy(surface);
+	g_bytes_unref(encoded);
+
+	/* and garbage is an error, not a crash */
+	GBytes *garbage = g_bytes_new_static("not an image", 12);
+	EXPECT_TRUE(ido_album_art_new_from_bytes(garbage, 0, 0, 1, &error) == NULL);
+	EXPECT_TRUE(error != NULL);
+	g_clear_error(&error);
+	g_bytes_unref(garbage);
+
+	g_object_unref(art);
+	return;
+}
+
+TEST_F(TestMenuitems, MediaPlayerPosition) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GSimpleAction *action = g_simple_action_new_stateful("player", NULL,
+		g_variant_new_parsed("{'title': <'One'>, 'position': <int64 10000000>, 'position-time': <int64 1000000>,"
+		                     " 'duration': <int64 60000000>, 'rate': <1.0>}"));
+	GMenuItem *menuitem = g_menu_item_new("Player", "player");
+
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(action));
+	GtkMenuItem *item = ido_media_player_menu_item_new_from_model(menuitem, G_ACTION_GROUP(actions));
+	g_object_ref_sink(item);
+	ido_action_helper_flush_pending();
+
+	/* one update is enough, the position moves on by itself */
+	IdoMediaPlayerMenuItem *player = IDO_MEDIA_PLAYER_MENU_ITEM(item);
+	EXPECT_EQ(10000000, ido_media_player_menu_item_get_position(player, 1000000));
+	EXPECT_EQ(15000000, ido_media_player_menu_item_get_position(player, 6000000));
+	EXPECT_EQ(60000000, ido_media_player_menu_item_get_position(player, 100000000));
+
+	/* other changes leave it be */
+	g_simple_action_set_state(action,
+		g_variant_new_parsed("{'title': <'Two'>, 'position': <int64 10000000>, 'position-time': <int64 1000000>,"
+		                     " 'duration': <int64 60000000>, 'rate': <1.0>}"));
+	EXPECT_EQ(15000000, ido_media_player_menu_item_get_position(player, 6000000));
+
+	/* a change of rate resyncs it */
+	g_simple_action_set_state(action,
+		g_variant_new_parsed("{'title': <'Two'>, 'position': <int64 20000000>, 'position-time': <int64 6000000>,"
+		                     " 'duration': <int64 60000000>, 'rate': <2.0>}"));
+	EXPECT_EQ(30000000, ido_media_player_menu_item_get_position(player, 11000000));
+
+	/* and while paused it stands still */
+	g_simple_action_set_state(action,
+		g_variant_new_parsed("{'title': <'Two'>, 'position': <int64 30000000>, 'position-time': <int64 11000000>,"
+		                     " 'duration': <int64 60000000>, 'rate': <0.0>}"));
+	EXPECT_EQ(30000000, ido_media_player_menu_item_get_position(player, 50000000));
+
+	gtk_widget_destroy(GTK_WIDGET(item));
+	g_object_unref(item);
+	g_object_unref(menuitem);
+	g_object_unref(action);
+	g_object_unref(actions);
+	return;
+}
+
+static void
+send_pointer_event(GtkWidget *widget, GdkEventType type, gdouble x, gdouble y)
+{
+	GdkEvent *event = gdk_event_new(type);
+	GdkSeat *seat = gdk_display_get_default_seat(gtk_widget_get_display(widget));
+
+	event->any.window = GDK_WINDOW(g_object_ref(gtk_widget_get_window(widget)));
+	event->any.send_event = TRUE;
+	gdk_event_set_device(event, gdk_seat_get_pointer(seat));
+
+	if (type == GDK_MOTION_NOTIFY) {
+		event->motion.x = x;
+		event->motion.y = y;
+	} else if (type == GDK_BUTTON_PRESS || type == GDK_BUTTON_RELEASE) {
+		event->button.x = x;
+		event->button.y = y;
+		event->button.button = 1;
+	} else {
+		event->crossing.x = x;
+		event->crossing.y = y;
+	}
+
+	gtk_widget_event(widget, event);
+	gdk_event_free(event);
+}
+
+/* takes the area queued for redraw in the window @widget draws on */
+static cairo_region_t *
+take_update_area(GtkWidget *widget)
+{
+	cairo_region_t *area = gdk_window_get_update_area(gtk_widget_get_window(widget));
+
+	return area ? area : cairo_region_create();
+}
+
+static void
+count_activations(GSimpleAction *action, GVariant *parameter, gpointer user_data)
+{
+	(*(guint *)user_data)++;
+}
+
+TEST_F(TestMenuitems, PlaybackPointerEvents) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GSimpleAction *play = g_simple_action_new_stateful("play", NULL, g_variant_new_string("Paused"));
+	GSimpleAction *next = g_simple_action_new("next", NULL);
+	GMenuItem *menuitem = g_menu_item_new(NULL, NULL);
+	guint plays = 0;
+	guint nexts = 0;
+
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(play));
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(next));
+	g_signal_connect(play, "activate", G_CALLBACK(count_activations), &plays);
+	g_signal_connect(next, "activate", G_CALLBACK(count_activations), &nexts);
+	g_menu_item_set_attribute(menuitem, "x-ayatana-play-action", "s", "play");
+	g_menu_item_set_attribute(menuitem, "x-ayatana-next-action", "s", "next");
+
+	/* below another item, so that the allocation doesn't start at 0 */
+	GtkWidget *window = gtk_offscreen_window_new();
+	GtkWidget *menubar = gtk_menu_bar_new();
+	GtkWidget *above = gtk_menu_item_new_with_label("Above");
+	GtkWidget *item = GTK_WIDGET(ido_playback_menu_item_new_from_model(menuitem, G_ACTION_GROUP(actions)));
+
+	gtk_menu_bar_set_pack_direction(GTK_MENU_BAR(menubar), GTK_PACK_DIRECTION_TTB);
+	gtk_menu_shell_append(GTK_MENU_SHELL(menubar), above);
+	gtk_menu_shell_append(GTK_MENU_SHELL(menubar), item);
+	gtk_container_add(GTK_CONTAINER(window), menubar);
+	gtk_widget_show_all(window);
+
+	while (gtk_events_pending())
+		gtk_main_iteration();
+	cairo_region_destroy(take_update_area(item));
+
+	GtkAllocation alloc;
+	GtkAllocation above_alloc;
+	gtk_widget_get_allocation(item, &alloc);
+	gtk_widget_get_allocation(above, &above_alloc);
+	ASSERT_GT(alloc.y, 0);
+
+	/* button centres in event coordinates, which start at the allocation
+	 * like drawing does; in the window, they are offset by it */
+	gint left = alloc.x + (alloc.width - 130) / 2;
+	gint play_x = left + 65;
+	gint next_x = left + 108;
+	gint button_y = 26;
+
+	/* hovering play only damages play, where the item is drawn */
+	send_pointer_event(item, GDK_MOTION_NOTIFY, play_x, button_y);
+	cairo_region_t *area = take_update_area(item);
+	EXPECT_TRUE(cairo_region_contains_point(area, alloc.x + play_x, alloc.y + button_y));
+	EXPECT_FALSE(cairo_region_contains_point(area, alloc.x + next_x, alloc.y + button_y));
+	EXPECT_EQ(CAIRO_REGION_OVERLAP_OUT, cairo_region_contains_rectangle(area, &above_alloc));
+	cairo_rectangle_int_t extents;
+	cairo_region_get_extents(area, &extents);
+	EXPECT_GE(extents.y, alloc.y);
+	cairo_region_destroy(area);
+
+	/* moving within the same button damages nothing */
+	send_pointer_event(item, GDK_MOTION_NOTIFY, play_x + 1, button_y);
+	area = take_update_area(item);
+	EXPECT_TRUE(cairo_region_is_empty(area));
+	cairo_region_destroy(area);
+
+	/* moving to next damages both buttons */
+	send_pointer_event(item, GDK_MOTION_NOTIFY, next_x, button_y);
+	area = take_update_area(item);
+	EXPECT_TRUE(cairo_region_contains_point(area, alloc.x + play_x, alloc.y + button_y));
+	EXPECT_TRUE(cairo_region_contains_point(area, alloc.x + next_x, alloc.y + button_y));
+	EXPECT_EQ(CAIRO_REGION_OVERLAP_OUT, cairo_region_contains_rectangle(area, &above_alloc));
+	cairo_region_destroy(area);
+
+	/* pressing pushes the hovered button, releasing activates it */
+	send_pointer_event(item, GDK_BUTTON_PRESS, next_x, button_y);
+	area = take_update_area(item);
+	EXPECT_TRUE(cairo_region_contains_point(area, alloc.x + next_x, alloc.y + button_y));
+	cairo_region_destroy(area);
+
+	send_pointer_event(item, GDK_BUTTON_RELEASE, next_x, button_y);
+	EXPECT_EQ(1u, nexts);
+	EXPECT_EQ(0u, plays);
+	cairo_region_destroy(take_update_area(item));
+
+	/* leaving drops both the pushed and the hovered button */
+	send_pointer_event(item, GDK_BUTTON_PRESS, play_x, button_y);
+	cairo_region_destroy(take_update_area(item));
+
+	send_pointer_event(item, GDK_LEAVE_NOTIFY, -1, -1);
+	area = take_update_area(item);
+	EXPECT_TRUE(cairo_region_contains_point(area, alloc.x + play_x, alloc.y + button_y));
+	EXPECT_EQ(CAIRO_REGION_OVERLAP_OUT, cairo_region_contains_rectangle(area, &above_alloc));
+	cairo_region_destroy(area);
+
+	send_pointer_event(item, GDK_BUTTON_RELEASE, play_x, button_y);
+	EXPECT_EQ(0u, plays);
+
+	send_pointer_event(item, GDK_MOTION_NOTIFY, play_x, button_y);
+	area = take_update_area(item);
+	EXPECT_TRUE(cairo_region_contains_point(area, alloc.x + play_x, alloc.y + button_y));
+	cairo_region_destroy(area);
+
+	gtk_widget_destroy(window);
+	g_object_unref(menuitem);
+	g_object_unref(next);
+	g_object_unref(play);
+	g_object_unref(actions);
+	return;
+}
+
+static void
+send_key_event(GtkWidget *widget, GdkEventType type, guint keyval)
+{
+	GdkEvent *event = gdk_event_new(type);
+	GdkSeat *seat = gdk_display_get_default_seat(gtk_widget_get_display(widget));
+
+	event->any.window = GDK_WINDOW(g_object_ref(gtk_widget_get_window(widget)));
+	event->any.send_event = TRUE;
+	event->key.keyval = keyval;
+	gdk_event_set_device(event, gdk_seat_get_keyboard(seat));
+
+	gtk_widget_event(widget, event);
+	gdk_event_free(event);
+}
+
+/* draws @widget the way its window would, at its scale factor */
+static cairo_surface_t *
+draw_widget(GtkWidget *widget)
+{
+	GtkAllocation alloc;
+	gint scale = gtk_widget_get_scale_factor(widget);
+
+	gtk_widget_get_allocation(widget, &alloc);
+
+	cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (alloc.x + alloc.width) * scale, alloc.height * scale);
+	cairo_surface_set_device_scale(surface, scale, scale);
+
+	cairo_t *cr = cairo_create(surface);
+	gtk_widget_draw(widget, cr);
+	cairo_destroy(cr);
+
+	cairo_surface_flush(surface);
+	return surface;
+}
+
+static gboolean
+surfaces_equal(cairo_surface_t *a, cairo_surface_t *b)
+{
+	gint height = cairo_image_surface_get_height(a);
+	gint stride = cairo_image_surface_get_stride(a);
+
+	return height == cairo_image_surface_get_height(b) &&
+	       stride == cairo_image_surface_get_stride(b) &&
+	       memcmp(cairo_image_surface_get_data(a), cairo_image_surface_get_data(b), height * stride) == 0;
+}
+
+enum {
+	PLAYBACK_IDLE,
+	PLAYBACK_HOVER_PREVIOUS,
+	PLAYBACK_HOVER_PLAY,
+	PLAYBACK_HOVER_NEXT,
+	PLAYBACK_PRESS_PLAY,
+	PLAYBACK_PRESS_NEXT,
+	PLAYBACK_FOCUS,
+	PLAYBACK_FOCUS_HOVER_NEXT,
+	PLAYBACK_FOCUS_KEY_PREVIOUS,
+	PLAYBACK_PLAYING,
+	PLAYBACK_PLAYING_PRESS_PLAY,
+	N_PLAYBACK_STATES
+};
+
+/* puts @item in @state through the events and actions that lead there */
+static void
+set_playback_state(GtkWidget *item, GActionGroup *actions, gint state)
+{
+	GtkWidget *parent = gtk_widget_get_parent(item);
+	GtkAllocation alloc;
+
+	gtk_widget_get_allocation(item, &alloc);
+
+	gint left = alloc.x + (alloc.width - 130) / 2;
+	gint previous_x = left + 22;
+	gint play_x = left + 65;
+	gint next_x = left + 108;
+	gint button_y = 26;
+
+	send_key_event(parent, GDK_KEY_RELEASE, GDK_KEY_Left);
+	send_pointer_event(item, GDK_LEAVE_NOTIFY, -1, -1);
+	gtk_menu_item_deselect(GTK_MENU_ITEM(item));
+	g_action_group_change_action_state(actions, "play", g_variant_new_string("Paused"));
+
+	switch (state) {
+	case PLAYBACK_HOVER_PREVIOUS:
+		send_pointer_event(item, GDK_MOTION_NOTIFY, previous_x, button_y);
+		break;
+	case PLAYBACK_HOVER_PLAY:
+		send_pointer_event(item, GDK_MOTION_NOTIFY, play_x, button_y);
+		break;
+	case PLAYBACK_HOVER_NEXT:
+		send_pointer_event(item, GDK_MOTION_NOTIFY, next_x, button_y);
+		break;
+	case PLAYBACK_PRESS_PLAY:
+		send_pointer_event(item, GDK_MOTION_NOTIFY, play_x, button_y);
+		send_pointer_event(item, GDK_BUTTON_PRESS, play_x, button_y);
+		break;
+	case PLAYBACK_PRESS_NEXT:
+		send_pointer_event(item, GDK_MOTION_NOTIFY, next_x, button_y);
+		send_pointer_event(item, GDK_BUTTON_PRESS, next_x, button_y);
+		break;
+	case PLAYBACK_FOCUS:
+		gtk_menu_item_select(GTK_MENU_ITEM(item));
+		break;
+	case PLAYBACK_FOCUS_HOVER_NEXT:
+		gtk_menu_item_select(GTK_MENU_ITEM(item));
+		send_pointer_event(item, GDK_MOTION_NOTIFY, next_x, button_y);
+		break;
+	case PLAYBACK_FOCUS_KEY_PREVIOUS:
+		gtk_menu_item_select(GTK_MENU_ITEM(item));
+		send_key_event(parent, GDK_KEY_PRESS, GDK_KEY_Left);
+		break;
+	case PLAYBACK_PLAYING:
+		g_action_group_change_action_state(actions, "play", g_variant_new_string("Playing"));
+		break;
+	case PLAYBACK_PLAYING_PRESS_PLAY:
+		g_action_group_change_action_state(actions, "play", g_variant_new_string("Playing"));
+		send_pointer_event(item, GDK_MOTION_NOTIFY, play_x, button_y);
+		send_pointer_event(item, GDK_BUTTON_PRESS, play_x, button_y);
+		break;
+	}
+}
+
+TEST_F(TestMenuitems, PlaybackArtworkCache) {
+	GSimpleActionGroup *actions = g_simple_action_group_new();
+	GSimpleAction *play = g_simple_action_new_stateful("play", NULL, g_variant_new_string("Paused"));
+	GSimpleAction *previous = g_simple_action_new("previous", NULL);
+	GSimpleAction *next = g_simple_action_new("next", NULL);
+	GMenuItem *menuitem = g_menu_item_new(NULL, NULL);
+	cairo_surface_t *expected[N_PLAYBACK_STATES];
+
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(play));
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(previous));
+	g_action_map_add_action(G_ACTION_MAP(actions), G_ACTION(next));
+	g_menu_item_set_attribute(menuitem, "x-ayatana-play-action", "s", "play");
+	g_menu_item_set_attribute(menuitem, "x-ayatana-previous-action", "s", "previous");
+	g_menu_item_set_attribute(menuitem, "x-ayatana-next-action", "s", "next");
+
+	GtkWidget *window = gtk_offscreen_window_new();
+	GtkWidget *menubar = gtk_menu_bar_new();
+	GtkWidget *item = GTK_WIDGET(ido_playback_menu_item_new_from_model(menuitem, G_ACTION_GROUP(actions)));
+
+	gtk_menu_bar_set_pack_direction(GTK_MENU_BAR(menubar), GTK_PACK_DIRECTION_TTB);
+	gtk_menu_shell_append(GTK_MENU_SHELL(menubar), item);
+	gtk_container_add(GTK_CONTAINER(window), menubar);
+	gtk_widget_show_all(window);
+
+	while (gtk_events_pending())
+		gtk_main_iteration();
+
+	/* a style change drops every cached artwork, so these are rendered
+	 * from scratch */
+	for (gint state = 0; state < N_PLAYBACK_STATES; state++) {
+		set_playback_state(item, G_ACTION_GROUP(actions), state);
+		g_signal_emit_by_name(item, "style-updated");
+		expected[state] = draw_widget(item);
+	}
+
+	/* the states tell apart in the drawing */
+	for (gint state = 1; state < N_PLAYBACK_STATES; state++)
+		EXPECT_FALSE(surfaces_equal(expected[state - 1], expected[state])) << "state " << state;
+
+	/* more states than the cache holds: going through them twice draws
+	 * cached entries as well as ones that replace the least recent */
+	for (gint pass = 0; pass < 2; pass++) {
+		for (gint state = 0; state < N_PLAYBACK_STATES; state++) {
+			set_playback_state(item, G_ACTION_GROUP(actions), state);
+
+			cairo_surface_t *first = draw_widget(item);
+			cairo_surface_t *second = draw_widget(item);
+			EXPECT_TRUE(surfaces_equal(expected[state], first)) << "state " << state << ", pass " << pass;
+			EXPECT_TRUE(surfaces_equal(expected[state], second)) << "state " << state << ", pass " << pass;
+			cairo_surface_destroy(second);
+			cairo_surface_destroy(first);
+		}
+	}
+
+	/* a theme change reaches the cached artwork with new colours */
+	set_playback_state(item, G_ACTION_GROUP(actions), PLAYBACK_IDLE);
+	cairo_surface_t *before = draw_widget(item);
+
+	GtkCssProvider *provider = gtk_css_provider_new();
+	gtk_css_provider_load_from_data(provider, "* { background-color: #ff0000; color: #00ff00; }", -1, NULL);
+	gtk_style_context_add_provider_for_screen(gtk_widget_get_screen(item), GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+	while (gtk_events_pending())
+		gtk_main_iteration();
+
+	cairo_surface_t *themed = draw_widget(item);
+	EXPECT_FALSE(surfaces_equal(before, themed));
+
+	g_signal_emit_by_name(item, "style-updated");
+	cairo_surface_t *themed_uncached = draw_widget(item);
+	EXPECT_TRUE(surfaces_equal(themed_uncached, themed));
+
+	gtk_style_context_remove_provider_for_screen(gtk_widget_get_screen(item), GTK_STYLE_PROVIDER(provider));
+
+	while (gtk_events_pending())
+		gtk_main_iteration();
+
+	cairo_surface_t *unthemed = draw_widget(item);
+	EXPECT_TRUE(surfaces_equal(before, unthemed));
+
+	cairo_surface_destroy(unthemed);
+	cairo_surface_destroy(themed_uncached);
+	cairo_surface_destroy(themed);
+	cairo_surface_destroy(before);
+	g_object_unref(provider);
+
+	for (gint state = 0; state < N_PLAYBACK_STATES; state++)
+		cairo_surface_destroy(expected[state]);
+
+	gtk_widget_destroy(window);
+	g_object_unref(menuitem);
+	g_object_unref(next);
+	g_object_unref(previous);
+	g_object_unref(play);
+	g_object_unref(actions);
+	return;
+}